@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Minimal registry & timer for the benchmark binary
+ *
+ * Benchmarks are declared with BENCH(name) in any file under bench/ and
+ * run by chess_bench, optionally filtered by a substring of their name.
+ */
+class Bench {
+public:
+    using Function = std::function<void()>;
+
+    /**
+     * @brief Register a benchmark, used by BENCH
+     */
+    static int add(const std::string& name, Function function);
+
+    /**
+     * @brief Get all registered benchmarks in registration order
+     */
+    static std::vector<std::pair<std::string, Function>>& getAll();
+
+    /**
+     * @brief Run body the given amount of times and print the time per iteration
+     * @returns Nanoseconds per iteration
+     */
+    static double measure(const std::string& label, long iterations, const std::function<void()>& body);
+
+    /**
+     * @brief Print a free form result line
+     */
+    static void report(const std::string& label, const std::string& value);
+
+    /**
+     * @brief Start tracking the peak of heap bytes allocated through operator new
+     */
+    static void resetPeakMemory();
+
+    /**
+     * @brief Get the peak heap bytes above the level at the last reset
+     */
+    static std::size_t getPeakMemory();
+
+    /**
+     * @brief Print the peak heap bytes since the last reset
+     */
+    static void reportPeakMemory(const std::string& label);
+};
+
+/**
+ * @brief Keep the optimizer from discarding a computed value
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#define BENCH(name) \
+    static void bench_##name(); \
+    static int bench_##name##_registered = Bench::add(#name, bench_##name); \
+    static void bench_##name()
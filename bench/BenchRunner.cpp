@@ -0,0 +1,109 @@
+#include "Bench.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include <malloc.h>
+
+// Heap accounting of the whole binary, sizes come from the allocator
+static std::atomic<std::size_t> heap_current(0);
+static std::atomic<std::size_t> heap_peak(0);
+static std::atomic<std::size_t> heap_base(0);
+
+void* operator new(std::size_t size) {
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+
+    std::size_t current = heap_current += malloc_usable_size(pointer);
+    std::size_t peak = heap_peak.load(std::memory_order_relaxed);
+    while (current > peak && !heap_peak.compare_exchange_weak(peak, current)) { }
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    if (pointer == nullptr)
+        return;
+    heap_current -= malloc_usable_size(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    operator delete(pointer);
+}
+
+void Bench::resetPeakMemory() {
+    heap_base = heap_current.load();
+    heap_peak = heap_base.load();
+}
+
+std::size_t Bench::getPeakMemory() {
+    return heap_peak - heap_base;
+}
+
+int Bench::add(const std::string& name, Function function) {
+    getAll().emplace_back(name, function);
+    return 0;
+}
+
+std::vector<std::pair<std::string, Bench::Function>>& Bench::getAll() {
+    static std::vector<std::pair<std::string, Function>> benches;
+    return benches;
+}
+
+double Bench::measure(const std::string& label, long iterations, const std::function<void()>& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++)
+        body();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    char line[128];
+    if (ns >= 1e6)
+        std::snprintf(line, sizeof(line), "%10.3f ms/op", ns / 1e6);
+    else if (ns >= 1e3)
+        std::snprintf(line, sizeof(line), "%10.3f us/op", ns / 1e3);
+    else
+        std::snprintf(line, sizeof(line), "%10.1f ns/op", ns);
+    report(label, line);
+    return ns;
+}
+
+void Bench::reportPeakMemory(const std::string& label) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%10zu KiB", getPeakMemory() / 1024);
+    report(label, line);
+}
+
+void Bench::report(const std::string& label, const std::string& value) {
+    std::printf("  %-48s %s\n", label.c_str(), value.c_str());
+}
+
+int main(int argc, char* argv[]) {
+    std::string filter = argc > 1 ? argv[1] : "";
+
+    for (auto& [name, function] : Bench::getAll()) {
+        if (name.find(filter) == std::string::npos)
+            continue;
+
+        std::cout << name << std::endl;
+        function();
+    }
+
+    return 0;
+}
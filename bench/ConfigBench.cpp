@@ -0,0 +1,142 @@
+#include "Bench.hpp"
+#include "ConfigReader.hpp"
+#include "GameManager.hpp"
+#include "PositionNotation.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <unistd.h>
+
+/**
+ * @brief Generate a variant with many piece types spread over a large board
+ */
+static std::string generateConfig(int board_size, int type_count, int count) {
+    std::ostringstream out;
+    out << "{\n    \"game_settings\": { \"name\": \"generated\", \"board_size\": " << board_size
+        << ", \"turn_limit\": 500 },\n    \"pieces\": [\n";
+
+    int square = 0;
+    for (int t = 0; t < type_count; t++) {
+        out << "        {\n            \"type\": \"piece" << t << "\",\n"
+            << "            \"king_type\": " << (t == 0 ? "true" : "false") << ",\n"
+            << "            \"positions\": {\n";
+        for (const char* team : { "white", "black" }) {
+            out << "                \"" << team << "\": [\n";
+            for (int i = 0; i < count; i++, square++) {
+                out << "                    { \"x\": " << square % board_size << ", \"y\": "
+                    << square / board_size << " }" << (i + 1 < count ? ",\n" : "\n");
+            }
+            out << "                ]" << (team[0] == 'w' ? ",\n" : "\n");
+        }
+        out << "            },\n            \"movement\": { \"forward\": 1, \"backward\": 0, "
+               "\"sideways\": " << t % 3 << ", \"diagonal\": -1, \"l_shape\": false, "
+               "\"first_move_forward\": 2, \"diagonal_capture\": 1 },\n"
+            << "            \"count\": " << count << "\n        }"
+            << (t + 1 < type_count ? ",\n" : "\n");
+    }
+    out << "    ]\n}\n";
+    return out.str();
+}
+
+/**
+ * @brief The former loader: build the whole DOM, then look every field up
+ */
+static void parseWithDom(const std::string& source, std::vector<PieceConfig>& pieces) {
+    nlohmann::json json = nlohmann::json::parse(source);
+    for (const auto& piece : json["pieces"]) {
+        PieceConfig config;
+        config.type = piece["type"].get<std::string>();
+        config.king_type = piece.value("king_type", false);
+        for (const char* team : { "white", "black" }) {
+            auto& positions = team[0] == 'w' ? config.white_positions : config.black_positions;
+            for (const auto& pos : piece["positions"][team])
+                positions.push_back(Position(pos["x"].get<int>(), pos["y"].get<int>()));
+        }
+        config.movement.forward = piece["movement"].value("forward", 0);
+        config.movement.diagonal = piece["movement"].value("diagonal", 0);
+        config.count = piece["count"].get<int>();
+        pieces.push_back(config);
+    }
+}
+
+BENCH(ConfigLoad) {
+    std::string source = generateConfig(1024, 300, 400);
+    std::string path = "/tmp/chess_bench_" + std::to_string(getpid()) + ".json";
+    std::ofstream(path) << source;
+    char size[32];
+    std::snprintf(size, sizeof(size), "%10zu KiB", source.size() / 1024);
+    Bench::report("generated config", size);
+
+    Bench::resetPeakMemory();
+    Bench::measure("dom parse (string)", 5, [&]() {
+        std::vector<PieceConfig> pieces;
+        parseWithDom(source, pieces);
+        doNotOptimize(pieces);
+    });
+    Bench::reportPeakMemory("dom parse peak heap");
+
+    Bench::resetPeakMemory();
+    Bench::measure("sax parse (string)", 5, [&]() {
+        ConfigReader reader(path);
+        reader.parseConfig(source);
+        doNotOptimize(reader);
+    });
+    Bench::reportPeakMemory("sax parse peak heap");
+
+    Bench::resetPeakMemory();
+    Bench::measure("sax read (mmap file)", 5, [&]() {
+        ConfigReader reader(path);
+        reader.readConfig();
+        doNotOptimize(reader);
+    });
+    Bench::reportPeakMemory("sax read peak heap");
+
+    std::remove(path.c_str());
+}
+
+// Positions of a recorded game written to & read back from position notation
+BENCH(PositionNotation) {
+    const char* configs[] = { "./data/chess_pieces.json", "./data/fantasy_chess.json" };
+
+    for (const char* config_path : configs) {
+        std::shared_ptr<const Ruleset> ruleset = Ruleset::load(config_path);
+        std::vector<std::string> positions;
+        GameManager game(ruleset);
+        std::uint32_t seed = 7;
+        while (!game.isGameOver() && positions.size() < 200) {
+            positions.push_back(game.getPosition());
+            std::vector<Move> moves = game.getLegalMoves();
+            seed = seed * 1664525u + 1013904223u;
+            game.playTurn(moves[(seed >> 8) % moves.size()]);
+        }
+
+        std::string name = std::string(config_path).substr(7);
+        ChessBoard board(ruleset);
+        team_t player;
+        int move_count;
+        Bench::resetPeakMemory();
+        double read_ns = Bench::measure(name + " read " + std::to_string(positions.size()), 200, [&]() {
+            for (const std::string& position : positions)
+                readPosition(position, board, player, move_count);
+        });
+
+        char buffer[256];
+        double write_ns = Bench::measure(name + " write " + std::to_string(positions.size()), 200, [&]() {
+            for (const std::string& position : positions) {
+                readPosition(position, board, player, move_count);
+                doNotOptimize(writePosition(board, player, move_count, buffer, sizeof(buffer)));
+            }
+        });
+        Bench::reportPeakMemory(name + " peak heap");
+
+        char line[64];
+        std::snprintf(line, sizeof(line), "%10.2f M/s", positions.size() * 1e3 / read_ns);
+        Bench::report(name + " positions read", line);
+        std::snprintf(line, sizeof(line), "%10.2f M/s", positions.size() * 1e3 / (write_ns - read_ns));
+        Bench::report(name + " positions written", line);
+    }
+}
@@ -0,0 +1,347 @@
+#include "Bench.hpp"
+#include "GameLog.hpp"
+#include "GameManager.hpp"
+#include "PositionIndex.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+
+#include <unistd.h>
+
+/**
+ * @brief Record a game of pseudo random legal moves, deterministic for a seed
+ */
+static std::vector<Move> recordGame(const std::shared_ptr<const Ruleset>& ruleset, int max_plies,
+                                    std::uint32_t seed) {
+    GameManager game(ruleset);
+    std::vector<Move> played;
+
+    while (!game.isGameOver() && static_cast<int>(played.size()) < max_plies) {
+        std::vector<Move> moves = game.getLegalMoves();
+        seed = seed * 1664525u + 1013904223u;
+        const Move& move = moves[(seed >> 8) % moves.size()];
+        game.playTurn(move);
+        played.push_back(move);
+    }
+
+    return played;
+}
+
+// Turn latency of a whole recorded game, game-over detection included
+BENCH(GameOverDetection) {
+    const char* configs[] = { "./data/chess_pieces.json", "./data/fantasy_chess.json" };
+
+    for (const char* config_path : configs) {
+        std::shared_ptr<const Ruleset> ruleset = Ruleset::load(config_path);
+        std::vector<Move> moves = recordGame(ruleset, 200, 7);
+        std::string name = std::string(config_path).substr(7);
+
+        double ns = Bench::measure(name + " replay " + std::to_string(moves.size()) + " plies", 20, [&]() {
+            GameManager game(ruleset);
+            for (const Move& move : moves)
+                game.playTurn(move);
+            doNotOptimize(game);
+        });
+
+        char line[64];
+        std::snprintf(line, sizeof(line), "%10.3f us/turn", ns / 1e3 / moves.size());
+        Bench::report(name + " per turn", line);
+
+        Bench::resetPeakMemory();
+        {
+            ChessBoard board(ruleset);
+            doNotOptimize(board);
+        }
+        std::snprintf(line, sizeof(line), "%10zu B", Bench::getPeakMemory());
+        Bench::report(name + " board heap", line);
+    }
+}
+
+// A front end turn: list the legal moves of the position, then play one of them
+BENCH(MoveCache) {
+    std::shared_ptr<const Ruleset> ruleset = Ruleset::load("./data/chess_pieces.json");
+    std::vector<Move> moves = recordGame(ruleset, 200, 7);
+
+    for (bool list : { false, true }) {
+        MoveCacheStats stats = {};
+        double ns = Bench::measure(list ? "list + play" : "play only", 20, [&]() {
+            GameManager game(ruleset);
+            for (const Move& move : moves) {
+                if (list)
+                    doNotOptimize(game.getLegalMoves());
+                game.playTurn(move);
+            }
+            stats = game.getMoveCacheStats();
+        });
+
+        char line[64];
+        std::snprintf(line, sizeof(line), "%10.3f us/turn", ns / 1e3 / moves.size());
+        Bench::report("  per turn", line);
+        std::snprintf(line, sizeof(line), "%10.1f %%", 100.0 * stats.hits / (stats.hits + stats.misses));
+        Bench::report("  cache hit rate", line);
+    }
+}
+
+// A front end burst: every piece of the player to move hovered over every square
+BENCH(BatchValidation) {
+    const char* configs[] = { "./data/chess_pieces.json", "./data/fantasy_chess.json" };
+
+    for (const char* config_path : configs) {
+        std::shared_ptr<const Ruleset> ruleset = Ruleset::load(config_path);
+        GameManager game(ruleset);
+        for (const Move& move : recordGame(ruleset, 30, 7))
+            game.playTurn(move);
+
+        const ChessBoard& board = game.getBoard();
+        std::vector<Move> moves;
+        std::vector<MoveQuery> queries;
+        for (const ChessPiece& piece : board.getPiecesOfTeam(game.getCurrentPlayer())) {
+            for (int y = 0; y < board.getSize(); y++) {
+                for (int x = 0; x < board.getSize(); x++) {
+                    moves.emplace_back(piece.position, Position(x, y));
+                    queries.push_back(MoveQuery{ &piece, Position(x, y) });
+                }
+            }
+        }
+
+        std::string name = std::string(config_path).substr(7) + " " + std::to_string(moves.size());
+        MoveValidator validator(board);
+        Bench::measure(name + " validateMove each", 2000, [&]() {
+            std::vector<bool> valid(queries.size());
+            for (std::size_t i = 0; i < queries.size(); i++)
+                valid[i] = validator.validateMove(*queries[i].piece, queries[i].destination);
+            doNotOptimize(valid);
+        });
+        Bench::measure(name + " validateMoves", 2000, [&]() {
+            doNotOptimize(validator.validateMoves(queries));
+        });
+
+        Bench::measure(name + " isMoveLegal each", 500, [&]() {
+            std::vector<bool> legal(moves.size());
+            for (std::size_t i = 0; i < moves.size(); i++)
+                legal[i] = game.isMoveLegal(moves[i]);
+            doNotOptimize(legal);
+        });
+        Bench::measure(name + " areMovesLegal", 500, [&]() {
+            doNotOptimize(game.areMovesLegal(moves));
+        });
+    }
+}
+
+/**
+ * @brief A 64 sided board where white has a king in the corner & rooks on
+ * even squares, black knights ready to mate & rooks on odd squares. No rook
+ * can reach the mating knights
+ */
+static std::shared_ptr<const Ruleset> makeKnightMateRuleset(int rooks) {
+    std::ostringstream out;
+    out << "{ \"game_settings\": { \"name\": \"knight mate\", \"board_size\": 64, \"turn_limit\": -1 },\n"
+        << "  \"pieces\": [\n"
+        << "    { \"type\": \"king\", \"king_type\": true, \"count\": 1,\n"
+        << "      \"positions\": { \"white\": [ { \"x\": 0, \"y\": 0 } ], \"black\": [ { \"x\": 63, \"y\": 63 } ] },\n"
+        << "      \"movement\": { \"forward\": 1, \"backward\": 1, \"sideways\": 1, \"diagonal\": 1 } },\n"
+        << "    { \"type\": \"knight\", \"count\": 3,\n"
+        << "      \"positions\": { \"white\": [ { \"x\": 50, \"y\": 60 }, { \"x\": 52, \"y\": 60 }, "
+        << "{ \"x\": 54, \"y\": 60 } ],\n"
+        << "                     \"black\": [ { \"x\": 2, \"y\": 2 }, { \"x\": 3, \"y\": 2 }, "
+        << "{ \"x\": 3, \"y\": 3 } ] },\n"
+        << "      \"movement\": { \"forward\": 0, \"backward\": 0, \"sideways\": 0, \"diagonal\": 0, \"l_shape\": true } },\n"
+        << "    { \"type\": \"rook\", \"count\": " << rooks << ",\n      \"positions\": {";
+    for (int team = 0; team < 2; team++) {
+        out << (team == 0 ? " \"white\": [" : ", \"black\": [");
+        for (int i = 0; i < rooks; i++) {
+            int x = team == 0 ? 4 + i * 2 % 58 : 5 + i * 2 % 58;
+            int y = team == 0 ? 4 + i / 29 * 2 : 63 - i / 29 * 2;
+            out << (i == 0 ? " " : ", ") << "{ \"x\": " << x << ", \"y\": " << y << " }";
+        }
+        out << " ]";
+    }
+    out << " },\n      \"movement\": { \"forward\": -1, \"backward\": -1, \"sideways\": -1, \"diagonal\": 0 } } ] }";
+
+    ConfigReader reader("knight_mate.json");
+    if (!reader.parseConfig(out.str()))
+        throw std::runtime_error(reader.getError());
+    return std::make_shared<const Ruleset>(reader.getGameSettings(), reader.getPieceConfigs(),
+                                           reader.getPortalConfigs());
+}
+
+// Checkmate of a player with hundreds of pieces: every move of every piece is tried
+BENCH(ParallelGameOver) {
+    for (int rooks : { 128, 512 }) {
+        std::shared_ptr<const Ruleset> ruleset = makeKnightMateRuleset(rooks);
+        Move last_rook(Position(4 + (rooks - 1) * 2 % 58, 4 + (rooks - 1) / 29 * 2),
+                       Position(4 + (rooks - 1) * 2 % 58, 5 + (rooks - 1) / 29 * 2));
+        Move mate(Position(3, 3), Position(1, 2));
+
+        for (int workers : { 0, 1, 2, 4, 8 }) {
+            std::shared_ptr<ThreadPool> pool;
+            if (workers > 0)
+                pool = std::make_shared<ThreadPool>(workers);
+
+            std::string name = std::to_string(rooks) + " rooks, "
+                             + (workers == 0 ? std::string("serial") : std::to_string(workers + 1) + " threads");
+            Bench::measure(name, 20, [&]() {
+                GameManager game(ruleset);
+                game.setParallelism(pool, 1);
+                game.playTurn(last_rook);
+                game.playTurn(mate);
+                if (!game.isGameOver() || game.getWinner() != BLACK)
+                    throw std::runtime_error("Knight mate was not detected");
+            });
+        }
+    }
+}
+
+// Taking turns back & jumping around a recorded game, with the memory its history takes
+BENCH(History) {
+    const char* configs[] = { "./data/chess_pieces.json", "./data/fantasy_chess.json" };
+
+    for (const char* config_path : configs) {
+        std::shared_ptr<const Ruleset> ruleset = Ruleset::load(config_path);
+        std::vector<Move> moves = recordGame(ruleset, 200, 7);
+        std::string name = std::string(config_path).substr(7);
+
+        // Copies start with an empty history, the reserve is the difference
+        GameManager game(ruleset);
+        std::size_t reserve = game.getMemoryUsage() - GameManager(game).getMemoryUsage();
+        for (const Move& move : moves)
+            game.playTurn(move);
+        int last = game.getMoveCount();
+
+        double ns = Bench::measure(name + " undo & redo " + std::to_string(last) + " plies", 200, [&]() {
+            while (game.undo()) { }
+            while (game.redo()) { }
+        });
+
+        char line[64];
+        std::snprintf(line, sizeof(line), "%10.3f ns/turn", ns / (2 * last));
+        Bench::report(name + " per undo or redo", line);
+
+        std::uint32_t seed = 11;
+        Bench::measure(name + " seek to a random ply", 20000, [&]() {
+            seed = seed * 1664525u + 1013904223u;
+            game.seek(static_cast<int>((seed >> 8) % (last + 1)));
+        });
+
+        std::snprintf(line, sizeof(line), "%10.1f KiB", reserve / 1024.0);
+        Bench::report(name + " history reserve", line);
+    }
+}
+
+// Appending recorded games to a game log & validating them again from the mapped log
+BENCH(GameLog) {
+    const char* configs[] = { "./data/chess_pieces.json", "./data/fantasy_chess.json" };
+    std::string path = "/tmp/chess_bench_" + std::to_string(getpid()) + ".glog";
+
+    for (const char* config_path : configs) {
+        std::shared_ptr<const Ruleset> ruleset = Ruleset::load(config_path);
+        std::string name = std::string(config_path).substr(7);
+
+        std::vector<std::unique_ptr<GameManager>> games;
+        std::size_t plies = 0;
+        for (std::uint32_t seed = 1; seed <= 64; seed++) {
+            games.push_back(std::make_unique<GameManager>(ruleset));
+            for (const Move& move : recordGame(ruleset, 200, seed))
+                games.back()->playTurn(move);
+            plies += games.back()->getMoveCount();
+        }
+
+        std::remove(path.c_str());
+        std::shared_ptr<GameLog> log = GameLog::open(path);
+        double append_ns = Bench::measure(name + " append " + std::to_string(games.size()) + " games", 200, [&]() {
+            for (const auto& game : games)
+                log->append(*game);
+            log->flush();
+        });
+        log.reset();
+
+        GameManager start(ruleset);
+        std::size_t rejected, replayed = 0;
+        double replay_ns = Bench::measure(name + " replay " + std::to_string(games.size()) + " games", 3, [&]() {
+            std::unique_ptr<GameLogReader> reader = GameLogReader::open(path);
+            GameRecord record;
+            for (int i = 0; i < 64 && reader->next(record); i++)
+                replayed += replayGame(record, start, rejected);
+        });
+        std::unique_ptr<GameLogReader> reader = GameLogReader::open(path);
+        GameRecord record;
+        std::size_t record_count = 0;
+        while (reader->next(record))
+            record_count++;
+        double log_bytes = double(reader->getOffset()) * games.size() / record_count;
+        reader.reset();
+        std::remove(path.c_str());
+
+        char line[64];
+        std::snprintf(line, sizeof(line), "%10.0f games/s", games.size() * 1e9 / append_ns);
+        Bench::report(name + " appended", line);
+        std::snprintf(line, sizeof(line), "%10.0f games/s", games.size() * 1e9 / replay_ns);
+        Bench::report(name + " replayed on one core", line);
+        std::snprintf(line, sizeof(line), "%10.0f plies/s", plies * 1e9 / replay_ns);
+        Bench::report(name + " replayed on one core", line);
+        std::snprintf(line, sizeof(line), "%10.2f B/ply", log_bytes / plies);
+        Bench::report(name + " log size", line);
+        doNotOptimize(replayed);
+    }
+}
+
+// Looking positions up in an index of recorded games, every lookup reads one block
+BENCH(PositionIndex) {
+    std::shared_ptr<const Ruleset> ruleset = Ruleset::load("./data/chess_pieces.json");
+    std::string log_path = "/tmp/chess_bench_" + std::to_string(getpid()) + ".glog";
+    std::string index_path = "/tmp/chess_bench_" + std::to_string(getpid()) + ".pidx";
+    std::remove(log_path.c_str());
+
+    std::shared_ptr<GameLog> log = GameLog::open(log_path);
+    for (std::uint32_t seed = 1; seed <= 256; seed++) {
+        GameManager game(ruleset);
+        for (const Move& move : recordGame(ruleset, 200, seed))
+            game.playTurn(move);
+        log->append(game);
+    }
+    log.reset();
+
+    GameManager start(ruleset);
+    std::vector<std::uint64_t> positions, game_positions;
+    double build_ns = Bench::measure("build from 256 games", 3, [&]() {
+        PositionIndexBuilder builder(index_path, start);
+        std::unique_ptr<GameLogReader> reader = GameLogReader::open(log_path);
+        GameRecord record;
+        while (reader->next(record))
+            builder.addGame(record);
+        builder.finish();
+    });
+
+    std::unique_ptr<GameLogReader> reader = GameLogReader::open(log_path);
+    GameRecord record;
+    std::size_t rejected;
+    while (reader->next(record)) {
+        replayGame(record, start, rejected, &game_positions);
+        positions.insert(positions.end(), game_positions.begin(), game_positions.end());
+    }
+
+    std::unique_ptr<PositionIndex> index = PositionIndex::open(index_path);
+    std::vector<MoveStats> stats;
+    std::uint32_t seed = 3;
+    double find_ns = Bench::measure("find a recorded position", 200000, [&]() {
+        seed = seed * 1664525u + 1013904223u;
+        doNotOptimize(index->find(positions[(seed >> 8) % positions.size()], stats));
+    });
+    Bench::measure("find a missing position", 200000, [&]() {
+        seed = seed * 1664525u + 1013904223u;
+        doNotOptimize(index->find(seed, stats));
+    });
+
+    char line[64];
+    std::snprintf(line, sizeof(line), "%10.0f games/s", 256 * 1e9 / build_ns);
+    Bench::report("indexed", line);
+    std::snprintf(line, sizeof(line), "%10llu", static_cast<unsigned long long>(index->getEntryCount()));
+    Bench::report("entries", line);
+    std::snprintf(line, sizeof(line), "%10.0f queries/s", 1e9 / find_ns);
+    Bench::report("lookups", line);
+
+    index.reset();
+    std::remove(log_path.c_str());
+    std::remove(index_path.c_str());
+}
@@ -0,0 +1,173 @@
+#include "Bench.hpp"
+#include "GameManager.hpp"
+
+#include <sstream>
+
+/**
+ * @brief A board_size sided board with a king & a few long range queens per team
+ */
+static std::shared_ptr<const Ruleset> makeSlidingRuleset(int board_size, int queens) {
+    std::ostringstream out;
+    out << "{ \"game_settings\": { \"name\": \"sliding\", \"board_size\": " << board_size
+        << ", \"turn_limit\": 100 },\n  \"pieces\": [\n"
+        << "    { \"type\": \"king\", \"king_type\": true, \"count\": 1,\n"
+        << "      \"positions\": { \"white\": [ { \"x\": 0, \"y\": 0 } ], \"black\": [ { \"x\": "
+        << board_size - 1 << ", \"y\": " << board_size - 1 << " } ] },\n"
+        << "      \"movement\": { \"forward\": 1, \"backward\": 1, \"sideways\": 1, \"diagonal\": 1 } },\n"
+        << "    { \"type\": \"queen\", \"count\": " << queens << ",\n      \"positions\": {";
+    for (int team = 0; team < 2; team++) {
+        out << (team == 0 ? " \"white\": [" : ", \"black\": [");
+        for (int i = 0; i < queens; i++) {
+            int x = (i * 7 + 3) % board_size;
+            int y = team == 0 ? 1 + i % 3 : board_size - 2 - i % 3;
+            out << (i == 0 ? " " : ", ") << "{ \"x\": " << x << ", \"y\": " << y << " }";
+        }
+        out << " ]";
+    }
+    out << " },\n      \"movement\": { \"forward\": -1, \"backward\": -1, \"sideways\": -1, \"diagonal\": -1 } } ] }";
+
+    ConfigReader reader("sliding.json");
+    if (!reader.parseConfig(out.str()))
+        throw std::runtime_error(reader.getError());
+    return std::make_shared<const Ruleset>(reader.getGameSettings(), reader.getPieceConfigs(),
+                                           reader.getPortalConfigs());
+}
+
+// Move generation & legality where most moves are long slides
+BENCH(SlidingMoves) {
+    for (int board_size : { 8, 32, 64 }) {
+        GameManager game(makeSlidingRuleset(board_size, board_size / 4));
+        std::string name = std::to_string(board_size) + "x" + std::to_string(board_size);
+
+        std::size_t count = game.getCandidateMoves().size();
+        Bench::measure(name + " candidate moves (" + std::to_string(count) + ")", 200, [&]() {
+            doNotOptimize(game.getCandidateMoves());
+        });
+
+        std::vector<Move> moves = game.getCandidateMoves();
+        Bench::measure(name + " isMoveLegal of all", 20, [&]() {
+            for (const Move& move : moves)
+                doNotOptimize(game.isMoveLegal(move));
+        });
+    }
+}
+
+// Move generation of every piece, compile time geometry against the generic one
+BENCH(BoardGeometry) {
+    std::pair<std::string, std::shared_ptr<const Ruleset>> rulesets[] = {
+        { "chess", Ruleset::load("./data/chess_pieces.json") },
+        { "10x10 sliding", makeSlidingRuleset(10, 4) },
+        { "16x16 sliding", makeSlidingRuleset(16, 6) },
+    };
+
+    for (const auto& [name, ruleset] : rulesets) {
+        ChessBoard board(ruleset);
+        std::vector<Move> moves;
+        moves.reserve(1024);
+
+        for (bool specialize : { false, true }) {
+            MoveValidator validator(board, specialize);
+            Bench::measure(name + (specialize ? " specialized" : " generic"), 2000, [&]() {
+                moves.clear();
+                for (const ChessPiece& piece : board.getPieces())
+                    validator.getMoves(piece, moves);
+                doNotOptimize(moves);
+            });
+        }
+    }
+}
+
+// Boards far larger than the piece count: work should follow the pieces, not the area
+BENCH(Megaboard) {
+    for (int board_size : { 64, 128, 256 }) {
+        std::shared_ptr<const Ruleset> ruleset = makeSlidingRuleset(board_size, 100);
+        GameManager game(ruleset);
+        std::string name = std::to_string(board_size) + "x" + std::to_string(board_size);
+
+        std::vector<Move> moves = game.getCandidateMoves();
+        Bench::measure(name + " candidate moves (" + std::to_string(moves.size()) + ")", 20, [&]() {
+            doNotOptimize(game.getCandidateMoves());
+        });
+
+        Bench::measure(name + " isMoveLegal of all", 5, [&]() {
+            for (const Move& move : moves)
+                doNotOptimize(game.isMoveLegal(move));
+        });
+
+        Bench::measure(name + " board copy", 200, [&]() {
+            ChessBoard board(game.getBoard());
+            doNotOptimize(board);
+        });
+
+        char line[64];
+        std::snprintf(line, sizeof(line), "%10zu B", game.getBoard().getHeapUsage());
+        Bench::report(name + " board heap", line);
+    }
+}
+
+// Attack sets of wide boards: the kernels of each instruction set, then whole team maps
+BENCH(AttackMaps) {
+    Bitboard256 origins = {}, empty = {};
+    for (int i = 0; i < 16; i++) {
+        origins.set(Position((i * 5) % 16, (i * 3) % 16));
+        empty.set(Position((i * 7 + 1) % 16, (i * 11 + 2) % 16));
+    }
+    for (int i = 0; i < 4; i++)
+        empty.words[i] = ~empty.words[i];
+
+    Bitboard256 mask = Bitboard256::getBoardMask(16);
+    for (const AttackKernels* kernels : AttackKernels::getSupported()) {
+        Bench::measure(std::string(kernels->name) + " 8 slides + 8 leaps", 100000, [&]() {
+            Bitboard256 attacks = {};
+            for (int direction = 0; direction < DIRECTION_COUNT; direction++)
+                attacks |= kernels->slide(origins, empty, mask, DIRECTION_DX[direction], DIRECTION_DY[direction]);
+            for (auto [dx, dy] : { std::pair{ 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 },
+                                   { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } })
+                attacks |= kernels->step(origins, empty, mask, dx, dy, 1);
+            doNotOptimize(attacks);
+        });
+    }
+
+    ConfigReader reader("./data/chess_pieces.json");
+    if (!reader.readConfig())
+        throw std::runtime_error(reader.getError());
+
+    for (int board_size : { 8, 10, 16 }) {
+        GameSettings settings = reader.getGameSettings();
+        settings.board_size = board_size;
+        GameManager game(std::make_shared<const Ruleset>(settings, reader.getPieceConfigs(),
+                                                         reader.getPortalConfigs()));
+        std::uint32_t seed = 11;
+        for (int ply = 0; ply < 20 && !game.isGameOver(); ply++) {
+            std::vector<Move> moves = game.getLegalMoves();
+            seed = seed * 1664525u + 1013904223u;
+            game.playTurn(moves[(seed >> 8) % moves.size()]);
+        }
+
+        std::string name = std::to_string(board_size) + "x" + std::to_string(board_size);
+        const ChessBoard& board = game.getBoard();
+        MoveValidator validator(board);
+        Position king;
+        for (const ChessPiece& piece : board.getPiecesOfTeam(WHITE))
+            if (piece.king_type)
+                king = piece.position;
+
+        Bench::measure(name + " check by piece", 100000, [&]() {
+            bool check = false;
+            for (const ChessPiece& piece : board.getPiecesOfTeam(BLACK))
+                check = check || validator.validateMove(piece, king);
+            doNotOptimize(check);
+        });
+        Bench::measure(name + " check by attack map", 100000, [&]() {
+            Bitboard256 attacks;
+            validator.getTeamAttacks(BLACK, attacks);
+            doNotOptimize(attacks.test(king));
+        });
+
+        std::vector<Move> moves = game.getCandidateMoves();
+        Bench::measure(name + " isMoveLegal of all", 200, [&]() {
+            for (const Move& move : moves)
+                doNotOptimize(game.isMoveLegal(move));
+        });
+    }
+}
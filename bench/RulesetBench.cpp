@@ -0,0 +1,53 @@
+#include "Bench.hpp"
+#include "GameManager.hpp"
+#include "RulesetCache.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <unistd.h>
+
+static std::string readFile(const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream source;
+    source << file.rdbuf();
+    return source.str();
+}
+
+// Startup of a process or session, from config file to a ready ruleset & game
+BENCH(RulesetStartup) {
+    const char* configs[] = { "./data/chess_pieces.json", "./data/fantasy_chess.json" };
+    std::string cache_path = "/tmp/chess_bench_" + std::to_string(getpid()) + ".rsc";
+
+    for (const char* config_path : configs) {
+        std::string source = readFile(config_path);
+        std::uint64_t source_hash = RulesetCache::hashSource(source);
+        std::string name = std::string(config_path).substr(7);
+
+        Bench::measure(name + " json parse + compile", 2000, [&]() {
+            ConfigReader reader(config_path);
+            reader.readConfig();
+            Ruleset ruleset(reader.getGameSettings(), reader.getPieceConfigs(), reader.getPortalConfigs());
+            doNotOptimize(ruleset);
+        });
+
+        ConfigReader reader(config_path);
+        reader.readConfig();
+        Ruleset compiled(reader.getGameSettings(), reader.getPieceConfigs(), reader.getPortalConfigs());
+        RulesetCache::write(compiled, source_hash, cache_path);
+
+        Bench::measure(name + " cache hash + mmap", 2000, [&]() {
+            std::uint64_t hash = RulesetCache::hashSource(readFile(config_path));
+            doNotOptimize(RulesetCache::read(cache_path, hash));
+        });
+
+        std::shared_ptr<const Ruleset> shared = RulesetCache::read(cache_path, source_hash);
+        Bench::measure(name + " new game from shared ruleset", 2000, [&]() {
+            GameManager game(shared);
+            doNotOptimize(game);
+        });
+    }
+
+    std::remove(cache_path.c_str());
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "ConfigReader.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Set of squares of a board up to 16 squares a side, one bit per
+ * square at y * 16 + x. Left uninitialized unless value initialized with {}
+ */
+struct alignas(32) Bitboard256 {
+    /**
+     * @brief Squares per rank, boards narrower than this leave files unused
+     */
+    static constexpr int WIDTH = 16;
+
+    std::uint64_t words[4];
+
+    inline bool test(Position position) const {
+        int bit = position.y * WIDTH + position.x;
+        return (words[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    inline void set(Position position) {
+        int bit = position.y * WIDTH + position.x;
+        words[bit >> 6] |= std::uint64_t(1) << (bit & 63);
+    }
+
+    inline bool isEmpty() const {
+        return (words[0] | words[1] | words[2] | words[3]) == 0;
+    }
+
+    inline Bitboard256& operator|=(const Bitboard256& other) {
+        for (int i = 0; i < 4; i++)
+            words[i] |= other.words[i];
+        return *this;
+    }
+
+    inline bool operator==(const Bitboard256& other) const {
+        for (int i = 0; i < 4; i++)
+            if (words[i] != other.words[i])
+                return false;
+        return true;
+    }
+
+    /**
+     * @brief Get the squares of a board of the given size
+     */
+    static Bitboard256 getBoardMask(int size);
+};
+
+/**
+ * @brief Attack set kernels over 256-bit boards, one table per instruction
+ * set. Ranks are 16-bit lanes, so steps along files cannot wrap to the next
+ * rank. Steps go dx files & dy ranks, both from -2 to 2, and stay within
+ * the board given as mask.
+ */
+struct AttackKernels {
+    using SlideFunction = Bitboard256 (*)(const Bitboard256& origins, const Bitboard256& empty,
+                                          const Bitboard256& mask);
+    using StepFunction = Bitboard256 (*)(const Bitboard256& origins, const Bitboard256& empty,
+                                         const Bitboard256& mask, int distance);
+
+    /**
+     * @brief Name of the instruction set
+     */
+    const char* name;
+
+    /**
+     * @brief Kernels specialized on the step, indexed by (dx + 2) * 5 + dy + 2
+     */
+    SlideFunction slides[25];
+    StepFunction steps[25];
+
+    /**
+     * @brief Squares reached by sliding from the origins along a step, up to
+     * the board edge or up to & including the first square not in empty.
+     * Kogge-Stone fill, all origins move at once.
+     */
+    inline Bitboard256 slide(const Bitboard256& origins, const Bitboard256& empty,
+                             const Bitboard256& mask, int dx, int dy) const {
+        return slides[(dx + 2) * 5 + dy + 2](origins, empty, mask);
+    }
+
+    /**
+     * @brief Squares exactly distance steps from the origins, the squares in
+     * between in empty. A distance of 1 is the union of the leaps of all origins.
+     */
+    inline Bitboard256 step(const Bitboard256& origins, const Bitboard256& empty,
+                            const Bitboard256& mask, int dx, int dy, int distance) const {
+        return steps[(dx + 2) * 5 + dy + 2](origins, empty, mask, distance);
+    }
+
+    /**
+     * @brief Get the fastest kernels the CPU supports, picked once via CPUID
+     */
+    static const AttackKernels& get();
+
+    /**
+     * @brief Get all kernels the CPU supports, the portable scalar ones first
+     */
+    static std::vector<const AttackKernels*> getSupported();
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "ConfigReader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief Amount of unit steps along ranks, files & diagonals
+ */
+inline constexpr int DIRECTION_COUNT = 8;
+
+/**
+ * @brief Offsets of the unit steps, indexed by direction
+ */
+inline constexpr short DIRECTION_DX[DIRECTION_COUNT] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+inline constexpr short DIRECTION_DY[DIRECTION_COUNT] = { 0, 0, 1, -1, 1, 1, -1, -1 };
+
+/**
+ * @brief Get the direction of a unit step
+ * @returns -1 if the step is not a unit step
+ */
+constexpr int getDirection(int dx, int dy) {
+    for (int direction = 0; direction < DIRECTION_COUNT; direction++)
+        if (DIRECTION_DX[direction] == dx && DIRECTION_DY[direction] == dy)
+            return direction;
+    return -1;
+}
+
+/**
+ * @brief Get the steps from a square to the edge of a board along a direction
+ */
+constexpr int computeEdgeDistance(int size, int x, int y, int direction) {
+    int dx = DIRECTION_DX[direction];
+    int dy = DIRECTION_DY[direction];
+    int steps = size;
+    if (dx != 0)
+        steps = std::min(steps, dx > 0 ? size - 1 - x : x);
+    if (dy != 0)
+        steps = std::min(steps, dy > 0 ? size - 1 - y : y);
+    return steps;
+}
+
+/**
+ * @brief Build the edge distances of every square of an N sided board
+ */
+template <int N>
+constexpr std::array<std::array<std::uint8_t, DIRECTION_COUNT>, N * N> makeEdgeDistances() {
+    std::array<std::array<std::uint8_t, DIRECTION_COUNT>, N * N> distances = {};
+    for (int y = 0; y < N; y++)
+        for (int x = 0; x < N; x++)
+            for (int direction = 0; direction < DIRECTION_COUNT; direction++)
+                distances[y * N + x][direction] = static_cast<std::uint8_t>(
+                    computeEdgeDistance(N, x, y, direction));
+    return distances;
+}
+
+/**
+ * @brief Geometry of a board whose size is known at compile time. Bounds
+ * checks fold into constant compares & edge distances come from a table
+ * generated at compile time
+ */
+template <int N>
+class BoardGeometry {
+public:
+    static_assert(N > 0 && N < 256, "Edge distances are stored in a byte");
+
+    inline int getSize() const { return N; }
+
+    inline bool contains(Position position) const {
+        return static_cast<unsigned>(position.x) < N && static_cast<unsigned>(position.y) < N;
+    }
+
+    inline int getEdgeDistance(Position position, int direction) const {
+        return EDGE_DISTANCES[position.y * N + position.x][direction];
+    }
+
+private:
+    static constexpr std::array<std::array<std::uint8_t, DIRECTION_COUNT>, N * N> EDGE_DISTANCES
+        = makeEdgeDistances<N>();
+};
+
+/**
+ * @brief Geometry of a board of any size, computed as it is asked for
+ */
+class GenericGeometry {
+public:
+    explicit inline GenericGeometry(int size) : size(size) { }
+
+    inline int getSize() const { return size; }
+
+    inline bool contains(Position position) const {
+        return position.x >= 0 && position.y >= 0 && position.x < size && position.y < size;
+    }
+
+    inline int getEdgeDistance(Position position, int direction) const {
+        return computeEdgeDistance(size, position.x, position.y, direction);
+    }
+
+private:
+    int size;
+};
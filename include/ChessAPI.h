@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+ * @brief Plain C interface of libchess
+ *
+ * Every function is safe to call from other runtimes through a C FFI.
+ * Tensor functions write into caller-provided buffers, no copies are made
+ * on the library side.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Opaque handle of a single game
+ */
+typedef struct chess_game chess_game;
+
+/**
+ * @brief Create a game from a JSON config file
+ * @returns NULL on failure
+ */
+chess_game* chess_game_create(const char* config_path);
+
+/**
+ * @brief Destroy a game created with chess_game_create
+ */
+void chess_game_destroy(chess_game* game);
+
+/**
+ * @brief Play a single turn
+ * @returns 1 if the piece was moved, 0 if the move was rejected, -1 on error
+ */
+int chess_game_play_turn(chess_game* game, int from_x, int from_y, int to_x, int to_y);
+
+/**
+ * @brief Get the current player, WHITE (0) or BLACK (1)
+ */
+int chess_game_current_player(chess_game* game);
+
+/**
+ * @brief Get whether the game is over
+ */
+int chess_game_is_over(chess_game* game);
+
+/**
+ * @brief Get the hit & miss counters of the legal move cache of a game.
+ * Games only share the cache with copies of themselves
+ * @returns 0 on success, -1 on error
+ */
+int chess_game_move_cache_stats(chess_game* game, uint64_t* hits, uint64_t* misses);
+
+/**
+ * @brief Get board length
+ */
+int chess_game_board_size(chess_game* game);
+
+/**
+ * @brief Get the amount of feature planes of a single position
+ */
+size_t chess_game_plane_count(chess_game* game);
+
+/**
+ * @brief Get the amount of elements of a single position tensor
+ */
+size_t chess_game_tensor_size(chess_game* game);
+
+/**
+ * @brief Encode the current position into a caller-provided buffer
+ * @param capacity Amount of elements the buffer can hold
+ * @returns 0 on success, -1 if the buffer is too small or on error
+ */
+int chess_encode_f32(chess_game* game, float* out, size_t capacity);
+int chess_encode_u8(chess_game* game, uint8_t* out, size_t capacity);
+
+/**
+ * @brief Encode the positions of many games into one contiguous buffer
+ * All games must be created from configs with the same board size & the same
+ * piece types in the same order, their other rules may differ.
+ * @param capacity Amount of elements the buffer can hold
+ * @returns 0 on success, -1 if the buffer is too small or on error
+ */
+int chess_encode_batch_f32(chess_game* const* games, size_t count, float* out, size_t capacity);
+int chess_encode_batch_u8(chess_game* const* games, size_t count, uint8_t* out, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
@@ -3,12 +3,92 @@
 #include "ConfigReader.hpp"
 #include "ChessPiece.hpp"
 #include "Portal.hpp"
+#include "Ruleset.hpp"
 
-#include <list>
+#include <cstdint>
 #include <set>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Index of a piece within the piece pool of a board, stable until the piece is freed
+ */
+using PieceHandle = std::uint16_t;
+
+/**
+ * @brief Range over the pieces of one or both teams, one team after the other
+ */
+template <typename Piece>
+class PieceRange {
+public:
+    class Iterator {
+    public:
+        inline Iterator(Piece* pool, const std::vector<PieceHandle>* teams, int team, int last_team)
+            : pool(pool), teams(teams), team(team), last_team(last_team), index(0) {
+            skipEmptyTeams();
+        }
+
+        inline Piece& operator*() const { return pool[teams[team][index]]; }
+        inline Piece* operator->() const { return &pool[teams[team][index]]; }
+
+        inline Iterator& operator++() {
+            index++;
+            skipEmptyTeams();
+            return *this;
+        }
+
+        inline bool operator==(const Iterator& other) const {
+            return team == other.team && index == other.index;
+        }
+
+        inline bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        inline void skipEmptyTeams() {
+            while (team < last_team && index == teams[team].size()) {
+                team++;
+                index = 0;
+            }
+        }
+
+        Piece* pool;
+        const std::vector<PieceHandle>* teams;
+        int team;
+        int last_team;
+        std::size_t index;
+    };
+
+    inline PieceRange(Piece* pool, const std::vector<PieceHandle>* teams, int first_team, int last_team)
+        : pool(pool), teams(teams), first_team(first_team), last_team(last_team) { }
+
+    inline Iterator begin() const { return Iterator(pool, teams, first_team, last_team); }
+    inline Iterator end() const { return Iterator(pool, teams, last_team, last_team); }
+
+    inline std::size_t size() const {
+        std::size_t count = 0;
+        for (int team = first_team; team < last_team; team++)
+            count += teams[team].size();
+        return count;
+    }
+
+private:
+    Piece* pool;
+    const std::vector<PieceHandle>* teams;
+    int first_team;
+    int last_team;
+};
 
 /**
  * @brief Class representing a chess board
+ *
+ * Boards of up to MAX_DENSE_SIZE squares a side keep per-square state in
+ * flat arrays & per-line occupancy bitsets. Larger boards are sparse: they
+ * hash occupied squares, and keep the portal squares & the coordinates of
+ * the pieces on every line sorted, so that lookups & path checks scale with
+ * the piece count instead of the board area. All of it lives in flat
+ * vectors, copying a board stays a handful of allocations.
  */
 class ChessBoard {
 public:
@@ -18,33 +98,70 @@ public:
     explicit ChessBoard(const GameSettings& game_setting, 
                         const std::vector<PieceConfig>& piece_configs);
 
+    /**
+     * @brief Initialize a chess board with the pieces & portals of the given ruleset
+     */
+    explicit ChessBoard(std::shared_ptr<const Ruleset> ruleset);
+
+    /**
+     * @brief Get the ruleset shared by this board
+     */
+    const std::shared_ptr<const Ruleset>& getRuleset() const;
+
+    /**
+     * @brief Boards up to this many squares a side are dense
+     */
+    static constexpr int MAX_DENSE_SIZE = 64;
+
     /**
      * @brief Get board length
      */
     int getSize() const;
 
     /**
-     * @brief Get chess pieces
+     * @brief Whether the board keeps sparse per-square state
+     */
+    bool isSparse() const;
+
+    /**
+     * @brief Get chess pieces, white ones first
      */
-    const std::list<ChessPiece>& getPieces() const;
-    std::list<ChessPiece>& getPieces();
+    PieceRange<const ChessPiece> getPieces() const;
+    PieceRange<ChessPiece> getPieces();
 
     /**
      * @brief Get portals
      */
-    const std::list<Portal>& getPortals() const;
-    std::list<Portal>& getPortals();
+    const std::vector<Portal>& getPortals() const;
+    std::vector<Portal>& getPortals();
+
+    /**
+     * @brief Get the chess pieces of the given team, a scan of its index array
+     */
+    PieceRange<const ChessPiece> getPiecesOfTeam(team_t team) const;
+    PieceRange<ChessPiece> getPiecesOfTeam(team_t team);
+
+    /**
+     * @brief Get the handle of a piece on this board
+     */
+    PieceHandle getHandle(const ChessPiece& piece) const;
+
+    /**
+     * @brief Get the piece of a handle
+     */
+    ChessPiece& getPiece(PieceHandle handle);
+    const ChessPiece& getPiece(PieceHandle handle) const;
 
     /**
-     * @brief Get the chess pieces of the given team
+     * @brief Get the name of the type of a piece
      */
-    std::list<const ChessPiece*> getPiecesOfTeam(team_t team) const;
-    std::list<ChessPiece*> getPiecesOfTeam(team_t team);
+    const std::string& getTypeName(const ChessPiece& piece) const;
 
     /**
      * @brief Get king piece of the given team
      */
     ChessPiece* getKingOfTeam(team_t team);
+    const ChessPiece* getKingOfTeam(team_t team) const;
 
     /**
      * @brief Get piece positions of team
@@ -52,15 +169,43 @@ public:
     std::set<Position> getPositionsOfTeam(team_t team) const;
 
     /**
-     * @brief Remove chess piece
+     * @brief Remove chess piece, freeing its slot in the pool
      */
     void removePiece(const ChessPiece* piece);
 
     /**
-     * @brief Add chess piece
+     * @brief Take a chess piece off the board without freeing it, so that it
+     * can be put back by restorePiece. Neither allocates
+     */
+    void capturePiece(const ChessPiece* piece);
+
+    /**
+     * @brief Put the last captured chess piece back where it was
+     */
+    void restorePiece();
+
+    /**
+     * @brief Free the captured chess pieces, they can no longer be restored
+     */
+    void clearCaptured();
+
+    /**
+     * @brief Remove all chess pieces, captured ones included, freeing their slots
+     */
+    void clearPieces();
+
+    /**
+     * @brief Add chess piece into a free slot of the pool. Once all slots
+     * the ruleset places are taken the pool grows, moving every piece
      */
     void addPiece(const ChessPiece& piece);
 
+    /**
+     * @brief Add chess piece like addPiece, without checking it. Its square
+     * must be empty & on the board, its type of the ruleset & its team set
+     */
+    void placePiece(const ChessPiece& piece);
+
     /**
      * @brief Add portal
      */
@@ -77,10 +222,70 @@ public:
     ChessPiece* getPieceAtPosition(Position position);
     const ChessPiece* getPieceAtPosition(Position position) const;
 
+    /**
+     * @brief Check whether a square holds a piece, a single bit test
+     */
+    bool isOccupied(Position position) const;
+
+    /**
+     * @brief Get the occupied squares of a rank, bit x for file x. Dense boards only
+     */
+    std::uint64_t getRankOccupancy(int y) const;
+
+    /**
+     * @brief Check that no piece sits strictly between two squares sharing
+     * a rank, file or diagonal, a single masked bit test on dense boards
+     */
+    bool isPathClear(Position from, Position to) const;
+
+    /**
+     * @brief Find the first piece walking from origin in a unit direction
+     * @returns false if the walk reaches the board edge first
+     */
+    bool findFirstBlocker(Position origin, int dx, int dy, Position& blocker) const;
+
     /**
      * @brief Get the portal at the given location
      */
     Portal* getPortalAtPosition(Position position);
+    const Portal* getPortalAtPosition(Position position) const;
+
+    /**
+     * @brief Get where a piece entering the given square is sent to
+     * @returns nullptr if no portal can be entered there
+     */
+    const PortalTransition* getTransition(Position position) const;
+
+    /**
+     * @brief Get the portal clock, advanced once per played turn
+     */
+    int getPortalClock() const;
+
+    /**
+     * @brief Advance the portal clock by one turn
+     */
+    void advancePortalClock();
+
+    /**
+     * @brief Turn the portal clock back by one turn, as a turn is taken back
+     */
+    void rewindPortalClock();
+
+    /**
+     * @brief Get the remaining cooldown of a portal in turns
+     */
+    int getPortalCooldown(const Portal& portal) const;
+
+    /**
+     * @brief Set the remaining cooldown of a portal in turns
+     */
+    void setPortalCooldown(Portal& portal, int turns);
+
+    /**
+     * @brief Get a Zobrist style hash of the pieces and of the portals which are
+     * on cooldown. Equal positions of a ruleset hash equally
+     */
+    std::uint64_t getPositionHash() const;
 
     /**
      * @brief Teleport a piece into location
@@ -88,21 +293,125 @@ public:
     void movePiece(ChessPiece& piece, Position location);
 
     /**
-     * @brief Print the board in a human readable format
+     * @brief Print the board in a human readable format. Boards of more than
+     * MAX_PRINTED_SIZE squares a side are printed through a window around the
+     * first highlighted square
      */
     void printBoard(std::set<Position> highlight) const;
     void printBoard() const;
 
+    /**
+     * @brief Print the squares of a window of the board, corner being its lower left square
+     */
+    void printWindow(Position corner, int width, int height, const std::set<Position>& highlight) const;
+
+    static constexpr int MAX_PRINTED_SIZE = 26;
+
+    /**
+     * @brief Get the bytes allocated on the heap by this board
+     */
+    std::size_t getHeapUsage() const;
+
 private:
     /**
-     * @brief Remaining chess pieces
+     * @brief Rules of the variant
+     */
+    std::shared_ptr<const Ruleset> ruleset;
+
+    /**
+     * @brief Pool of chess pieces, slots of removed pieces are reused
+     */
+    std::vector<ChessPiece> pool;
+
+    /**
+     * @brief Handles of the pieces on the board, per team in insertion order
+     */
+    std::vector<PieceHandle> team_pieces[2];
+
+    /**
+     * @brief Slots of the pool which hold no piece
+     */
+    std::vector<PieceHandle> free_slots;
+
+    /**
+     * @brief Pieces taken off by capturePiece, last one at the back, along with
+     * their place in the index of their team. Captures of played turns stay
+     * until clearCaptured, so that taking a turn back can restore them
+     */
+    struct Capture {
+        PieceHandle handle;
+        std::uint16_t index;
+    };
+    std::vector<Capture> captured;
+
+    /**
+     * @brief Occupied squares of every rank, file, diagonal & anti-diagonal,
+     * one bit per square. Dense boards only
+     */
+    std::vector<std::uint64_t> occupancy;
+
+    /**
+     * @brief Keys of the pieces on every line, the line index as in occupancy
+     * followed by the coordinate of the piece on it. Sorted, sparse boards only
+     */
+    std::vector<std::uint64_t> line_keys;
+
+    /**
+     * @brief Open addressing table of the occupied squares, probed linearly.
+     * Sparse boards only
+     */
+    struct SquareSlot {
+        std::uint32_t square;
+        PieceHandle handle;
+    };
+    std::vector<SquareSlot> square_slots;
+    std::size_t square_count;
+    static constexpr std::uint32_t EMPTY_SQUARE = ~std::uint32_t(0);
+
+    /**
+     * @brief Find the slot of a square, or the empty slot ending its probe
+     */
+    std::size_t findSquareSlot(std::uint32_t square) const;
+
+    /**
+     * @brief Set or clear the piece of a square, growing the table when half full
+     */
+    void setSquare(std::uint32_t square, PieceHandle handle);
+    void clearSquare(std::uint32_t square);
+
+    /**
+     * @brief Set or clear a square in all of its lines
      */
-    std::list<ChessPiece> pieces;
+    void setOccupied(Position position, PieceHandle handle, bool occupied);
+
+    /**
+     * @brief Get the index of the line through a square along a unit direction,
+     * along with the coordinate of the square on it & the step in coordinates
+     * a move along the direction makes
+     */
+    std::size_t getLineIndex(Position position, int dx, int dy, int& coordinate, int& step) const;
 
     /**
      * @brief Portals
      */
-    std::list<Portal> portals;
+    std::vector<Portal> portals;
+
+    /**
+     * @brief Portal transition of every square, built as portals are added.
+     * Sparse boards only keep the squares of portals
+     */
+    std::vector<PortalTransition> transitions;
+    std::vector<std::pair<std::uint32_t, PortalTransition>> sparse_transitions;
+
+    /**
+     * @brief Set the transition of a square, unless kept & it has one already
+     */
+    void setTransition(Position position, const PortalTransition& transition, bool overwrite);
+
+    /**
+     * @brief Turns played, portal cooldowns are kept relative to it
+     */
+    int portal_clock;
 
     /**
      * @brief Board length
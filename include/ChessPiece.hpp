@@ -2,7 +2,9 @@
 
 #include "ConfigReader.hpp"
 
-/** @brief Struct representing a chess piece */
+#include <cstdint>
+
+/** @brief Struct representing a chess piece, packed into 8 bytes */
 struct ChessPiece {
     /**
      * @brief Position within the chess board
@@ -10,14 +12,9 @@ struct ChessPiece {
     Position position;
 
     /**
-     * @brief The type of the piece
-     */
-    std::string type;
-
-    /**
-     * @brief Whether type is king
+     * @brief Id of the type within the ruleset, the name is kept there
      */
-    bool king_type;
+    std::int16_t type_id;
 
     /**
      * @brief The piece is white
@@ -25,19 +22,21 @@ struct ChessPiece {
     team_t team;
 
     /**
-     * @brief Whether the piece was used at all
+     * @brief Whether type is king
      */
-    bool used;
+    bool king_type : 1;
 
     /**
-     * @brief Initialize a chess piece with given values
+     * @brief Whether the piece was used at all
      */
-    inline ChessPiece(std::string type, bool king_type, Position position, team_t team)
-        : position(position), type(type), king_type(king_type), team(team), used(false) { }
+    bool used : 1;
 
     /**
      * @brief Initialize a chess piece with given values
      */
-    inline ChessPiece(std::string type, bool king_type, Position position, team_t team, bool used)
-        : position(position), type(type), king_type(king_type), team(team), used(used) { }
-};
\ No newline at end of file
+    inline ChessPiece(int type_id, bool king_type, Position position, team_t team, bool used = false)
+        : position(position), type_id(static_cast<std::int16_t>(type_id)), team(team),
+          king_type(king_type), used(used) { }
+};
+
+static_assert(sizeof(ChessPiece) <= 8, "ChessPiece is meant to stay packed");
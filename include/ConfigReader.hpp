@@ -1,7 +1,7 @@
 #pragma once
 
+#include <limits>
 #include <memory>
-#include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -43,11 +43,21 @@ struct Position {
    * @brief Print implementation
    */
   friend inline std::ostream& operator<<(std::ostream& os, const Position& pos) {
-    os << (char)('a' + pos.x);
+    os << getFileName(pos.x);
     os << pos.y + 1;
     return os;
   }
 
+  /**
+   * @brief Name of a file: a to z, then aa, ab, ... zz, aaa & so on
+   */
+  static inline std::string getFileName(int x) {
+    std::string name;
+    for (int file = x + 1; file > 0; file = (file - 1) / 26)
+      name.insert(name.begin(), static_cast<char>('a' + (file - 1) % 26));
+    return name;
+  }
+
   /**
    * @brief Initializer
    */
@@ -136,45 +146,49 @@ class ConfigReader {
    */
   bool readConfig();
 
+  /**
+   * @brief Parse configuration already read into memory
+   * @param source JSON text of the configuration
+   * @return true if successful, false otherwise
+   */
+  bool parseConfig(const std::string& source);
+
+  /**
+   * @brief Get why the last read or parse failed
+   * @return Message prefixed with line:column, empty after success
+   */
+  const std::string& getError() const;
+
   /**
    * @brief Get the parsed game settings
    * @return GameSettings structure containing game configuration
    */
-  GameSettings getGameSettings() const;
+  const GameSettings& getGameSettings() const;
 
   /**
    * @brief Get the parsed piece configurations
    * @return Vector of PieceConfig structures
    */
-  std::vector<PieceConfig> getPieceConfigs() const;
+  const std::vector<PieceConfig>& getPieceConfigs() const;
 
   /**
    * @brief Get the parsed portal configurations
    * @return Vector of PortalConfig structures
    */
-  std::vector<PortalConfig> getPortalConfigs() const;
+  const std::vector<PortalConfig>& getPortalConfigs() const;
 
  private:
   std::string config_path_;
   GameSettings game_settings_;
   std::vector<PieceConfig> piece_configs_;
   std::vector<PortalConfig> portal_configs_;
+  std::string error_;
 
   /**
-   * @brief Parse game settings from JSON
-   * @param json JSON object containing game settings
-   */
-  void parseGameSettings(const nlohmann::json& json);
-
-  /**
-   * @brief Parse piece configurations from JSON
-   * @param json JSON object containing piece configurations
-   */
-  void parsePieceConfigs(const nlohmann::json& json);
-
-  /**
-   * @brief Parse portal configurations from JSON
-   * @param json JSON object containing portal configurations
+   * @brief Stream the JSON text through the SAX handler
+   * @param begin First character of the configuration
+   * @param end One past the last character
+   * @return true if successful, false otherwise
    */
-  void parsePortalConfigs(const nlohmann::json& json);
+  bool parse(const char* begin, const char* end);
 };
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ConfigReader.hpp"
+#include "GameManager.hpp"
+#include "Move.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+/**
+ * @brief Structure to hold the limits of a search, 0 means unlimited
+ */
+struct SearchLimits {
+    int depth{0};           // Maximum depth in plies
+    long nodes{0};          // Maximum amount of visited positions
+    long movetime{0};       // Maximum search time in milliseconds
+};
+
+/**
+ * @brief Structure to hold the outcome of a search
+ */
+struct SearchResult {
+    Move best_move;         // Best move found so far
+    bool has_move{false};   // Whether the side to move has any legal move
+    int score{0};           // Score in centipawns from the side to move
+    int depth{0};           // Depth of the last completed iteration
+    long nodes{0};          // Amount of visited positions
+    long time{0};           // Elapsed time in milliseconds
+};
+
+/**
+ * @brief Class responsible for searching the best move of a position
+ */
+class Engine {
+public:
+    /**
+     * @brief Score of a checkmate, decreased by the distance in plies
+     */
+    static constexpr int MATE_SCORE = 100000;
+
+    /**
+     * @brief Called after every completed iteration
+     */
+    using InfoCallback = std::function<void(const SearchResult&)>;
+
+    /**
+     * @brief Initialize an engine for the given ruleset
+     */
+    explicit Engine(const Ruleset& ruleset);
+
+    /**
+     * @brief Search the position of the given game with iterative deepening.
+     * Stops once a limit is hit or stop is set, returning the best move
+     * of the deepest completed iteration.
+     */
+    SearchResult search(const GameManager& game, const SearchLimits& limits,
+                        const std::atomic<bool>& stop, InfoCallback on_info = nullptr);
+
+    /**
+     * @brief Get material balance from the side to move
+     */
+    int evaluate(GameManager& game) const;
+
+private:
+    int negamax(GameManager& game, int depth, int ply, int alpha, int beta);
+    bool shouldStop();
+    void orderMoves(GameManager& game, std::vector<Move>& moves) const;
+
+    /**
+     * @brief Material value of each piece type in centipawns, indexed by type id
+     */
+    std::vector<int> piece_values;
+
+    const std::atomic<bool>* stop_flag;
+    std::chrono::steady_clock::time_point deadline;
+    bool has_deadline;
+    long node_limit;
+    long nodes;
+    bool aborted;
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "GameManager.hpp"
+#include "Move.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Outcome of a logged game
+ */
+enum GameResult : std::uint8_t {
+    WHITE_WON,
+    BLACK_WON,
+    DRAWN,
+    UNFINISHED
+};
+
+/**
+ * @brief A game as stored in a game log, its moves still encoded. Moves
+ * point into the mapped log & stay valid as long as its reader
+ */
+struct GameRecord {
+    std::uint64_t rules_hash;   // Ruleset::getRulesHash of the game
+    std::uint32_t move_count;
+    GameResult result;
+    std::uint8_t move_size;     // Bytes per move, 2 or 8
+    const unsigned char* moves;
+
+    /**
+     * @brief Decode the move of the given index
+     */
+    Move getMove(std::size_t index) const;
+};
+
+/**
+ * @brief Class responsible for appending finished games to a binary log
+ *
+ * A log file holds a fixed header followed by one record per game: the
+ * rules hash, the move count, the result & the moves. Moves take 16 bits,
+ * a nibble per coordinate, on boards up to 16 squares a side & 16 bits per
+ * coordinate beyond. Records are padded to 8 bytes. Files are only ever
+ * appended to, a record torn by a crash is cut off when the log is opened
+ * again. Appends are buffered & safe from any thread.
+ */
+class GameLog {
+public:
+    /**
+     * @brief Format version, bumped whenever the layout changes
+     */
+    static constexpr std::uint32_t VERSION = 1;
+
+    /**
+     * @brief Bytes buffered before they are written out
+     */
+    static constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+
+    /**
+     * @brief Open a log for appending, creating it when missing
+     * @returns nullptr if the file cannot be opened or is not a game log
+     */
+    static std::shared_ptr<GameLog> open(const std::string& path);
+
+    /**
+     * @brief Write out the buffered games & close the file
+     */
+    ~GameLog();
+
+    GameLog(const GameLog&) = delete;
+    GameLog& operator=(const GameLog&) = delete;
+
+    /**
+     * @brief Buffer the turns played so far & the outcome of a game, a game
+     * still running is logged as unfinished
+     * @returns false if the history does not start at the starting board
+     */
+    bool append(const GameManager& game);
+
+    /**
+     * @brief Write out the buffered games
+     * @returns Whether all of them were written
+     */
+    bool flush();
+
+    /**
+     * @brief Get the amount of games appended since the log was opened
+     */
+    std::uint64_t getGameCount();
+
+private:
+    explicit GameLog(int fd);
+    bool writeBuffer();
+
+    int fd;
+    std::mutex mutex;
+    std::vector<unsigned char> buffer;
+    std::uint64_t game_count;
+};
+
+/**
+ * @brief Class responsible for reading the games of a log file, mapped read-only
+ */
+class GameLogReader {
+public:
+    /**
+     * @brief Map a log file
+     * @returns nullptr if the file is missing or is not a game log
+     */
+    static std::unique_ptr<GameLogReader> open(const std::string& path);
+
+    ~GameLogReader();
+
+    GameLogReader(const GameLogReader&) = delete;
+    GameLogReader& operator=(const GameLogReader&) = delete;
+
+    /**
+     * @brief Read the next game
+     * @returns false at the end of the log or at a malformed record
+     */
+    bool next(GameRecord& record);
+
+    /**
+     * @brief Get the byte offset of the next record
+     */
+    std::size_t getOffset() const;
+
+    /**
+     * @brief Whether every record up to the end of the file was read
+     */
+    bool isAtEnd() const;
+
+private:
+    GameLogReader(const unsigned char* data, std::size_t size);
+
+    const unsigned char* data;
+    std::size_t size;
+    std::size_t offset;
+};
+
+/**
+ * @brief Play a logged game again on a copy of start, a game at the starting
+ * board of the ruleset the game was logged with. The copy has caches of its
+ * own, so replays on several threads never contend. Turns go through playTurn
+ * without any parsing
+ * @param rejected Set to the index of the first move playTurn rejects, or
+ * to the move count if all of them are played but the game ends otherwise
+ * @param positions If given, filled with the state hash before every move played
+ * @returns Whether all moves are played & the game ends as logged
+ */
+bool replayGame(const GameRecord& record, const GameManager& start, std::size_t& rejected,
+                std::vector<std::uint64_t>* positions = nullptr);
@@ -2,14 +2,68 @@
 
 #include "ConfigReader.hpp"
 #include "ChessBoard.hpp"
+#include "Move.hpp"
+#include "MoveCache.hpp"
 #include "MoveValidator.hpp"
 #include "PortalSystem.hpp"
+#include "PositionSnapshot.hpp"
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class GameLog;
 
 /**
  * @brief Class responsible for handling game state & chess logic.
  */
 class GameManager {
 public:
+    /**
+     * @brief Reasons for playTurn to reject a turn
+     */
+    enum TurnError {
+        NO_ERROR,
+        GAME_OVER,
+        NO_PIECE,
+        INVALID_MOVE,
+        WRONG_PLAYER,
+        PORTAL_UNUSABLE,
+        KING_UNDER_CHECK,
+        INVALID_INPUT,
+        OPPONENT_PIECE
+    };
+
+    /**
+     * @brief Whether a copy shares the position caches of the copied game
+     */
+    enum CacheSharing {
+        SHARED_CACHES,
+        OWN_CACHES
+    };
+
+    /**
+     * @brief Default pieces the player to move needs for the search for a
+     * legal move to go parallel, below it the serial scan is faster
+     */
+    static constexpr std::size_t PARALLEL_MIN_PIECES = 128;
+
+    /**
+     * @brief Turns between two checkpoints of the history
+     */
+    static constexpr int CHECKPOINT_INTERVAL = 32;
+
+    /**
+     * @brief Turns the history holds without allocating, for games without
+     * a turn limit. Games with one reserve all their turns
+     */
+    static constexpr std::size_t HISTORY_RESERVE = 256;
+
     /**
      * @brief Initialize a chess game with the given config
      */
@@ -18,65 +72,275 @@ public:
                          const std::vector<PortalConfig>& portal_configs);
 
     /**
-     * @brief Play a chess game interactively on the console
+     * @brief Initialize a chess game sharing the given ruleset
+     */
+    explicit GameManager(std::shared_ptr<const Ruleset> ruleset);
+
+    /**
+     * @brief Copy a chess game, the copy owns its own board. Copies share
+     * the caches of positions already checked for legal moves, their history
+     * starts at the copied position
+     */
+    GameManager(const GameManager& other);
+
+    /**
+     * @brief Copy a chess game, with caches of its own if asked to. Copies
+     * playing on other threads then never wait on each other's cache lock
+     */
+    GameManager(const GameManager& other, CacheSharing caches);
+    GameManager& operator=(const GameManager& other) = delete;
+
+    /**
+     * @brief Look for a legal move on the workers of the pool once the player
+     * to move has at least min_pieces pieces. Copies share the pool
+     * @param pool Workers to search on, nullptr keeps the search serial
+     */
+    void setParallelism(std::shared_ptr<ThreadPool> pool, std::size_t min_pieces = PARALLEL_MIN_PIECES);
+
+    /**
+     * @brief Append the game to the log once a turn ends it. Copies are not
+     * logged, nor are games continued from a loaded position
+     * @param log Log to append to, nullptr stops logging
+     */
+    void setGameLog(std::shared_ptr<GameLog> log);
+
+    /**
+     * @brief Play a chess game interactively on the console. Legal moves &
+     * an engine hint are worked out in the background while the player types
      */
     void playInteractively();
 
     /**
-     * @brief Play a single turn
+     * @brief Play a single turn, turns taken back are dropped from the
+     * history. Once the game is set up, turns do not allocate, errors
+     * included. Games without a turn limit only do past HISTORY_RESERVE turns
      * @returns true if the movement is valid and the piece was moved
      */
     bool playTurn(Position piece_position, Position destination);
     bool playTurn(ChessPiece& piece, Position destination);
+    bool playTurn(Move move);
+
+    /**
+     * @brief Take back the last turn in constant time, redo plays it again
+     * @returns false if there is no turn to take back
+     */
+    bool undo();
+
+    /**
+     * @brief Play again the last turn taken back, in constant time
+     * @returns false if there is no turn to play again
+     */
+    bool redo();
+
+    /**
+     * @brief Go to the position after the given amount of turns, one the
+     * history holds. Restores the nearest checkpoint, then plays or takes
+     * back at most CHECKPOINT_INTERVAL turns
+     * @returns false if the history does not hold the position
+     */
+    bool seek(int move_count);
+
+    /**
+     * @brief Get the turns of the history, the ones taken back included
+     */
+    std::vector<Move> getHistory() const;
+
+    /**
+     * @brief Get the move count the history starts at, 0 unless this game is a copy
+     */
+    int getHistoryStart() const;
 
     /**
      * @brief Get a brief description as to why turn was rejected
      */
-    std::string getTurnError();
+    std::string getTurnError() const;
+
+    /**
+     * @brief Get the reason the last turn was rejected
+     */
+    TurnError getTurnErrorCode() const;
+
+    /**
+     * @brief Get a brief description of a turn error
+     */
+    static const char* describeTurnError(TurnError error);
 
     /**
      * @brief Returns the current player
      */
-    team_t getCurrentPlayer();
+    team_t getCurrentPlayer() const;
 
     /**
      * @brief Check if the king of the given team is under check
      */
     bool isKingUnderCheck(team_t team);
 
+    /**
+     * @brief Get the ruleset of this game
+     */
+    const std::shared_ptr<const Ruleset>& getRuleset() const;
+
     /**
      * @brief Returns whether the game is over
      */
-    bool isGameOver();
+    bool isGameOver() const;
 
     /**
      * @brief Get the amount of turns played
      */
-    int getMoveCount();
+    int getMoveCount() const;
 
     /**
      * @brief Get move limit if there is any
      */
-    int getMoveLimit();
+    int getMoveLimit() const;
 
     /**
      * @brief Returns the winner
      */
-    team_t getWinner();
+    team_t getWinner() const;
 
     /**
      * @brief Get the chess board instance
      */
-    const ChessBoard& getBoard();
+    const ChessBoard& getBoard() const;
+
+    /**
+     * @brief Get the position in the notation of PositionNotation.hpp
+     * @returns Empty if a piece type has no letter
+     */
+    std::string getPosition() const;
+
+    /**
+     * @brief Continue the game from a position in the notation of
+     * PositionNotation.hpp, which needs a king per team. The history starts
+     * over at the position & the game is no longer logged
+     * @returns false if the notation is malformed, the game is then left as it was
+     */
+    bool loadPosition(std::string_view notation);
+
+    /**
+     * @brief Take an immutable copy of the current position, safe to query
+     * from many threads while this game goes on
+     */
+    std::shared_ptr<const PositionSnapshot> getSnapshot() const;
+
+    /**
+     * @brief Get all moves of the current player which pass the move validator.
+     * Moves leaving the king under check are included.
+     */
+    std::vector<Move> getCandidateMoves();
+
+    /**
+     * @brief Check whether playTurn would accept the move, without playing it
+     */
+    bool isMoveLegal(Move move);
+
+    /**
+     * @brief Check many moves of the current position like isMoveLegal. The
+     * check state is found once, moves which can neither leave nor uncover a
+     * check are accepted without being played
+     * @returns Bit i is set if moves[i] is legal
+     */
+    std::vector<bool> areMovesLegal(std::span<const Move> moves);
+
+    /**
+     * @brief Get all moves of the current player which playTurn would accept.
+     * Recent positions are answered from the move cache
+     */
+    std::vector<Move> getLegalMoves();
+
+    /**
+     * @brief Get a hash of the position & the player to move
+     */
+    std::uint64_t getStateHash() const;
+
+    /**
+     * @brief Get the hit & miss counters of the legal move cache
+     */
+    MoveCacheStats getMoveCacheStats() const;
+
+    /**
+     * @brief Get the bytes used by this game, including its heap allocations
+     */
+    std::size_t getMemoryUsage() const;
 
 private:
     ChessBoard board;
     MoveValidator validator;
     PortalSystem portal_system;
 
+    /**
+     * @brief Positions already checked for a legal move, keyed by position hash
+     * with the answer in the lowest bit. Shared by copies, hence atomic
+     */
+    using LegalMoveCache = std::vector<std::atomic<std::uint64_t>>;
+    static constexpr std::size_t LEGAL_MOVE_CACHE_SIZE = 4096;
+    std::shared_ptr<LegalMoveCache> legal_move_cache;
+
+    /**
+     * @brief Legal move lists of recent positions, shared by copies
+     */
+    static constexpr std::size_t MOVE_CACHE_SIZE = 256;
+    std::shared_ptr<MoveCache> move_cache;
+
+    /**
+     * @brief Last legal move found for each team, tried first on its next turn
+     */
+    Move witnesses[2];
+
+    /**
+     * @brief Moves of a single piece, reserved for the piece with the most
+     * moves so that looking for a legal move does not allocate
+     */
+    std::vector<Move> scratch_moves;
+
+    /**
+     * @brief Workers looking for a legal move when the player has many pieces
+     */
+    std::shared_ptr<ThreadPool> pool;
+    std::size_t parallel_min_pieces;
+
+    /**
+     * @brief Log finished games are appended to, never shared by copies
+     */
+    std::shared_ptr<GameLog> game_log;
+
+    /**
+     * @brief What a turn changed, enough to take it back or play it again
+     */
+    struct TurnRecord {
+        Move move;
+        PieceHandle piece;
+        bool was_used;          // The piece had moved before
+        bool captured;          // A piece was taken where the piece landed
+        bool portal;            // The move entered a portal & started its cooldown
+        bool game_over;         // Outcome after the turn
+        team_t winner;
+        int portal_ready_at;    // End of the cooldown of the portal before the turn
+    };
+
+    /**
+     * @brief Turns played & taken back, the current one at move_count - history_start.
+     * Checkpoint i holds the board after (i + 1) * CHECKPOINT_INTERVAL turns, the
+     * first checkpoint_count slots are in use. Slots outlive the turns taken back,
+     * so storing a checkpoint only copies into a board of the same shape
+     */
+    std::vector<TurnRecord> history;
+    std::vector<ChessBoard> checkpoints;
+    std::size_t checkpoint_count;
+    int history_start;
+    team_t history_player;
+
+    void reserveHistory();
     void checkGameOver();
-    bool withTurnError(std::string err);
-    std::string turn_error;
+    bool hasLegalMove();
+    bool findLegalMove();
+    bool findLegalMoveInParallel(const ChessPiece* king);
+    bool findSafeMove(ChessPiece& piece);
+    bool isLandingSafe(ChessPiece& piece, Position destination);
+    bool withTurnError(TurnError err);
+    TurnError turn_error;
     const ChessPiece* checking_piece;
     
     team_t winner;
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "GameManager.hpp"
+#include "LatencyHistogram.hpp"
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Class hosting many chess games behind a line protocol on local sockets
+ *
+ * Every request is a single line and gets a single response line:
+ *   NEW [config]           -> OK <id>
+ *   MOVE <id> <e2e4>       -> OK | OK GAMEOVER <white|black|tie> | ERR <reason>
+ *   MOVES <id>             -> OK <move> <move> ...
+ *   STATE <id>             -> OK <white|black> <move_count> <running|white|black|tie>
+ *   CLOSE <id>             -> OK
+ *   STATS                  -> OK sessions=N configs=N session_bytes=N turns=N p50_us=N p99_us=N
+ *   PING                   -> OK PONG
+ *
+ * Sockets are served by an epoll event loop, requests are handled on a
+ * worker pool. Requests of one connection are answered in order. A client
+ * shutting its writing side still gets all its answers before the close.
+ *
+ * Clients only pick among the configs the server was set up with, by the
+ * path given to addConfig or by its file name. Nothing is read from disk
+ * once serving.
+ */
+class GameServer {
+public:
+    /**
+     * @brief Initialize a server without any config
+     */
+    explicit GameServer(int worker_count);
+
+    /**
+     * @brief Close all sockets
+     */
+    ~GameServer();
+
+    /**
+     * @brief Listen on a Unix socket
+     * @returns true if successful
+     */
+    bool listenUnix(const std::string& path);
+
+    /**
+     * @brief Listen on a TCP port of the loopback interface
+     * @returns true if successful
+     */
+    bool listenTcp(int port);
+
+    /**
+     * @brief Offer a config to NEW, the first one added is used by NEW
+     * without a config. Call before serving
+     * @returns false if the config can not be loaded
+     */
+    bool addConfig(const std::string& config_path);
+
+    /**
+     * @brief Log every game, finished ones as their last turn is played &
+     * unfinished ones as they are closed. Call before serving
+     */
+    void setGameLog(std::shared_ptr<GameLog> log);
+
+    /**
+     * @brief Serve connections until stop is called
+     */
+    void run();
+
+    /**
+     * @brief Make run return, safe from any thread
+     */
+    void stop();
+
+    /**
+     * @brief Handle a single request line, safe from any thread
+     * @returns The response line without line break
+     */
+    std::string handleLine(const std::string& line);
+
+    /**
+     * @brief Get the amount of hosted games
+     */
+    std::size_t getSessionCount();
+
+private:
+    /**
+     * @brief A hosted game
+     */
+    struct Session {
+        std::mutex mutex;
+        GameManager game;
+
+        explicit Session(std::shared_ptr<const Ruleset> ruleset);
+    };
+
+    /**
+     * @brief A client connection
+     */
+    struct Connection {
+        int fd;
+        std::mutex mutex;
+        std::string input;
+        std::string output;
+        std::deque<std::string> pending;
+        bool busy{false};
+        bool closed{false};
+        bool read_closed{false};    // Client shut its side, close once answered
+    };
+
+    std::shared_ptr<const Ruleset> getRuleset(const std::string& config) const;
+    std::shared_ptr<Session> findSession(const std::string& id);
+    std::string handleStats();
+
+    bool addListener(int fd);
+    void acceptConnections(int listen_fd);
+    void readConnection(const std::shared_ptr<Connection>& connection, bool hangup);
+    void processConnection(const std::shared_ptr<Connection>& connection);
+    void flushConnection(Connection& connection);
+    void watchConnection(Connection& connection);
+    static bool isAnswered(const Connection& connection);
+    void closeConnection(int fd);
+
+    std::shared_ptr<const Ruleset> default_ruleset;
+    std::shared_ptr<GameLog> game_log;
+
+    int epoll_fd;
+    int wake_fd;
+    std::vector<int> listen_fds;
+    std::string unix_path;
+    std::map<int, std::shared_ptr<Connection>> connections;
+    std::atomic<bool> running;
+
+    std::vector<std::shared_ptr<const Ruleset>> rulesets;
+    std::map<std::string, std::shared_ptr<const Ruleset>> configs;
+
+    std::shared_mutex sessions_mutex;
+    std::unordered_map<std::uint64_t, std::shared_ptr<Session>> sessions;
+    std::uint64_t next_session_id;
+
+    LatencyHistogram turn_latency;
+
+    /**
+     * @brief Declared last, so workers are joined before anything else is destroyed
+     */
+    ThreadPool pool;
+};
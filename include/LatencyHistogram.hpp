@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Class recording latencies into log-linear buckets
+ *
+ * Every power of two is split into 8 buckets, so percentiles are exact
+ * within 12.5%. Recording is lock-free and safe from any thread.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    /**
+     * @brief Record a single latency in nanoseconds
+     */
+    void record(std::uint64_t nanoseconds);
+
+    /**
+     * @brief Get the given percentile (0-100) in nanoseconds, 0 if empty
+     */
+    std::uint64_t getPercentile(double percentile) const;
+
+    /**
+     * @brief Get the amount of recorded latencies
+     */
+    std::uint64_t getCount() const;
+
+    /**
+     * @brief Forget all recorded latencies
+     */
+    void reset();
+
+private:
+    static constexpr int LINEAR_BUCKETS = 16;
+    static constexpr int SUB_BUCKETS = 8;
+    static constexpr int BUCKET_COUNT = LINEAR_BUCKETS + (64 - 4) * SUB_BUCKETS;
+
+    static int bucketOf(std::uint64_t value);
+    static std::uint64_t bucketMidpoint(int bucket);
+
+    std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets;
+    std::atomic<std::uint64_t> count;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "ConfigReader.hpp"
+
+#include <string_view>
+
+/**
+ * @brief Struct representing a move of a piece to a destination
+ */
+struct Move {
+    /**
+     * @brief Position of the moved piece
+     */
+    Position from;
+
+    /**
+     * @brief Destination of the move
+     */
+    Position to;
+
+    /**
+     * @brief Square the piece ends up on, the portal exit when to is a portal
+     */
+    Position landing;
+
+    /**
+     * @brief Equality implementation
+     */
+    inline bool operator==(const Move& other) const {
+        return from == other.from && to == other.to;
+    }
+
+    /**
+     * @brief Print implementation, e.g. e2e4
+     */
+    friend inline std::ostream& operator<<(std::ostream& os, const Move& move) {
+        os << move.from << move.to;
+        return os;
+    }
+
+    /**
+     * @brief Initializer
+     */
+    inline Move(Position from, Position to) : from(from), to(to), landing(to) { }
+    inline Move(Position from, Position to, Position landing) : from(from), to(to), landing(landing) { }
+
+    /**
+     * @brief Default initializer
+     */
+    inline Move() : from(), to(), landing() { }
+};
+
+/**
+ * @brief Parse a square in the notation printed by Position, e.g. a1 or ab12
+ * @returns Amount of characters consumed, 0 if text is not a square
+ */
+inline std::size_t parseSquare(std::string_view text, Position& square) {
+    // Files count a to z, then aa to zz & so on, like spreadsheet columns
+    std::size_t i = 0;
+    int file = 0;
+    while (i < text.size() && text[i] >= 'a' && text[i] <= 'z' && file < 10000)
+        file = file * 26 + (text[i++] - 'a' + 1);
+
+    std::size_t letters = i;
+    int rank = 0;
+    while (i < text.size() && text[i] >= '0' && text[i] <= '9' && rank < 10000)
+        rank = rank * 10 + (text[i++] - '0');
+
+    if (letters == 0 || i == letters || rank == 0 || file > std::numeric_limits<short>::max())
+        return 0;
+
+    square = Position(file - 1, rank - 1);
+    return i;
+}
+
+/**
+ * @brief Parse a move in the notation printed by Move, e.g. e2e4
+ * @returns Whether the text is a move
+ */
+inline bool parseMove(std::string_view text, Move& move) {
+    std::size_t from_length = parseSquare(text, move.from);
+    if (from_length == 0)
+        return false;
+
+    std::size_t to_length = parseSquare(text.substr(from_length), move.to);
+    move.landing = move.to;
+    return to_length != 0 && from_length + to_length == text.size();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Move.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Hit & miss counters of a MoveCache
+ */
+struct MoveCacheStats {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::size_t size;
+    std::size_t capacity;
+};
+
+/**
+ * @brief Class holding the legal moves of recently seen positions
+ *
+ * Positions are keyed by a hash of the whole game state. Once full, the
+ * least recently used entries are evicted in clock order: a hand sweeps
+ * the slots and evicts the first one which was not used since its last
+ * pass. Safe to share between threads.
+ */
+class MoveCache {
+public:
+    /**
+     * @brief Initialize an empty cache holding up to capacity positions
+     */
+    explicit MoveCache(std::size_t capacity);
+
+    MoveCache(const MoveCache&) = delete;
+    MoveCache& operator=(const MoveCache&) = delete;
+
+    /**
+     * @brief Copy the cached legal moves of a position into moves
+     * @returns false if the position is not cached
+     */
+    bool get(std::uint64_t key, std::vector<Move>& moves);
+
+    /**
+     * @brief Get the amount of legal moves of a position
+     * @returns false if the position is not cached
+     */
+    bool getMoveCount(std::uint64_t key, std::size_t& count);
+
+    /**
+     * @brief Store the legal moves of a position
+     */
+    void put(std::uint64_t key, const std::vector<Move>& moves);
+
+    /**
+     * @brief Get the hit & miss counters
+     */
+    MoveCacheStats getStats() const;
+
+    /**
+     * @brief Get the bytes allocated on the heap by this cache
+     */
+    std::size_t getHeapUsage() const;
+
+private:
+    struct Slot {
+        std::uint64_t key;
+        bool referenced;
+        std::vector<Move> moves;
+    };
+
+    /**
+     * @brief Find the slot of a position & mark it used, counting hit or miss
+     */
+    Slot* touch(std::uint64_t key);
+
+    /**
+     * @brief Slots, grown up to capacity before anything is evicted
+     */
+    std::vector<Slot> slots;
+    std::unordered_map<std::uint64_t, std::size_t> index;
+    std::size_t capacity;
+    std::size_t hand;
+    mutable std::mutex mutex;
+
+    std::uint64_t hits;
+    std::uint64_t misses;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Ruleset.hpp"
+
+#include <cstdlib>
+#include <span>
+
+/**
+ * @brief Whether a displacement matches the movement rules of a piece type
+ */
+enum MoveShape {
+    ILLEGAL_SHAPE,  // No rule allows it
+    PATH_SHAPE,     // Allowed if no piece stands in between
+    LEAP_SHAPE      // Allowed, pieces in between do not matter
+};
+
+/**
+ * @brief Movement rules read from a ruleset as moves are checked. Variants
+ * compiled in by chess_variantgen provide the same interface
+ */
+class InterpretedRules {
+public:
+    explicit inline InterpretedRules(const Ruleset& ruleset) : ruleset(ruleset) { }
+
+    /**
+     * @brief Get the directions a piece type may move in
+     */
+    inline std::span<const MovePattern> getPatterns(int type_id) const {
+        return ruleset.getPieceType(type_id).patterns;
+    }
+
+    /**
+     * @brief Check a displacement against the rules of a piece type
+     * @param dy Displacement along y, seen from the team of the piece
+     * @param capture Whether the destination holds an opponent
+     * @param used Whether the piece was used before
+     */
+    inline MoveShape checkShape(int type_id, int dx, int dy, bool capture, bool used) const {
+        const PieceType& type = ruleset.getPieceType(type_id);
+        const MovementRules& rule = type.movement;
+
+        if (dx == 0 && dy == 0) {
+            // No movement
+            return ILLEGAL_SHAPE;
+        }
+        else if (std::abs(dx) == std::abs(dy)) {
+            // Diagonal
+            bool valid = false;
+            if (rule.diagonal == -1 || rule.diagonal == std::abs(dx))
+                valid = true;
+            if (capture && dy > 0 // Diagonal cap. requires forward
+                && (rule.diagonal_capture == -1 || rule.diagonal_capture == std::abs(dx)))
+                valid = true;
+            return valid ? PATH_SHAPE : ILLEGAL_SHAPE;
+        }
+        else if (dy == 0) {
+            // Horizontal
+            if (rule.sideways != -1 && rule.sideways != std::abs(dx))
+                return ILLEGAL_SHAPE;
+            return PATH_SHAPE;
+        }
+        else if (dx == 0 && dy > 0) {
+            // Forward
+            if (!type.forward_captures && capture)
+                return ILLEGAL_SHAPE;
+
+            bool valid = false;
+            if (rule.forward == -1 || rule.forward == dy)
+                valid = true;
+            if (!used && (rule.first_move_forward == -1 || rule.first_move_forward == dy))
+                valid = true;
+            return valid ? PATH_SHAPE : ILLEGAL_SHAPE;
+        }
+        else if (dx == 0 && dy < 0) {
+            // Backward
+            if (rule.backward != -1 && rule.backward != -dy)
+                return ILLEGAL_SHAPE;
+            return PATH_SHAPE;
+        }
+        else if ((std::abs(dx) == 1 && std::abs(dy) == 2) || (std::abs(dx) == 2 && std::abs(dy) == 1)) {
+            // L-shape
+            return rule.l_shape ? LEAP_SHAPE : ILLEGAL_SHAPE;
+        }
+
+        // Invalid
+        return ILLEGAL_SHAPE;
+    }
+
+private:
+    const Ruleset& ruleset;
+};
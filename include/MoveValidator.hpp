@@ -1,38 +1,165 @@
 #pragma once
 
+#include "AttackKernels.hpp"
+#include "BoardGeometry.hpp"
 #include "ConfigReader.hpp"
+#include "Move.hpp"
+#include "MoveRules.hpp"
 
 #include <set>
+#include <span>
+#include <vector>
+
+/**
+ * @brief A move to validate as part of a batch
+ */
+struct MoveQuery {
+    const ChessPiece* piece;    // Piece to move, nullptr is never valid
+    Position destination;
+};
 
 /**
  * @brief Class responsible for validating moves & getting valid moves
+ *
+ * The rules are compiled once per board size in SPECIALIZED_SIZES, with
+ * bounds & edge distances known at compile time. Other sizes run the same
+ * rules on a generic geometry. Built with CHESS_VARIANT (see make variant),
+ * boards of the variant generated by chess_variantgen use its compiled
+ * movement rules instead of interpreting the ruleset.
+ *
+ * Boards up to 16 squares a side also get attack maps of whole teams,
+ * computed over 256-bit boards by the AttackKernels of the CPU.
+ *
+ * Queries are const & only read the board, so any number of threads may
+ * share a validator as long as nothing changes the board meanwhile.
  */
 class MoveValidator {
 public:
     /**
-     * @brief Initialize a move validator with the given config
+     * @brief Board sizes with a compile time specialization
+     */
+    static constexpr int SPECIALIZED_SIZES[] = { 8, 10, 16 };
+
+    /**
+     * @brief Smallest board size where check detection uses attack maps,
+     * standard boards keep checking the pieces one by one
+     */
+    static constexpr int ATTACK_MAP_MIN_SIZE = 9;
+
+    /**
+     * @brief Most piece types a ruleset may have for attack maps
      */
-    explicit MoveValidator(const ChessBoard& board, 
-                           const std::vector<PieceConfig>& piece_configs);
+    static constexpr int ATTACK_MAP_TYPE_LIMIT = 64;
+
+    /**
+     * @brief Consecutive queries of one piece from which validateMoves lists
+     * the targets of the piece once instead of checking each query
+     */
+    static constexpr std::size_t TARGET_LIST_MIN_QUERIES = 8;
+
+    /**
+     * @brief Initialize a move validator with the ruleset of the given board,
+     * picking the specialization of its size unless told not to
+     */
+    explicit MoveValidator(const ChessBoard& board, bool specialize = true);
+
+    /**
+     * @brief Whether a compile time specialization is in use
+     */
+    bool isSpecialized() const;
+
+    /**
+     * @brief Whether the movement rules of a compiled in variant are in use
+     */
+    bool isCompiled() const;
+
+    /**
+     * @brief Whether check detection should use attack maps on this board
+     */
+    bool hasAttackMaps() const;
 
     /**
      * @brief Validate a move
      * @returns Whether the move is valid
      */
-    bool validateMove(const ChessPiece& piece, Position destionation);
+    bool validateMove(const ChessPiece& piece, Position destionation) const;
+
+    /**
+     * @brief Validate many moves of the same position in one pass, the
+     * geometry & rules are picked once for all of them
+     * @returns Bit i is set if queries[i] is valid
+     */
+    std::vector<bool> validateMoves(std::span<const MoveQuery> queries) const;
 
     /**
      * @brief Validate portal usage
      * @returns Whether portal use is valid
      */
-    bool validatePortalUse(const ChessPiece& piece, Portal& portal);
+    bool validatePortalUse(const ChessPiece& piece, const Portal& portal) const;
 
     /**
      * @brief Get all the possible moves of a piece
      */
-    std::set<Position> getPossibleMoves(const ChessPiece& piece);
+    std::set<Position> getPossibleMoves(const ChessPiece& piece) const;
+
+    /**
+     * @brief Append all the possible moves of a piece, with portals resolved.
+     * Moves onto a portal land on its exit, moves onto portals the piece
+     * cannot use right now are left out.
+     */
+    void getMoves(const ChessPiece& piece, std::vector<Move>& moves) const;
+
+    /**
+     * @brief Get the square a piece moving onto target ends up on
+     * @returns Whether target can be entered, false for unusable portals &
+     * for portals whose exit holds a king
+     */
+    bool resolveLanding(const ChessPiece& piece, Position target, Position& landing) const;
+
+    /**
+     * @brief Get the squares the pieces of a team could capture on, whether
+     * or not an opponent stands there. Like validateMove, portals are left out.
+     * @returns false if the board is wider than a Bitboard256 or the ruleset
+     * has more than ATTACK_MAP_TYPE_LIMIT piece types
+     */
+    bool getTeamAttacks(team_t team, Bitboard256& attacks) const;
+
+    /**
+     * @brief Find a piece which could capture the king of the given team
+     * @returns nullptr if the king is not under check
+     */
+    const ChessPiece* findCheckingPiece(team_t team) const;
 
 private:
+    /**
+     * @brief Call function with the geometry of the board & the movement rules
+     */
+    template <typename Function>
+    auto withRules(Function&& function) const;
+
+    template <typename Geometry, typename Rules>
+    bool checkMove(const Geometry& geometry, const Rules& rules, const ChessPiece& piece,
+                   Position destination) const;
+
+    template <typename Geometry, typename Rules, typename Visit>
+    void forEachTarget(const Geometry& geometry, const Rules& rules, const ChessPiece& piece,
+                       Visit&& visit) const;
+
     const ChessBoard& board;
-    std::map<std::string, MovementRules> rules;
+    const Ruleset& ruleset;
+
+    /**
+     * @brief Board size of the specialization in use, 0 for the generic geometry
+     */
+    int specialization;
+
+    /**
+     * @brief Whether the ruleset is the compiled in variant
+     */
+    bool compiled;
+
+    /**
+     * @brief Squares of the board, for boards up to Bitboard256::WIDTH
+     */
+    Bitboard256 board_mask;
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Engine.hpp"
+#include "GameManager.hpp"
+#include "Move.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Class analysing a position on a background thread while a player
+ * thinks. The legal moves & check status come first, then an engine hint
+ * deepened until the analysis is stopped or retargeted.
+ *
+ * The analysis runs on a copy of the game, which shares the move cache of
+ * the original, so positions listed here are answered from it there too.
+ */
+class Ponderer {
+public:
+    /**
+     * @brief Initialize a ponderer for games of the given ruleset
+     */
+    explicit Ponderer(const Ruleset& ruleset);
+
+    /**
+     * @brief Stop the analysis & join the worker
+     */
+    ~Ponderer();
+
+    Ponderer(const Ponderer&) = delete;
+    Ponderer& operator=(const Ponderer&) = delete;
+
+    /**
+     * @brief Stop any running analysis & start analysing the current position
+     * of the game. The game is copied, so it may be played on right away
+     */
+    void start(const GameManager& game);
+
+    /**
+     * @brief Stop the analysis, results found so far are kept
+     */
+    void stop();
+
+    /**
+     * @brief Get the legal moves of the analysed position, waits until they
+     * are listed, rethrowing what listing them or the search threw. Only
+     * valid after start
+     */
+    std::vector<Move> getLegalMoves();
+
+    /**
+     * @brief Check if the player to move is under check, waits like getLegalMoves
+     */
+    bool isKingUnderCheck();
+
+    /**
+     * @brief Get the best move of the deepest search iteration completed so
+     * far, rethrowing what the search threw
+     * @returns false if no iteration completed yet
+     */
+    bool getHint(Move& hint, int& depth) const;
+
+private:
+    void analyse(std::shared_ptr<GameManager> game);
+
+    Engine engine;
+    std::thread worker;
+    std::atomic<bool> stop_flag;
+
+    mutable std::mutex mutex;
+    std::condition_variable listed;
+    bool moves_ready;
+    std::vector<Move> legal_moves;
+    bool check;
+    std::exception_ptr error;
+    bool has_hint;
+    Move hint;
+    int hint_depth;
+};
@@ -42,9 +42,16 @@ struct Portal {
     int cooldown;
 
     /**
-     * @brief
+     * @brief Portal clock value at which the portal is usable again
      */
-    int current_cooldown;
+    int ready_at;
+
+    /**
+     * @brief Get the remaining cooldown in turns at the given portal clock
+     */
+    inline int getCooldown(int clock) const {
+        return ready_at > clock ? ready_at - clock : 0;
+    }
 
     /**
      * @brief Initialize a portal with the given config
@@ -52,5 +59,20 @@ struct Portal {
     inline Portal(std::string id, Position entry, Position exit, bool both_ways,
                   bool white_allowed, bool black_allowed, int cooldown)
         : id(id), entry(entry), exit(exit), both_ways(both_ways), white_allowed(white_allowed)
-        , black_allowed(black_allowed), cooldown(cooldown), current_cooldown(0) { }
-};
\ No newline at end of file
+        , black_allowed(black_allowed), cooldown(cooldown), ready_at(0) { }
+};
+
+/**
+ * @brief Struct representing where a piece entering a square is sent to
+ */
+struct PortalTransition {
+    /**
+     * @brief Index of the portal on the board, -1 for plain squares
+     */
+    int portal;
+
+    /**
+     * @brief Square the piece lands on
+     */
+    Position landing;
+};
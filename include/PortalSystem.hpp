@@ -5,8 +5,6 @@
 #include "ChessPiece.hpp"
 #include "Portal.hpp"
 
-#include <list>
-
 /**
  * @brief Class responsible for handling portals
  */
@@ -18,17 +16,28 @@ public:
     explicit PortalSystem(ChessBoard& board, 
                           const std::vector<PortalConfig>& portal_configs);
 
+    /**
+     * @brief Initialize portal system for a board which already has its portals
+     */
+    explicit PortalSystem(ChessBoard& board);
+
     /**
      * @brief Record a portal use
      */
     void startCooldown(Position position);
 
     /**
-     * @brief Decrease cooldowns by one. 
+     * @brief Let one turn pass, cooldowns expire without touching the portals.
      * Must be called by GameManager each turn
      */
-    void decreaseCooldowns();
+    void advanceClock();
 
+    /**
+     * @brief Take back a turn, the portal used during it, if any, gets back
+     * the cooldown it had before
+     */
+    void rewindClock();
+    void rewindCooldown(Position position, int ready_at);
 
 private:
     ChessBoard& board;
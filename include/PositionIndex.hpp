@@ -0,0 +1,164 @@
+#pragma once
+
+#include "GameLog.hpp"
+#include "Move.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief How often a move was played in a position, by outcome of the game
+ */
+struct MoveStats {
+    Move move;
+    std::uint32_t games[4];     // Indexed by GameResult
+
+    /**
+     * @brief Get the amount of games the move was played in
+     */
+    inline std::uint32_t getGameCount() const {
+        return games[WHITE_WON] + games[BLACK_WON] + games[DRAWN] + games[UNFINISHED];
+    }
+};
+
+/**
+ * @brief Class responsible for building a position index out of logged games
+ *
+ * Every game is played again through the rules, each of its turns emits
+ * the state hash before the move, the move & the result of the game.
+ * Emitted turns are sorted & merged into counts in memory, runs outgrowing
+ * the memory budget are spilled to disk next to the index & merged at the
+ * end. Adding games is safe from any thread, a run is spilled outside the
+ * lock while the other threads fill the next one.
+ */
+class PositionIndexBuilder {
+public:
+    /**
+     * @brief Default turns held in memory before a run is spilled, 16 bytes
+     * each. Every thread busy spilling holds one more such run
+     */
+    static constexpr std::size_t RUN_TURNS = std::size_t(1) << 22;
+
+    /**
+     * @brief Build the index of games of a ruleset into the given file
+     * @param start A game at the starting board of the ruleset
+     */
+    explicit PositionIndexBuilder(const std::string& path, const GameManager& start,
+                                  std::size_t run_turns = RUN_TURNS);
+
+    /**
+     * @brief Remove the runs spilled to disk
+     */
+    ~PositionIndexBuilder();
+
+    PositionIndexBuilder(const PositionIndexBuilder&) = delete;
+    PositionIndexBuilder& operator=(const PositionIndexBuilder&) = delete;
+
+    /**
+     * @brief Play a logged game again & add its turns
+     * @returns false if the game is of another ruleset, replayGame rejects
+     * it or its board is beyond 256 squares a side
+     */
+    bool addGame(const GameRecord& record);
+
+    /**
+     * @brief Merge all turns into the index, atomically replacing an older one
+     * @returns Whether the index was written
+     */
+    bool finish();
+
+private:
+    /**
+     * @brief A turn emitted by a game, sorted by position then move
+     */
+    struct Turn {
+        std::uint64_t position;
+        std::uint32_t move;
+        std::uint32_t result;
+    };
+
+    /**
+     * @brief Name the file of the next run, under the lock
+     */
+    std::string claimRunPath();
+
+    /**
+     * @brief Sort, merge & write a run, without the lock
+     */
+    static bool spillRun(std::vector<Turn>& run, const std::string& run_path);
+
+    std::string path;
+    const GameManager& start;
+    std::size_t run_turns;
+
+    std::mutex mutex;
+    std::vector<Turn> turns;
+    std::vector<std::string> run_paths;
+    std::uint64_t game_count;
+    bool failed;
+};
+
+/**
+ * @brief Class responsible for answering which moves were played in a
+ * position, out of an index mapped read-only
+ *
+ * An index file holds a fixed header, the counts of every position & move
+ * sorted by position hash in blocks of BLOCK_SIZE, then a fence per block:
+ * the first position hash in it. A lookup searches the fences, which stay
+ * in cache, then a single block, so it touches one or two pages of the
+ * file however large the database grows.
+ */
+class PositionIndex {
+public:
+    /**
+     * @brief Format version, bumped whenever the layout changes
+     */
+    static constexpr std::uint32_t VERSION = 1;
+
+    /**
+     * @brief Entries per block, 4 KiB
+     */
+    static constexpr std::size_t BLOCK_SIZE = 128;
+
+    /**
+     * @brief Map & validate an index file
+     * @returns nullptr if the file is missing or is not a position index
+     */
+    static std::unique_ptr<PositionIndex> open(const std::string& path);
+
+    ~PositionIndex();
+
+    PositionIndex(const PositionIndex&) = delete;
+    PositionIndex& operator=(const PositionIndex&) = delete;
+
+    /**
+     * @brief Get the moves played in a position, by the state hash of GameManager
+     * @param stats Cleared, then filled with one entry per move
+     * @returns Amount of turns played from the position over all games
+     */
+    std::uint64_t find(std::uint64_t position, std::vector<MoveStats>& stats) const;
+
+    /**
+     * @brief Get the rules hash of the indexed games
+     */
+    std::uint64_t getRulesHash() const;
+
+    /**
+     * @brief Get the amount of indexed games
+     */
+    std::uint64_t getGameCount() const;
+
+    /**
+     * @brief Get the amount of distinct position & move pairs
+     */
+    std::uint64_t getEntryCount() const;
+
+private:
+    PositionIndex(const unsigned char* data, std::size_t size);
+
+    const unsigned char* data;
+    std::size_t size;
+};
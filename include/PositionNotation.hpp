@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ChessBoard.hpp"
+
+#include <cstddef>
+#include <string_view>
+
+/**
+ * @brief Position notation generalized from FEN, a single line such as
+ * "rnbqkbnr/pppppppp/8/8/4P*3/8/PPPP1PPP/RNBQKBNR b 1 -"
+ *
+ * - Ranks from the last one down to the first, separated by '/'. A rank
+ *   lists its pieces from the first file on, runs of empty squares as
+ *   decimal numbers, so boards of any size fit
+ * - A piece is the letter of its type, uppercase for white & lowercase for
+ *   black, followed by '*' once it was used
+ * - The player to move, w or b
+ * - The amount of turns played
+ * - The portals on cooldown as index:turns separated by ',', their index
+ *   being their place on the board, or - when there are none
+ *
+ * Letters are given by the ruleset, see PieceType::symbol. Writing never
+ * allocates, reading only when the board has to grow.
+ */
+
+/**
+ * @brief Get the longest notation a position of the board can take
+ */
+std::size_t getMaxNotationLength(const ChessBoard& board);
+
+/**
+ * @brief Write the position of a board
+ * @returns Amount of characters written, 0 if they do not fit into the
+ * buffer or a piece type has no letter
+ */
+std::size_t writePosition(const ChessBoard& board, team_t player, int move_count,
+                          char* buffer, std::size_t capacity);
+
+/**
+ * @brief Replace the pieces & portal cooldowns of a board, one of the
+ * ruleset the notation was written with. Texts of up to 1024 pieces are
+ * read in a single pass. The pool is reused, so boards built from a
+ * ruleset placing as many pieces do not allocate
+ * @returns false if the text is malformed, the board is then left as it was
+ */
+bool readPosition(std::string_view text, ChessBoard& board, team_t& player, int& move_count);
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "ChessBoard.hpp"
+#include "MoveValidator.hpp"
+
+#include <set>
+
+/**
+ * @brief Immutable copy of a game position to analyse
+ *
+ * Every query is const & free of side effects, so any number of threads may
+ * query one snapshot at the same time without locking. The snapshot owns its
+ * board: the game it was taken from may keep playing meanwhile. Obtained from
+ * GameManager::getSnapshot, usually shared through
+ * std::shared_ptr<const PositionSnapshot>.
+ */
+class PositionSnapshot {
+public:
+    /**
+     * @brief Copy a position along with the state of its game
+     */
+    PositionSnapshot(const ChessBoard& board, team_t current_player, int move_count,
+                     bool game_over, team_t winner);
+
+    // The validator refers to the board of this very snapshot
+    PositionSnapshot(const PositionSnapshot&) = delete;
+    PositionSnapshot& operator=(const PositionSnapshot&) = delete;
+
+    /**
+     * @brief Get the board of the position
+     */
+    const ChessBoard& getBoard() const;
+
+    /**
+     * @brief Get the player to move
+     */
+    team_t getCurrentPlayer() const;
+
+    /**
+     * @brief Get the amount of turns played before the position
+     */
+    int getMoveCount() const;
+
+    /**
+     * @brief Whether the game was over in the position
+     */
+    bool isGameOver() const;
+
+    /**
+     * @brief Get the winner, TIE unless the game is over
+     */
+    team_t getWinner() const;
+
+    /**
+     * @brief Validate a move of the piece on a square, like MoveValidator::validateMove
+     * @returns false if there is no piece on from
+     */
+    bool validateMove(Position from, Position to) const;
+
+    /**
+     * @brief Get all the possible moves of the piece on a square
+     * @returns No moves if there is no piece on from
+     */
+    std::set<Position> getPossibleMoves(Position from) const;
+
+    /**
+     * @brief Check if the king of the given team is under check
+     */
+    bool isKingUnderCheck(team_t team) const;
+
+    /**
+     * @brief Get a piece which could capture the king of the given team
+     * @returns nullptr if the king is not under check
+     */
+    const ChessPiece* getCheckingPiece(team_t team) const;
+
+private:
+    const ChessBoard board;
+    const MoveValidator validator;
+    team_t current_player;
+    int move_count;
+    bool game_over;
+    team_t winner;
+};
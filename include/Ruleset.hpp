@@ -0,0 +1,155 @@
+#pragma once
+
+#include "ConfigReader.hpp"
+#include "Portal.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Struct representing a compiled movement direction of a piece type
+ */
+struct MovePattern {
+    short dx;           // Step along x
+    short dy;           // Step along y, seen from the white team
+    short distance;     // Exact amount of steps, 0 for any amount
+    bool leap;          // Pieces on the path are ignored
+    bool first_move;    // Only for pieces which were not used yet
+};
+
+/**
+ * @brief Struct representing an interned piece type
+ */
+struct PieceType {
+    std::string name;                   // Name of the type
+    bool king_type;                     // Whether type is of king
+    bool forward_captures;              // Whether forward moves may capture
+    MovementRules movement;             // Movement rules from the config
+    std::vector<MovePattern> patterns;  // Directions the type may move in, see prunePatterns
+    bool first_move_overlaps;           // Whether first move patterns reach squares of others
+    char symbol;                        // Lowercase letter in position notation, 0 past 26 types
+};
+
+/**
+ * @brief Struct representing a piece on the starting board
+ */
+struct PiecePlacement {
+    int type_id;
+    team_t team;
+    Position position;
+};
+
+/**
+ * @brief Class representing the compiled, immutable rules of a variant
+ *
+ * A ruleset is built once per config and shared read-only by any number
+ * of games through std::shared_ptr<const Ruleset>.
+ */
+class Ruleset {
+public:
+    /**
+     * @brief Compile a ruleset from parsed configs
+     */
+    explicit Ruleset(const GameSettings& game_setting,
+                     const std::vector<PieceConfig>& piece_configs,
+                     const std::vector<PortalConfig>& portal_configs);
+
+    /**
+     * @brief Read a config file and compile its ruleset.
+     * A valid binary cache next to the config is used instead of the JSON,
+     * and written after compiling when missing or stale.
+     * @returns nullptr on failure
+     */
+    static std::shared_ptr<const Ruleset> load(const std::string& config_path);
+
+    /**
+     * @brief Convert a portal config into a portal
+     */
+    static Portal compilePortal(const PortalConfig& portal_config);
+
+    /**
+     * @brief Get the game settings
+     */
+    const GameSettings& getGameSettings() const;
+
+    /**
+     * @brief Get board length
+     */
+    int getBoardSize() const;
+
+    /**
+     * @brief Get all piece types, indexed by type id
+     */
+    const std::vector<PieceType>& getPieceTypes() const;
+
+    /**
+     * @brief Get the piece type of the given id
+     */
+    const PieceType& getPieceType(int type_id) const;
+
+    /**
+     * @brief Get the id of the piece type with the given name
+     * @returns -1 if there is no such type
+     */
+    int findPieceType(const std::string& name) const;
+
+    /**
+     * @brief Get the id of the piece type written with the given letter in
+     * position notation, either case
+     * @returns -1 if no type has that letter
+     */
+    inline int findPieceSymbol(char symbol) const {
+        // ASCII letters only differ from their uppercase form in a single bit
+        unsigned letter = static_cast<unsigned>((symbol | 0x20) - 'a');
+        return letter < 26 ? symbol_types[letter] : -1;
+    }
+
+    /**
+     * @brief Get a hash of the rules, FNV-1a 64 over the board, the piece
+     * types, the starting board & the portals. Rulesets compiled from the
+     * same rules hash equally, however their config was formatted
+     */
+    std::uint64_t getRulesHash() const;
+
+    /**
+     * @brief Get the pieces of the starting board
+     */
+    const std::vector<PiecePlacement>& getPlacements() const;
+
+    /**
+     * @brief Get the portals of the starting board
+     */
+    const std::vector<Portal>& getPortals() const;
+
+private:
+    friend class RulesetCache;
+    Ruleset() = default;
+
+    /**
+     * @brief Remove the patterns of a type whose squares another one always
+     * reaches, so that only a first move can reach a square twice
+     */
+    static void prunePatterns(PieceType& type);
+
+    /**
+     * @brief Give every piece type a distinct letter of position notation
+     */
+    void assignSymbols();
+
+    /**
+     * @brief Work out the hash of getRulesHash
+     */
+    void computeRulesHash();
+
+    GameSettings game_settings;
+    std::vector<PieceType> piece_types;
+    std::unordered_map<std::string, int> type_ids;
+    std::array<std::int16_t, 26> symbol_types;
+    std::vector<PiecePlacement> placements;
+    std::vector<Portal> portals;
+    std::uint64_t rules_hash;
+};
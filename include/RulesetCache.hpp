@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Ruleset.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Class responsible for the precompiled binary form of rulesets
+ *
+ * A cache file holds a fixed header followed by flat record arrays for
+ * piece types, move patterns, placements and portals, and a string pool.
+ * It is keyed by a hash of the JSON source, so an edited config never
+ * loads a stale cache. Files are mapped read-only and every offset is
+ * bounds checked before use; anything unexpected rejects the cache.
+ */
+class RulesetCache {
+public:
+    /**
+     * @brief Format version, bumped whenever the layout changes
+     */
+    static constexpr std::uint32_t VERSION = 1;
+
+    /**
+     * @brief Hash of a config source, FNV-1a 64
+     */
+    static std::uint64_t hashSource(const std::string& source);
+
+    /**
+     * @brief Get the cache path belonging to a config file
+     */
+    static std::string getCachePath(const std::string& config_path);
+
+    /**
+     * @brief Write a ruleset to a cache file, atomically replacing an older one
+     * @returns Whether the cache was written
+     */
+    static bool write(const Ruleset& ruleset, std::uint64_t source_hash,
+                      const std::string& cache_path);
+
+    /**
+     * @brief Map and validate a cache file
+     * @returns nullptr if the file is missing, corrupt or of another source
+     */
+    static std::shared_ptr<const Ruleset> read(const std::string& cache_path,
+                                               std::uint64_t source_hash);
+};
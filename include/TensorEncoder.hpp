@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ChessBoard.hpp"
+#include "Ruleset.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Class responsible for encoding positions as dense feature planes
+ *
+ * Planes are laid out as (piece type x team x board_size x board_size),
+ * row-major with y as the row. Piece types keep their ruleset ids and
+ * teams are ordered WHITE, BLACK.
+ */
+class TensorEncoder {
+public:
+    /**
+     * @brief Initialize an encoder for the given ruleset
+     */
+    explicit TensorEncoder(const Ruleset& ruleset);
+
+    /**
+     * @brief Get the amount of planes in a single position
+     */
+    std::size_t getPlaneCount() const;
+
+    /**
+     * @brief Get the amount of elements in a single position
+     */
+    std::size_t getTensorSize() const;
+
+    /**
+     * @brief Encode a position into a caller-provided buffer
+     * The buffer must hold getTensorSize() elements.
+     */
+    void encode(const ChessBoard& board, float* out) const;
+    void encode(const ChessBoard& board, std::uint8_t* out) const;
+
+    /**
+     * @brief Encode a batch of positions into one contiguous buffer
+     * The buffer must hold count * getTensorSize() elements.
+     */
+    void encodeBatch(const ChessBoard* const* boards, std::size_t count, float* out) const;
+    void encodeBatch(const ChessBoard* const* boards, std::size_t count, std::uint8_t* out) const;
+
+private:
+    template <typename T>
+    void scatter(const ChessBoard& board, T* out) const;
+
+    /**
+     * @brief Amount of piece types
+     */
+    int type_count;
+
+    /**
+     * @brief Board length
+     */
+    int size;
+};
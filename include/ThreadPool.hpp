@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Class representing a fixed set of worker threads running queued jobs
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Start the given amount of workers, at least one
+     */
+    explicit ThreadPool(int worker_count);
+
+    /**
+     * @brief Finish the queued jobs and join the workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queue a job, it runs on the first idle worker
+     */
+    void submit(std::function<void()> job);
+
+    /**
+     * @brief Get the amount of workers
+     */
+    int getWorkerCount() const;
+
+private:
+    void work();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Ruleset.hpp"
+#include "Engine.hpp"
+#include "GameManager.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Class responsible for speaking a UCI-style protocol over streams
+ *
+ * Supported commands:
+ *   uci, isready, ucinewgame, quit, stop
+ *   setoption name Config value <path>
+ *   position [startpos | config <path>] [moves e2e4 ...]
+ *   go [depth N] [nodes N] [movetime MS] [wtime MS] [btime MS]
+ *      [winc MS] [binc MS] [movestogo N] [infinite]
+ *
+ * Searches run on a worker thread, so isready and stop are answered
+ * while a search is in progress.
+ */
+class UciProtocol {
+public:
+    /**
+     * @brief Initialize the protocol with the variant of the given config
+     */
+    explicit UciProtocol(std::ostream& out, const std::string& config_path);
+
+    /**
+     * @brief Stops a running search
+     */
+    ~UciProtocol();
+
+    /**
+     * @brief Read and handle commands until quit or end of input
+     */
+    void run(std::istream& in);
+
+    /**
+     * @brief Handle a single command line
+     * @returns false if the command was quit
+     */
+    bool handleCommand(const std::string& line);
+
+    /**
+     * @brief Block until the running search reports its best move
+     */
+    void waitForSearch();
+
+private:
+    bool loadConfig(const std::string& config_path);
+    void setupPosition(std::istringstream& args);
+    void startSearch(std::istringstream& args);
+    void stopSearch();
+    void send(const std::string& line);
+
+    std::ostream& out;
+    std::mutex out_mutex;
+
+    std::string config_path;
+    std::shared_ptr<const Ruleset> ruleset;
+    std::unique_ptr<GameManager> game;
+    std::unique_ptr<Engine> engine;
+
+    std::thread worker;
+    std::atomic<bool> stop_flag;
+    std::mutex stop_mutex;
+    std::condition_variable stopped;
+    bool infinite_search;
+};
@@ -0,0 +1,299 @@
+#include "AttackKernels.hpp"
+
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CHESS_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+Bitboard256 Bitboard256::getBoardMask(int size) {
+    Bitboard256 mask = {};
+    for (int y = 0; y < size && y < WIDTH; y++)
+        for (int x = 0; x < size && x < WIDTH; x++)
+            mask.set(Position(x, y));
+    return mask;
+}
+
+/**
+ * @brief Fill a kernel table with the specializations of every step
+ */
+template <template <int, int> class Kernels, int... INDICES>
+static constexpr AttackKernels makeKernels(const char* name, std::integer_sequence<int, INDICES...>) {
+    return { name, { &Kernels<INDICES / 5 - 2, INDICES % 5 - 2>::slide... },
+                   { &Kernels<INDICES / 5 - 2, INDICES % 5 - 2>::step... } };
+}
+
+/* Scalar, four 64-bit words of four ranks each */
+
+/**
+ * @brief Lowest bit of each rank within a word
+ */
+static constexpr std::uint64_t RANK_LOW_BITS = 0x0001000100010001ULL;
+
+template <int FILES, int RANKS>
+static inline Bitboard256 shiftScalar(const Bitboard256& board) {
+    Bitboard256 moved;
+    for (int i = 0; i < 4; i++) {
+        if constexpr (FILES >= 16 || FILES <= -16)
+            moved.words[i] = 0;
+        else if constexpr (FILES > 0)
+            moved.words[i] = (board.words[i] << FILES) & ~(RANK_LOW_BITS * ((1ULL << FILES) - 1));
+        else if constexpr (FILES < 0)
+            moved.words[i] = (board.words[i] >> -FILES)
+                           & ~(RANK_LOW_BITS * (((1ULL << -FILES) - 1) << (16 + FILES)));
+        else
+            moved.words[i] = board.words[i];
+    }
+
+    constexpr int WORDS = (RANKS < 0 ? -RANKS : RANKS) / 4;
+    constexpr int BITS = (RANKS < 0 ? -RANKS : RANKS) % 4 * 16;
+    Bitboard256 result = {};
+    for (int i = 0; i < 4; i++) {
+        int from = RANKS >= 0 ? i - WORDS : i + WORDS;
+        if (from < 0 || from >= 4)
+            continue;
+        if constexpr (BITS == 0) {
+            result.words[i] = moved.words[from];
+        } else if constexpr (RANKS > 0) {
+            result.words[i] = moved.words[from] << BITS;
+            if (from >= 1)
+                result.words[i] |= moved.words[from - 1] >> (64 - BITS);
+        } else {
+            result.words[i] = moved.words[from] >> BITS;
+            if (from + 1 < 4)
+                result.words[i] |= moved.words[from + 1] << (64 - BITS);
+        }
+    }
+    return result;
+}
+
+static inline Bitboard256 andScalar(const Bitboard256& a, const Bitboard256& b) {
+    Bitboard256 result;
+    for (int i = 0; i < 4; i++)
+        result.words[i] = a.words[i] & b.words[i];
+    return result;
+}
+
+namespace {
+template <int DX, int DY>
+struct ScalarKernels {
+    static Bitboard256 slide(const Bitboard256& origins, const Bitboard256& empty, const Bitboard256& mask) {
+        Bitboard256 generate = origins;
+        Bitboard256 propagate = andScalar(empty, mask);
+
+        // Rays of up to 1 + 2 + 4 + 8 = 15 steps, enough for 16 squares a side
+        generate |= andScalar(propagate, shiftScalar<DX, DY>(generate));
+        propagate = andScalar(propagate, shiftScalar<DX, DY>(propagate));
+        generate |= andScalar(propagate, shiftScalar<DX * 2, DY * 2>(generate));
+        propagate = andScalar(propagate, shiftScalar<DX * 2, DY * 2>(propagate));
+        generate |= andScalar(propagate, shiftScalar<DX * 4, DY * 4>(generate));
+        propagate = andScalar(propagate, shiftScalar<DX * 4, DY * 4>(propagate));
+        generate |= andScalar(propagate, shiftScalar<DX * 8, DY * 8>(generate));
+
+        return andScalar(shiftScalar<DX, DY>(generate), mask);
+    }
+
+    static Bitboard256 step(const Bitboard256& origins, const Bitboard256& empty, const Bitboard256& mask,
+                            int distance) {
+        Bitboard256 generate = origins;
+        Bitboard256 propagate = andScalar(empty, mask);
+        for (int i = 1; i < distance; i++)
+            generate = andScalar(propagate, shiftScalar<DX, DY>(generate));
+        return andScalar(shiftScalar<DX, DY>(generate), mask);
+    }
+};
+}
+
+static const AttackKernels SCALAR_KERNELS
+    = makeKernels<ScalarKernels>("scalar", std::make_integer_sequence<int, 25>());
+
+#ifdef CHESS_X86_KERNELS
+
+/* SSE2, two 128-bit halves of eight ranks each */
+
+namespace {
+struct Sse2Board {
+    __m128i low;
+    __m128i high;
+};
+}
+
+static inline Sse2Board loadSse2(const Bitboard256& board) {
+    return { _mm_load_si128(reinterpret_cast<const __m128i*>(board.words)),
+             _mm_load_si128(reinterpret_cast<const __m128i*>(board.words + 2)) };
+}
+
+static inline Bitboard256 storeSse2(Sse2Board board) {
+    Bitboard256 result;
+    _mm_store_si128(reinterpret_cast<__m128i*>(result.words), board.low);
+    _mm_store_si128(reinterpret_cast<__m128i*>(result.words + 2), board.high);
+    return result;
+}
+
+static inline Sse2Board andSse2(Sse2Board a, Sse2Board b) {
+    return { _mm_and_si128(a.low, b.low), _mm_and_si128(a.high, b.high) };
+}
+
+static inline Sse2Board orSse2(Sse2Board a, Sse2Board b) {
+    return { _mm_or_si128(a.low, b.low), _mm_or_si128(a.high, b.high) };
+}
+
+template <int FILES, int RANKS>
+static inline Sse2Board shiftSse2(Sse2Board board) {
+    __m128i zero = _mm_setzero_si128();
+    if constexpr (FILES > 0)
+        board = { _mm_slli_epi16(board.low, FILES), _mm_slli_epi16(board.high, FILES) };
+    else if constexpr (FILES < 0)
+        board = { _mm_srli_epi16(board.low, -FILES), _mm_srli_epi16(board.high, -FILES) };
+
+    // Two bytes a rank
+    if constexpr (RANKS == 0)
+        return board;
+    else if constexpr (RANKS >= 16 || RANKS <= -16)
+        return { zero, zero };
+    else if constexpr (RANKS >= 8)
+        return { zero, _mm_slli_si128(board.low, (RANKS - 8) * 2) };
+    else if constexpr (RANKS <= -8)
+        return { _mm_srli_si128(board.high, (-RANKS - 8) * 2), zero };
+    else if constexpr (RANKS > 0)
+        return { _mm_slli_si128(board.low, RANKS * 2),
+                 _mm_or_si128(_mm_slli_si128(board.high, RANKS * 2), _mm_srli_si128(board.low, 16 - RANKS * 2)) };
+    else
+        return { _mm_or_si128(_mm_srli_si128(board.low, -RANKS * 2), _mm_slli_si128(board.high, 16 + RANKS * 2)),
+                 _mm_srli_si128(board.high, -RANKS * 2) };
+}
+
+namespace {
+template <int DX, int DY>
+struct Sse2Kernels {
+    static Bitboard256 slide(const Bitboard256& origins, const Bitboard256& empty, const Bitboard256& mask) {
+        Sse2Board limit = loadSse2(mask);
+        Sse2Board generate = loadSse2(origins);
+        Sse2Board propagate = andSse2(loadSse2(empty), limit);
+
+        generate = orSse2(generate, andSse2(propagate, shiftSse2<DX, DY>(generate)));
+        propagate = andSse2(propagate, shiftSse2<DX, DY>(propagate));
+        generate = orSse2(generate, andSse2(propagate, shiftSse2<DX * 2, DY * 2>(generate)));
+        propagate = andSse2(propagate, shiftSse2<DX * 2, DY * 2>(propagate));
+        generate = orSse2(generate, andSse2(propagate, shiftSse2<DX * 4, DY * 4>(generate)));
+        propagate = andSse2(propagate, shiftSse2<DX * 4, DY * 4>(propagate));
+        generate = orSse2(generate, andSse2(propagate, shiftSse2<DX * 8, DY * 8>(generate)));
+
+        return storeSse2(andSse2(shiftSse2<DX, DY>(generate), limit));
+    }
+
+    static Bitboard256 step(const Bitboard256& origins, const Bitboard256& empty, const Bitboard256& mask,
+                            int distance) {
+        Sse2Board limit = loadSse2(mask);
+        Sse2Board generate = loadSse2(origins);
+        Sse2Board propagate = andSse2(loadSse2(empty), limit);
+        for (int i = 1; i < distance; i++)
+            generate = andSse2(propagate, shiftSse2<DX, DY>(generate));
+        return storeSse2(andSse2(shiftSse2<DX, DY>(generate), limit));
+    }
+};
+}
+
+static const AttackKernels SSE2_KERNELS
+    = makeKernels<Sse2Kernels>("sse2", std::make_integer_sequence<int, 25>());
+
+/* AVX2, one 256-bit register of sixteen ranks */
+
+__attribute__((target("avx2")))
+static inline __m256i loadAvx2(const Bitboard256& board) {
+    return _mm256_load_si256(reinterpret_cast<const __m256i*>(board.words));
+}
+
+__attribute__((target("avx2")))
+static inline Bitboard256 storeAvx2(__m256i board) {
+    Bitboard256 result;
+    _mm256_store_si256(reinterpret_cast<__m256i*>(result.words), board);
+    return result;
+}
+
+template <int FILES, int RANKS>
+__attribute__((target("avx2")))
+static inline __m256i shiftAvx2(__m256i board) {
+    if constexpr (FILES > 0)
+        board = _mm256_slli_epi16(board, FILES);
+    else if constexpr (FILES < 0)
+        board = _mm256_srli_epi16(board, -FILES);
+
+    // Byte shifts stay within 128-bit lanes, ranks crossing the middle come
+    // from the other lane moved over by a permute
+    if constexpr (RANKS == 0) {
+        return board;
+    } else if constexpr (RANKS >= 16 || RANKS <= -16) {
+        return _mm256_setzero_si256();
+    } else if constexpr (RANKS > 0) {
+        __m256i lower = _mm256_permute2x128_si256(board, board, 0x08);
+        if constexpr (RANKS >= 8)
+            return _mm256_slli_si256(lower, (RANKS - 8) * 2);
+        else
+            return _mm256_alignr_epi8(board, lower, 16 - RANKS * 2);
+    } else {
+        __m256i upper = _mm256_permute2x128_si256(board, board, 0x81);
+        if constexpr (RANKS <= -8)
+            return _mm256_srli_si256(upper, (-RANKS - 8) * 2);
+        else
+            return _mm256_alignr_epi8(upper, board, -RANKS * 2);
+    }
+}
+
+namespace {
+template <int DX, int DY>
+struct Avx2Kernels {
+    __attribute__((target("avx2")))
+    static Bitboard256 slide(const Bitboard256& origins, const Bitboard256& empty, const Bitboard256& mask) {
+        __m256i limit = loadAvx2(mask);
+        __m256i generate = loadAvx2(origins);
+        __m256i propagate = _mm256_and_si256(loadAvx2(empty), limit);
+
+        generate = _mm256_or_si256(generate, _mm256_and_si256(propagate, shiftAvx2<DX, DY>(generate)));
+        propagate = _mm256_and_si256(propagate, shiftAvx2<DX, DY>(propagate));
+        generate = _mm256_or_si256(generate, _mm256_and_si256(propagate, shiftAvx2<DX * 2, DY * 2>(generate)));
+        propagate = _mm256_and_si256(propagate, shiftAvx2<DX * 2, DY * 2>(propagate));
+        generate = _mm256_or_si256(generate, _mm256_and_si256(propagate, shiftAvx2<DX * 4, DY * 4>(generate)));
+        propagate = _mm256_and_si256(propagate, shiftAvx2<DX * 4, DY * 4>(propagate));
+        generate = _mm256_or_si256(generate, _mm256_and_si256(propagate, shiftAvx2<DX * 8, DY * 8>(generate)));
+
+        return storeAvx2(_mm256_and_si256(shiftAvx2<DX, DY>(generate), limit));
+    }
+
+    __attribute__((target("avx2")))
+    static Bitboard256 step(const Bitboard256& origins, const Bitboard256& empty, const Bitboard256& mask,
+                            int distance) {
+        __m256i limit = loadAvx2(mask);
+        __m256i generate = loadAvx2(origins);
+        __m256i propagate = _mm256_and_si256(loadAvx2(empty), limit);
+        for (int i = 1; i < distance; i++)
+            generate = _mm256_and_si256(propagate, shiftAvx2<DX, DY>(generate));
+        return storeAvx2(_mm256_and_si256(shiftAvx2<DX, DY>(generate), limit));
+    }
+};
+}
+
+static const AttackKernels AVX2_KERNELS
+    = makeKernels<Avx2Kernels>("avx2", std::make_integer_sequence<int, 25>());
+
+#endif
+
+const AttackKernels& AttackKernels::get() {
+    static const AttackKernels& kernels = *getSupported().back();
+    return kernels;
+}
+
+std::vector<const AttackKernels*> AttackKernels::getSupported() {
+    std::vector<const AttackKernels*> kernels = { &SCALAR_KERNELS };
+
+#ifdef CHESS_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        kernels.push_back(&SSE2_KERNELS);
+    if (__builtin_cpu_supports("avx2"))
+        kernels.push_back(&AVX2_KERNELS);
+#endif
+
+    return kernels;
+}
@@ -0,0 +1,136 @@
+#include "ChessAPI.h"
+#include "GameManager.hpp"
+#include "TensorEncoder.hpp"
+
+#include <exception>
+#include <vector>
+
+struct chess_game {
+    GameManager manager;
+    TensorEncoder encoder;
+
+    explicit chess_game(std::shared_ptr<const Ruleset> ruleset)
+        : manager(ruleset)
+        , encoder(*ruleset) { }
+};
+
+/**
+ * @brief Whether the positions of two rulesets land on the same planes: the
+ * board size & the piece types in id order, whatever else the rules say
+ */
+static bool haveSamePlanes(const Ruleset& a, const Ruleset& b) {
+    if (a.getBoardSize() != b.getBoardSize() || a.getPieceTypes().size() != b.getPieceTypes().size())
+        return false;
+
+    for (size_t type_id = 0; type_id < a.getPieceTypes().size(); type_id++)
+        if (a.getPieceTypes()[type_id].name != b.getPieceTypes()[type_id].name)
+            return false;
+    return true;
+}
+
+template <typename T>
+static int encodeBatch(chess_game* const* games, size_t count, T* out, size_t capacity) {
+    if (games == nullptr || count == 0 || games[0] == nullptr || out == nullptr)
+        return -1;
+
+    try {
+        const TensorEncoder& encoder = games[0]->encoder;
+        if (capacity < count * encoder.getTensorSize())
+            return -1;
+
+        std::vector<const ChessBoard*> boards;
+        boards.reserve(count);
+        // Planes follow the piece type ids, a matching tensor size is not enough
+        const Ruleset& ruleset = *games[0]->manager.getRuleset();
+        for (size_t i = 0; i < count; i++) {
+            if (games[i] == nullptr || !haveSamePlanes(*games[i]->manager.getRuleset(), ruleset))
+                return -1;
+            boards.push_back(&games[i]->manager.getBoard());
+        }
+
+        encoder.encodeBatch(boards.data(), count, out);
+        return 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+extern "C" {
+
+chess_game* chess_game_create(const char* config_path) {
+    if (config_path == nullptr)
+        return nullptr;
+
+    try {
+        auto ruleset = Ruleset::load(config_path);
+        if (ruleset == nullptr)
+            return nullptr;
+
+        return new chess_game(ruleset);
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+void chess_game_destroy(chess_game* game) {
+    delete game;
+}
+
+int chess_game_play_turn(chess_game* game, int from_x, int from_y, int to_x, int to_y) {
+    if (game == nullptr)
+        return -1;
+
+    try {
+        return game->manager.playTurn(Position(from_x, from_y), Position(to_x, to_y)) ? 1 : 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+int chess_game_current_player(chess_game* game) {
+    return game == nullptr ? -1 : game->manager.getCurrentPlayer();
+}
+
+int chess_game_is_over(chess_game* game) {
+    return game == nullptr ? -1 : game->manager.isGameOver();
+}
+
+int chess_game_move_cache_stats(chess_game* game, uint64_t* hits, uint64_t* misses) {
+    if (game == nullptr || hits == nullptr || misses == nullptr)
+        return -1;
+
+    MoveCacheStats stats = game->manager.getMoveCacheStats();
+    *hits = stats.hits;
+    *misses = stats.misses;
+    return 0;
+}
+
+int chess_game_board_size(chess_game* game) {
+    return game == nullptr ? -1 : game->manager.getBoard().getSize();
+}
+
+size_t chess_game_plane_count(chess_game* game) {
+    return game == nullptr ? 0 : game->encoder.getPlaneCount();
+}
+
+size_t chess_game_tensor_size(chess_game* game) {
+    return game == nullptr ? 0 : game->encoder.getTensorSize();
+}
+
+int chess_encode_f32(chess_game* game, float* out, size_t capacity) {
+    return encodeBatch(&game, 1, out, capacity);
+}
+
+int chess_encode_u8(chess_game* game, uint8_t* out, size_t capacity) {
+    return encodeBatch(&game, 1, out, capacity);
+}
+
+int chess_encode_batch_f32(chess_game* const* games, size_t count, float* out, size_t capacity) {
+    return encodeBatch(games, count, out, capacity);
+}
+
+int chess_encode_batch_u8(chess_game* const* games, size_t count, uint8_t* out, size_t capacity) {
+    return encodeBatch(games, count, out, capacity);
+}
+
+}
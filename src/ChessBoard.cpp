@@ -1,145 +1,578 @@
 #include "ChessBoard.hpp"
 
-#include <iostream>
+#include <algorithm>
+#include <bit>
 #include <exception>
+#include <iostream>
 
 ChessBoard::ChessBoard(const GameSettings& game_setting, 
                        const std::vector<PieceConfig>& piece_configs)
-                       : size(0) {
+                       : ChessBoard(std::make_shared<const Ruleset>(game_setting, piece_configs,
+                                                                    std::vector<PortalConfig>())) { }
+
+ChessBoard::ChessBoard(std::shared_ptr<const Ruleset> ruleset)
+                       : ruleset(ruleset), square_count(0), portal_clock(0), size(0) {
     // Set properties with help from game settings
-    this->size = game_setting.board_size;
+    this->size = ruleset->getBoardSize();
+    if (!isSparse())
+        this->transitions.assign(static_cast<std::size_t>(size) * size, PortalTransition{ -1, Position() });
+    this->portals.reserve(ruleset->getPortals().size());
+
+    // Size the pool & indices once, later turns only move handles around
+    std::size_t piece_count = ruleset->getPlacements().size();
+    if (piece_count > std::numeric_limits<PieceHandle>::max())
+        throw std::runtime_error("Too many chess pieces for a single board.");
+    this->pool.reserve(piece_count);
+    this->free_slots.reserve(piece_count);
+    this->captured.reserve(piece_count + 4);
+    for (std::vector<PieceHandle>& handles : this->team_pieces)
+        handles.reserve(piece_count);
+
+    // Ranks, files, diagonals & anti-diagonals
+    if (size > 0) {
+        std::size_t lines = 6 * static_cast<std::size_t>(size) - 2;
+        if (isSparse()) {
+            this->line_keys.reserve(4 * piece_count);
+            this->square_slots.assign(std::bit_ceil(std::max<std::size_t>(16, 2 * piece_count)),
+                                      SquareSlot{ EMPTY_SQUARE, 0 });
+        } else {
+            this->occupancy.assign(lines, 0);
+        }
+    }
 
-    // Initialize each piece with help from piece config
-    for (const auto& piece_config : piece_configs) {
-        for (int i = 0; i < piece_config.count; i++) {
-            Position black_pos = piece_config.black_positions[i];
-            Position white_pos = piece_config.white_positions[i];
+    // Initialize each piece with help from the starting board
+    for (const PiecePlacement& placement : ruleset->getPlacements()) {
+        const PieceType& type = ruleset->getPieceType(placement.type_id);
+        addPiece(ChessPiece(placement.type_id, type.king_type, placement.position, placement.team));
+    }
 
-            ChessPiece black_piece(piece_config.type, piece_config.king_type, black_pos, BLACK);
-            ChessPiece white_piece(piece_config.type, piece_config.king_type, white_pos, WHITE);
+    for (const Portal& portal : ruleset->getPortals())
+        addPortal(portal);
+}
 
-            addPiece(black_piece);
-            addPiece(white_piece);
-        }
-    }
+const std::shared_ptr<const Ruleset>& ChessBoard::getRuleset() const {
+    return this->ruleset;
 }
 
 int ChessBoard::getSize() const {
     return this->size;
 }
 
-const std::list<ChessPiece>& ChessBoard::getPieces() const {
-    return this->pieces;
+bool ChessBoard::isSparse() const {
+    return this->size > MAX_DENSE_SIZE;
+}
+
+PieceRange<const ChessPiece> ChessBoard::getPieces() const {
+    return PieceRange<const ChessPiece>(pool.data(), team_pieces, WHITE, BLACK + 1);
 }
 
-std::list<ChessPiece>& ChessBoard::getPieces() {
-    return this->pieces;
+PieceRange<ChessPiece> ChessBoard::getPieces() {
+    return PieceRange<ChessPiece>(pool.data(), team_pieces, WHITE, BLACK + 1);
 }
 
-std::list<Portal>& ChessBoard::getPortals() {
+std::vector<Portal>& ChessBoard::getPortals() {
     return this->portals;
 }
 
-const std::list<Portal>& ChessBoard::getPortals() const {
+const std::vector<Portal>& ChessBoard::getPortals() const {
     return this->portals;
 }
 
-std::list<const ChessPiece*> ChessBoard::getPiecesOfTeam(team_t team) const {
-    std::list<const ChessPiece*> team_pieces;
+PieceRange<const ChessPiece> ChessBoard::getPiecesOfTeam(team_t team) const {
+    return PieceRange<const ChessPiece>(pool.data(), team_pieces, team, team + 1);
+}
 
-    for (const ChessPiece& piece : pieces)
-        if (piece.team == team)
-            team_pieces.push_back(&piece);
+PieceRange<ChessPiece> ChessBoard::getPiecesOfTeam(team_t team) {
+    return PieceRange<ChessPiece>(pool.data(), team_pieces, team, team + 1);
+}
 
-    return team_pieces;
+PieceHandle ChessBoard::getHandle(const ChessPiece& piece) const {
+    return static_cast<PieceHandle>(&piece - pool.data());
 }
 
-std::list<ChessPiece*> ChessBoard::getPiecesOfTeam(team_t team) {
-    std::list<ChessPiece*> team_pieces;
+ChessPiece& ChessBoard::getPiece(PieceHandle handle) {
+    return pool[handle];
+}
 
-    for (ChessPiece& piece : pieces)
-        if (piece.team == team)
-            team_pieces.push_back(&piece);
+const ChessPiece& ChessBoard::getPiece(PieceHandle handle) const {
+    return pool[handle];
+}
 
-    return team_pieces;
+const std::string& ChessBoard::getTypeName(const ChessPiece& piece) const {
+    return ruleset->getPieceType(piece.type_id).name;
 }
 
 ChessPiece* ChessBoard::getKingOfTeam(team_t team) {
-    for (ChessPiece& piece : getPieces())
-        if (piece.king_type && piece.team == team)
+    const ChessBoard& board = *this;
+    return const_cast<ChessPiece*>(board.getKingOfTeam(team));
+}
+
+const ChessPiece* ChessBoard::getKingOfTeam(team_t team) const {
+    for (const ChessPiece& piece : getPiecesOfTeam(team))
+        if (piece.king_type)
             return &piece;
 
     return nullptr;
 }
 
 ChessPiece* ChessBoard::getPieceAtPosition(Position position) {
-    for(auto& piece : pieces) {
-        if (piece.position == position) return &piece;
+    const ChessBoard& board = *this;
+    return const_cast<ChessPiece*>(board.getPieceAtPosition(position));
+}
+
+Portal* ChessBoard::getPortalAtPosition(Position position) {
+    const ChessBoard& board = *this;
+    return const_cast<Portal*>(board.getPortalAtPosition(position));
+}
+
+const Portal* ChessBoard::getPortalAtPosition(Position position) const {
+    const PortalTransition* transition = getTransition(position);
+    return transition == nullptr ? nullptr : &portals[transition->portal];
+}
+
+const PortalTransition* ChessBoard::getTransition(Position position) const {
+    if (position.x < 0 || position.y < 0 || position.x >= size || position.y >= size)
+        return nullptr;
+
+    std::uint32_t square = position.y * size + position.x;
+    if (isSparse()) {
+        auto it = std::lower_bound(sparse_transitions.begin(), sparse_transitions.end(), square,
+                                   [](const auto& entry, std::uint32_t key) { return entry.first < key; });
+        return it == sparse_transitions.end() || it->first != square ? nullptr : &it->second;
     }
 
-    return nullptr;
+    const PortalTransition& transition = transitions[square];
+    return transition.portal < 0 ? nullptr : &transition;
 }
 
-Portal* ChessBoard::getPortalAtPosition(Position position) {
-    for(auto& piece : portals) {
-        if (piece.entry == position 
-        || (piece.both_ways && piece.exit == position)) return &piece;
+void ChessBoard::setTransition(Position position, const PortalTransition& transition, bool overwrite) {
+    std::uint32_t square = position.y * size + position.x;
+    if (isSparse()) {
+        auto it = std::lower_bound(sparse_transitions.begin(), sparse_transitions.end(), square,
+                                   [](const auto& entry, std::uint32_t key) { return entry.first < key; });
+        if (it == sparse_transitions.end() || it->first != square)
+            sparse_transitions.insert(it, std::make_pair(square, transition));
+        else if (overwrite)
+            it->second = transition;
+        return;
     }
 
-    return nullptr;
+    if (overwrite || transitions[square].portal < 0)
+        transitions[square] = transition;
+}
+
+int ChessBoard::getPortalClock() const {
+    return this->portal_clock;
+}
+
+void ChessBoard::advancePortalClock() {
+    this->portal_clock++;
+}
+
+void ChessBoard::rewindPortalClock() {
+    this->portal_clock--;
+}
+
+int ChessBoard::getPortalCooldown(const Portal& portal) const {
+    return portal.getCooldown(this->portal_clock);
+}
+
+void ChessBoard::setPortalCooldown(Portal& portal, int turns) {
+    portal.ready_at = this->portal_clock + turns;
 }
 
 const ChessPiece* ChessBoard::getPieceAtPosition(Position position) const {
-    for(auto& piece : pieces) {
-        if (piece.position == position) return &piece;
+    if (isSparse()) {
+        if (position.x < 0 || position.y < 0 || position.x >= size || position.y >= size)
+            return nullptr;
+        const SquareSlot& slot = square_slots[findSquareSlot(position.y * size + position.x)];
+        return slot.square == EMPTY_SQUARE ? nullptr : &pool[slot.handle];
+    }
+
+    if (!occupancy.empty() && !isOccupied(position))
+        return nullptr;
+
+    for (const std::vector<PieceHandle>& handles : team_pieces) {
+        for (PieceHandle handle : handles) {
+            if (pool[handle].position == position) return &pool[handle];
+        }
     }
 
     return nullptr;
 }
 
+bool ChessBoard::isOccupied(Position position) const {
+    if (position.x < 0 || position.y < 0 || position.x >= size || position.y >= size)
+        return false;
+
+    if (isSparse())
+        return square_slots[findSquareSlot(position.y * size + position.x)].square != EMPTY_SQUARE;
+
+    if (occupancy.empty())
+        return getPieceAtPosition(position) != nullptr;
+
+    return (occupancy[position.y] >> position.x) & 1;
+}
+
+std::uint64_t ChessBoard::getRankOccupancy(int y) const {
+    return occupancy[y];
+}
+
+std::size_t ChessBoard::getLineIndex(Position position, int dx, int dy, int& coordinate, int& step) const {
+    // Coordinates run along x, except on files where they run along y
+    if (dy == 0) {
+        coordinate = position.x;
+        step = dx;
+        return position.y;
+    }
+
+    if (dx == 0) {
+        coordinate = position.y;
+        step = dy;
+        return size + position.x;
+    }
+
+    coordinate = position.x;
+    step = dx;
+    if (dx == dy)
+        return 3 * size - 1 + position.x - position.y;
+    return 4 * size - 1 + position.x + position.y;
+}
+
+void ChessBoard::setOccupied(Position position, PieceHandle handle, bool occupied) {
+    if (position.x < 0 || position.y < 0 || position.x >= size || position.y >= size)
+        return;
+
+    int x = position.x, y = position.y;
+    if (!isSparse()) {
+        // Spelled out, as every piece placed & every move played runs this
+        std::uint64_t* rank = occupancy.data() + y;
+        std::uint64_t* file = occupancy.data() + size + x;
+        std::uint64_t* diagonal = occupancy.data() + 3 * size - 1 + x - y;
+        std::uint64_t* anti_diagonal = occupancy.data() + 4 * size - 1 + x + y;
+        std::uint64_t along_x = std::uint64_t(1) << x;
+        std::uint64_t along_y = std::uint64_t(1) << y;
+        if (occupied) {
+            *rank |= along_x;
+            *file |= along_y;
+            *diagonal |= along_x;
+            *anti_diagonal |= along_x;
+        } else {
+            *rank &= ~along_x;
+            *file &= ~along_y;
+            *diagonal &= ~along_x;
+            *anti_diagonal &= ~along_x;
+        }
+        return;
+    }
+
+    std::size_t lines[] = {
+        static_cast<std::size_t>(y),
+        static_cast<std::size_t>(size + x),
+        static_cast<std::size_t>(3 * size - 1 + x - y),
+        static_cast<std::size_t>(4 * size - 1 + x + y)
+    };
+    short coordinates[] = { position.x, position.y, position.x, position.x };
+
+    std::uint32_t square = position.y * size + position.x;
+    if (occupied)
+        setSquare(square, handle);
+    else
+        clearSquare(square);
+
+    for (int i = 0; i < 4; i++) {
+        std::uint64_t key = lines[i] << 16 | static_cast<std::uint16_t>(coordinates[i]);
+        auto it = std::lower_bound(line_keys.begin(), line_keys.end(), key);
+        bool present = it != line_keys.end() && *it == key;
+        if (occupied && !present)
+            line_keys.insert(it, key);
+        else if (!occupied && present)
+            line_keys.erase(it);
+    }
+}
+
+/**
+ * @brief Spread the bits of a square index over the whole word
+ */
+static std::uint32_t hashSquare(std::uint32_t square) {
+    square *= 0x9e3779b1u;
+    return square ^ (square >> 16);
+}
+
+std::size_t ChessBoard::findSquareSlot(std::uint32_t square) const {
+    std::size_t mask = square_slots.size() - 1;
+    std::size_t slot = hashSquare(square) & mask;
+    while (square_slots[slot].square != square && square_slots[slot].square != EMPTY_SQUARE)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+void ChessBoard::setSquare(std::uint32_t square, PieceHandle handle) {
+    std::size_t slot = findSquareSlot(square);
+    if (square_slots[slot].square == square) {
+        square_slots[slot].handle = handle;
+        return;
+    }
+
+    square_slots[slot] = SquareSlot{ square, handle };
+    if (++square_count * 2 <= square_slots.size())
+        return;
+
+    // Rehash into twice the slots
+    std::vector<SquareSlot> slots(square_slots.size() * 2, SquareSlot{ EMPTY_SQUARE, 0 });
+    slots.swap(square_slots);
+    for (const SquareSlot& entry : slots)
+        if (entry.square != EMPTY_SQUARE)
+            square_slots[findSquareSlot(entry.square)] = entry;
+}
+
+void ChessBoard::clearSquare(std::uint32_t square) {
+    std::size_t mask = square_slots.size() - 1;
+    std::size_t hole = findSquareSlot(square);
+    if (square_slots[hole].square == EMPTY_SQUARE)
+        return;
+
+    // Shift later entries of the probe back, so that no probe crosses the hole
+    for (std::size_t slot = (hole + 1) & mask; square_slots[slot].square != EMPTY_SQUARE; slot = (slot + 1) & mask) {
+        std::size_t home = hashSquare(square_slots[slot].square) & mask;
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            square_slots[hole] = square_slots[slot];
+            hole = slot;
+        }
+    }
+
+    square_slots[hole].square = EMPTY_SQUARE;
+    square_count--;
+}
+
+bool ChessBoard::isPathClear(Position from, Position to) const {
+    int dx = to.x - from.x;
+    int dy = to.y - from.y;
+    if (dx != 0 && dy != 0 && std::abs(dx) != std::abs(dy))
+        throw std::runtime_error("Squares do not share a line.");
+
+    int range = std::max(std::abs(dx), std::abs(dy));
+    if (range < 2)
+        return true;
+
+    int ux = dx / range;
+    int uy = dy / range;
+    if (occupancy.empty() && !isSparse())
+        return true;
+
+    int coordinate, step;
+    std::size_t line = getLineIndex(from, ux, uy, coordinate, step);
+    int low = std::min(coordinate, coordinate + step * range);
+    int high = std::max(coordinate, coordinate + step * range);
+
+    // The first piece past the lower end must not come before the higher one
+    if (isSparse()) {
+        auto it = std::upper_bound(line_keys.begin(), line_keys.end(), line << 16 | low);
+        return it == line_keys.end() || *it >= (line << 16 | high);
+    }
+
+    // Mask the bits strictly between both ends
+    std::uint64_t between = ((std::uint64_t(1) << high) - 1) & ~((std::uint64_t(2) << low) - 1);
+    return (occupancy[line] & between) == 0;
+}
+
+bool ChessBoard::findFirstBlocker(Position origin, int dx, int dy, Position& blocker) const {
+    if (occupancy.empty() && !isSparse())
+        return false;
+
+    int coordinate, step;
+    std::size_t index = getLineIndex(origin, dx, dy, coordinate, step);
+    int found;
+    if (isSparse()) {
+        // Nearest coordinate past the origin, upwards or downwards along the line
+        std::uint64_t key = index << 16 | coordinate;
+        if (step > 0) {
+            auto it = std::upper_bound(line_keys.begin(), line_keys.end(), key);
+            if (it == line_keys.end() || *it >> 16 != index)
+                return false;
+            found = *it & 0xffff;
+        } else {
+            auto it = std::lower_bound(line_keys.begin(), line_keys.end(), key);
+            if (it == line_keys.begin() || *(it - 1) >> 16 != index)
+                return false;
+            found = *(it - 1) & 0xffff;
+        }
+    } else if (step > 0) {
+        // Nearest set bit past the origin, upwards or downwards along the line
+        std::uint64_t ahead = occupancy[index] & ~((std::uint64_t(2) << coordinate) - 1);
+        if (ahead == 0)
+            return false;
+        found = std::countr_zero(ahead);
+    } else {
+        std::uint64_t ahead = occupancy[index] & ((std::uint64_t(1) << coordinate) - 1);
+        if (ahead == 0)
+            return false;
+        found = std::bit_width(ahead) - 1;
+    }
+
+    int steps = std::abs(found - coordinate);
+    blocker = Position(origin.x + dx * steps, origin.y + dy * steps);
+    return true;
+}
+
 std::set<Position> ChessBoard::getPositionsOfTeam(team_t team) const {
     std::set<Position> positions;
 
-    for (const ChessPiece& piece : pieces)
-        if (piece.team == team)
-            positions.insert(piece.position);
+    for (const ChessPiece& piece : getPiecesOfTeam(team))
+        positions.insert(piece.position);
 
     return positions;
 }
 
+/**
+ * @brief Find where a piece sits within the index of its team
+ */
+static std::vector<PieceHandle>::iterator findHandle(std::vector<PieceHandle>& handles, PieceHandle handle) {
+    for (auto it = handles.begin(); it != handles.end(); ++it)
+        if (*it == handle)
+            return it;
+
+    throw std::runtime_error("Given chess piece was not found.");
+}
+
 void ChessBoard::removePiece(const ChessPiece* piece) {
-    bool removed = false;
-    for (auto it = pieces.begin(); it != pieces.end();) {
-        if (&(*it) == piece) {
-            it = pieces.erase(it); // Erase and get the next valid iterator
-            removed = true;
-        } else {
-            ++it; // Increment if no removal
-        }
-    }
+    if (piece < pool.data() || piece >= pool.data() + pool.size())
+        throw std::runtime_error("Given chess piece was not found.");
+
+    PieceHandle handle = getHandle(*piece);
+    std::vector<PieceHandle>& handles = team_pieces[piece->team];
+    handles.erase(findHandle(handles, handle));
+    free_slots.push_back(handle);
+    setOccupied(piece->position, handle, false);
+}
 
-    if (!removed)
+void ChessBoard::capturePiece(const ChessPiece* piece) {
+    if (piece < pool.data() || piece >= pool.data() + pool.size())
         throw std::runtime_error("Given chess piece was not found.");
+
+    // The piece keeps its slot, only its handle leaves the index
+    PieceHandle handle = getHandle(*piece);
+    std::vector<PieceHandle>& handles = team_pieces[piece->team];
+    auto it = findHandle(handles, handle);
+    captured.push_back(Capture{ handle, static_cast<std::uint16_t>(it - handles.begin()) });
+    handles.erase(it);
+    setOccupied(piece->position, handle, false);
+}
+
+void ChessBoard::restorePiece() {
+    if (captured.empty())
+        throw std::runtime_error("There is no captured chess piece.");
+
+    Capture capture = captured.back();
+    std::vector<PieceHandle>& handles = team_pieces[pool[capture.handle].team];
+    handles.insert(handles.begin() + capture.index, capture.handle);
+    captured.pop_back();
+    setOccupied(pool[capture.handle].position, capture.handle, true);
+}
+
+void ChessBoard::clearCaptured() {
+    for (const Capture& capture : captured)
+        free_slots.push_back(capture.handle);
+    captured.clear();
+}
+
+void ChessBoard::clearPieces() {
+    for (std::vector<PieceHandle>& handles : team_pieces) {
+        free_slots.insert(free_slots.end(), handles.begin(), handles.end());
+        handles.clear();
+    }
+    clearCaptured();
+
+    if (isSparse()) {
+        std::fill(square_slots.begin(), square_slots.end(), SquareSlot{ EMPTY_SQUARE, 0 });
+        square_count = 0;
+        line_keys.clear();
+    } else {
+        std::fill(occupancy.begin(), occupancy.end(), 0);
+    }
 }
 
 void ChessBoard::addPiece(const ChessPiece& piece) {
     if (getPieceAtPosition(piece.position) != nullptr) 
         throw std::runtime_error("There is a chess piece at the destination.");
-    
-    this->pieces.push_back(piece);
+
+    if (piece.type_id < 0 || piece.type_id >= static_cast<int>(ruleset->getPieceTypes().size()))
+        throw std::runtime_error("Chess piece type is not part of the ruleset.");
+
+    if (piece.team != WHITE && piece.team != BLACK)
+        throw std::runtime_error("Chess piece has no team.");
+
+    placePiece(piece);
+}
+
+void ChessBoard::placePiece(const ChessPiece& piece) {
+    PieceHandle handle;
+    if (!free_slots.empty()) {
+        handle = free_slots.back();
+        free_slots.pop_back();
+        pool[handle] = piece;
+    } else {
+        if (pool.size() > std::numeric_limits<PieceHandle>::max())
+            throw std::runtime_error("Too many chess pieces for a single board.");
+        handle = static_cast<PieceHandle>(pool.size());
+        pool.push_back(piece);
+    }
+
+    team_pieces[piece.team].push_back(handle);
+    setOccupied(piece.position, handle, true);
 }
 
 void ChessBoard::addPortal(const Portal& portal) {
+    for (Position position : { portal.entry, portal.exit })
+        if (position.x < 0 || position.y < 0 || position.x >= size || position.y >= size)
+            throw std::runtime_error("Portal is out of bounds.");
+
     if (getPortalAtPosition(portal.entry) != nullptr) 
         throw std::runtime_error("There is a portal at the destination.");
     
+    // An earlier portal keeps a shared square, like a scan in insertion order would
+    int index = static_cast<int>(this->portals.size());
     this->portals.push_back(portal);
+    setTransition(portal.entry, PortalTransition{ index, portal.exit }, true);
+    if (portal.both_ways)
+        setTransition(portal.exit, PortalTransition{ index, portal.entry }, false);
+}
+
+/**
+ * @brief Mix a feature index into a pseudo random key (splitmix64 finalizer),
+ * stands in for a table of random keys which would depend on the board size
+ */
+static std::uint64_t zobristKey(std::uint64_t index) {
+    index += 0x9e3779b97f4a7c15ULL;
+    index = (index ^ (index >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    index = (index ^ (index >> 27)) * 0x94d049bb133111ebULL;
+    return index ^ (index >> 31);
+}
+
+std::uint64_t ChessBoard::getPositionHash() const {
+    std::uint64_t squares = static_cast<std::uint64_t>(size) * size;
+    std::uint64_t hash = 0;
+
+    for (const ChessPiece& piece : getPieces()) {
+        std::uint64_t feature = (static_cast<std::uint64_t>(piece.type_id) * 2 + piece.team) * 2 + piece.used;
+        hash ^= zobristKey(feature * squares + piece.position.y * size + piece.position.x);
+    }
+
+    // Portals on cooldown change the moves, their remaining turns do not matter here
+    for (std::size_t i = 0; i < portals.size(); i++)
+        if (getPortalCooldown(portals[i]) != 0)
+            hash ^= zobristKey(~static_cast<std::uint64_t>(i));
+
+    return hash;
 }
 
 void ChessBoard::movePiece(ChessPiece& piece, Position destination) {
     if (getPieceAtPosition(destination) != nullptr) 
         throw std::runtime_error("There is a chess piece at the destination.");
 
+    PieceHandle handle = getHandle(piece);
+    setOccupied(piece.position, handle, false);
+    setOccupied(destination, handle, true);
     piece.used = true;
     piece.position = destination;
 }
@@ -148,91 +581,124 @@ void ChessBoard::exchangePiecePositions(ChessPiece& piece, ChessPiece& other) {
     Position temp = piece.position;
     piece.position = other.position;
     other.position = temp;
+
+    // Both squares stay occupied, only sparse boards know by whom
+    if (isSparse()) {
+        setOccupied(piece.position, getHandle(piece), true);
+        setOccupied(other.position, getHandle(other), true);
+    }
 }
 
 void ChessBoard::printBoard(std::set<Position> highlight) const {
-    // Create a 2D array to represent the board
-    std::vector<std::vector<std::string>> board(this->size, std::vector<std::string>(this->size, "   "));
+    if (this->size <= MAX_PRINTED_SIZE) {
+        printWindow(Position(0, 0), this->size, this->size, highlight);
+        return;
+    }
+
+    // Window around the first highlighted square, the lower left corner otherwise
+    int width = MAX_PRINTED_SIZE;
+    Position center = highlight.empty() ? Position(width / 2, width / 2) : *highlight.begin();
+    Position corner(std::clamp(center.x - width / 2, 0, this->size - width),
+                    std::clamp(center.y - width / 2, 0, this->size - width));
+    printWindow(corner, width, width, highlight);
+}
+
+void ChessBoard::printWindow(Position corner, int width, int height, const std::set<Position>& highlight) const {
+    int left = std::max(0, static_cast<int>(corner.x));
+    int bottom = std::max(0, static_cast<int>(corner.y));
+    int right = std::min(this->size, corner.x + width);
+    int top = std::min(this->size, corner.y + height);
+    if (left >= right || bottom >= top)
+        return;
+
+    // Only the squares of the window are laid out
+    std::vector<std::string> board(static_cast<std::size_t>(right - left) * (top - bottom), "   ");
+    auto cell = [&](Position pos) -> std::string* {
+        if (pos.x < left || pos.x >= right || pos.y < bottom || pos.y >= top)
+            return nullptr;
+        return &board[(pos.y - bottom) * (right - left) + (pos.x - left)];
+    };
+    auto highlighted = [&](int x, int y) {
+        return highlight.find(Position(x, y)) != highlight.end();
+    };
 
     // Populate the board with portals
     for (const auto& portal : this->portals) {
-        const auto& pos = portal.entry;
-        const auto& pos2 = portal.exit;
+        std::string* entry = cell(portal.entry);
+        std::string* exit = cell(portal.exit);
 
         // Portal under cooldown
-        if (portal.current_cooldown != 0) {
-            board[pos.y][pos.x] = std::string(3, '0' + portal.current_cooldown);
-            board[pos.y][pos.x][0] = ' ';
-            board[pos.y][pos.x][2] = ' ';
-
-            board[pos2.y][pos2.x] = std::string(3, '0' + portal.current_cooldown);
-            board[pos2.y][pos2.x][0] = ' ';
-            board[pos2.y][pos2.x][2] = ' ';
+        int cooldown = getPortalCooldown(portal);
+        if (cooldown != 0) {
+            for (std::string* square : { entry, exit })
+                if (square != nullptr)
+                    *square = std::string(" ") + (char) ('0' + cooldown) + " ";
         } else {
-            board[pos.y][pos.x] = std::string(3, portal.id[0]); // Assign symbol to portal
-            board[pos.y][pos.x][0] = portal.both_ways ? '=' : '>';
-            board[pos.y][pos.x][2] = portal.both_ways ? '=' : '<';
-            
-            board[pos2.y][pos2.x] = std::string(3, portal.id[0]); // Assign symbol to portal
-            board[pos2.y][pos2.x][0] = portal.both_ways ? '=' : '<';
-            board[pos2.y][pos2.x][2] = portal.both_ways ? '=' : '>';
+            if (entry != nullptr) {
+                *entry = std::string(3, portal.id[0]); // Assign symbol to portal
+                (*entry)[0] = portal.both_ways ? '=' : '>';
+                (*entry)[2] = portal.both_ways ? '=' : '<';
+            }
+
+            if (exit != nullptr) {
+                *exit = std::string(3, portal.id[0]); // Assign symbol to portal
+                (*exit)[0] = portal.both_ways ? '=' : '<';
+                (*exit)[2] = portal.both_ways ? '=' : '>';
+            }
         }
     }
 
     // Populate the board with pieces
-    for (const auto& piece : this->pieces) {
-        const auto& pos = piece.position;
-        char piece_symbol = piece.type[0]; // Get the first letter of the piece type
-        board[pos.y][pos.x] = std::string(3, piece_symbol); // Assign symbol to piece
-        if (piece.team == WHITE) {
-            board[pos.y][pos.x][0] = '^';
-            board[pos.y][pos.x][2] = '^';
-        } else {
-            board[pos.y][pos.x][0] = '.';
-            board[pos.y][pos.x][2] = '.';
-        }
+    for (const ChessPiece& piece : getPieces()) {
+        std::string* square = cell(piece.position);
+        if (square == nullptr)
+            continue;
+
+        char piece_symbol = getTypeName(piece)[0]; // Get the first letter of the piece type
+        *square = std::string(3, piece_symbol); // Assign symbol to piece
+        (*square)[0] = (*square)[2] = piece.team == WHITE ? '^' : '.';
     }
 
+    // Row headers are padded to the widest one
+    std::size_t label = std::to_string(top).size() + 1;
+
     // Print the board
-    std::cout << "   ";
-    for (int x = 0; x < this->size; x++) {
-        std::cout << " " << (char) ('a' + x) << "  "; // Column headers
+    std::cout << std::string(label + 1, ' ');
+    for (int x = left; x < right; x++) {
+        std::string file = Position::getFileName(x);
+        std::cout << " " << file << std::string(file.size() < 3 ? 3 - file.size() : 0, ' '); // Column headers
     }
     std::cout << "\n";
 
-    for (int y = this->size - 1; y >= 0; y--) {
-        std::cout << "  "; 
-        for (int x = 0; x < this->size; x++) {
-            Position pos1(x, y);
-            Position pos2(x, y + 1);
-            if (highlight.find(pos1) != highlight.end() || highlight.find(pos2) != highlight.end())
+    for (int y = top - 1; y >= bottom; y--) {
+        std::cout << std::string(label, ' ');
+        for (int x = left; x < right; x++) {
+            if (highlighted(x, y) || highlighted(x, y + 1))
                 std::cout << "+==="; // Highlighted border
             else
                 std::cout << "+---"; // Horizontal borders
         }
         std::cout << "+\n";
 
-        std::cout << y + 1 << " "; // Row header
-        for (int x = 0; x < this->size; x++) {
-            Position pos1(x - 1, y);
-            Position pos2(x, y);
-            if (highlight.find(pos1) != highlight.end() || highlight.find(pos2) != highlight.end())
-                std::cout << "I" << board[y][x]; // Highligthed cell
+        std::string rank = std::to_string(y + 1);
+        std::cout << rank << std::string(label - rank.size(), ' '); // Row header
+        for (int x = left; x < right; x++) {
+            if (highlighted(x - 1, y) || highlighted(x, y))
+                std::cout << "I" << *cell(Position(x, y)); // Highligthed cell
             else
-                std::cout << "|" << board[y][x]; // Cell content
+                std::cout << "|" << *cell(Position(x, y)); // Cell content
         }
 
-        if (highlight.find(Position(this->size - 1, y)) != highlight.end())
+        if (highlighted(right - 1, y))
             std::cout << "I\n";
         else
             std::cout << "|\n";
     }
 
     // Print the bottom border
-    std::cout << "  "; 
-    for (int x = 0; x < this->size; x++) {
-        Position pos(x, 0);
-        if (highlight.find(pos) != highlight.end())
+    std::cout << std::string(label, ' ');
+    for (int x = left; x < right; x++) {
+        if (highlighted(x, bottom))
             std::cout << "+===";
         else
             std::cout << "+---";
@@ -240,6 +706,25 @@ void ChessBoard::printBoard(std::set<Position> highlight) const {
     std::cout << "+\n";
 }
 
+std::size_t ChessBoard::getHeapUsage() const {
+    auto string_heap = [](const std::string& text) {
+        return text.capacity() > 15 ? text.capacity() + 1 : 0;
+    };
+
+    std::size_t usage = pool.capacity() * sizeof(ChessPiece) + free_slots.capacity() * sizeof(PieceHandle)
+                      + captured.capacity() * sizeof(Capture);
+    for (const std::vector<PieceHandle>& handles : team_pieces)
+        usage += handles.capacity() * sizeof(PieceHandle);
+    usage += (occupancy.capacity() + line_keys.capacity()) * sizeof(std::uint64_t)
+           + square_slots.capacity() * sizeof(SquareSlot);
+    usage += portals.capacity() * sizeof(Portal) + transitions.capacity() * sizeof(PortalTransition)
+           + sparse_transitions.capacity() * sizeof(std::pair<std::uint32_t, PortalTransition>);
+    for (const Portal& portal : portals)
+        usage += string_heap(portal.id);
+
+    return usage;
+}
+
 void ChessBoard::printBoard() const {
     printBoard(std::set<Position>());
 }
\ No newline at end of file
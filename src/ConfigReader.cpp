@@ -1,123 +1,460 @@
 #include "ConfigReader.hpp"
 
-#include <fstream>
+#include <nlohmann/json.hpp>
+
+#include <cstring>
 #include <iostream>
-#include <sstream>
+#include <iterator>
 
-ConfigReader::ConfigReader(const std::string& config_path)
-    : config_path_(config_path) {}
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-bool ConfigReader::readConfig() {
-  try {
-    // Open and read the JSON file
-    std::ifstream config_file(config_path_);
-    if (!config_file.is_open()) {
-      std::cerr << "Failed to open config file: " << config_path_ << std::endl;
-      return false;
+namespace {
+
+using json = nlohmann::json;
+
+// Line & column of the last character handed to the lexer
+struct Location {
+  std::size_t line{1};
+  std::size_t column{0};
+  bool after_newline{false};
+};
+
+// Character iterator which keeps a Location up to date as the lexer reads
+class LocatingIterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = char;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const char*;
+  using reference = const char&;
+
+  LocatingIterator(const char* current, Location* location)
+      : current_(current), location_(location) {}
+
+  reference operator*() const { return *current_; }
+
+  LocatingIterator& operator++() {
+    if (location_->after_newline) {
+      location_->line++;
+      location_->column = 1;
+    } else {
+      location_->column++;
     }
+    location_->after_newline = *current_ == '\n';
+    ++current_;
+    return *this;
+  }
 
-    // Parse JSON content
-    nlohmann::json json_data;
-    config_file >> json_data;
+  LocatingIterator operator++(int) {
+    LocatingIterator previous = *this;
+    ++*this;
+    return previous;
+  }
 
-    // Parse game settings and piece configurations
-    parseGameSettings(json_data["game_settings"]);
-    parsePieceConfigs(json_data["pieces"]);
+  bool operator==(const LocatingIterator& other) const {
+    return current_ == other.current_;
+  }
+  bool operator!=(const LocatingIterator& other) const {
+    return current_ != other.current_;
+  }
+
+ private:
+  const char* current_;
+  Location* location_;
+};
+
+// Object or array the parser is currently in
+enum class Scope {
+  kDocument,
+  kSettings,
+  kPieces,
+  kPiece,
+  kPiecePositions,
+  kPositionList,
+  kPosition,
+  kMovement,
+  kPortals,
+  kPortal,
+  kPortalPositions,
+  kPortalPosition,
+  kProperties,
+  kColors,
+  kSkip,  // Unknown subtree, ignored like unknown keys
+};
+
+// Keys which must be present in an object of the given scope
+const std::vector<const char*>& requiredKeys(Scope scope) {
+  static const std::vector<const char*> kNone;
+  static const std::vector<const char*> kDocument = {"game_settings", "pieces"};
+  static const std::vector<const char*> kSettings = {"name", "board_size", "turn_limit"};
+  static const std::vector<const char*> kPiece = {"type", "count"};
+  static const std::vector<const char*> kPoint = {"x", "y"};
+  static const std::vector<const char*> kPortal = {"id", "positions", "properties"};
+  static const std::vector<const char*> kPortalPositions = {"entry", "exit"};
+  static const std::vector<const char*> kProperties = {"allowed_colors"};
+
+  switch (scope) {
+    case Scope::kDocument: return kDocument;
+    case Scope::kSettings: return kSettings;
+    case Scope::kPiece: return kPiece;
+    case Scope::kPosition: return kPoint;
+    case Scope::kPortal: return kPortal;
+    case Scope::kPortalPositions: return kPortalPositions;
+    case Scope::kPortalPosition: return kPoint;
+    case Scope::kProperties: return kProperties;
+    default: return kNone;
+  }
+}
+
+struct Frame {
+  explicit Frame(Scope scope) : scope(scope) {}
+
+  Scope scope;
+  std::string key;       // Last key read within an object
+  unsigned seen{0};      // Bit per required key which was present
+  Position* point{nullptr};
+  std::vector<Position>* list{nullptr};
+};
 
-    // Parse portal configurations if they exist
-    if (json_data.contains("portals")) {
-      parsePortalConfigs(json_data["portals"]);
+// Fills the configs directly from parser events, without building a DOM
+class ConfigHandler : public nlohmann::json_sax<json> {
+ public:
+  ConfigHandler(GameSettings& settings, std::vector<PieceConfig>& pieces,
+                std::vector<PortalConfig>& portals, const Location& location)
+      : settings_(settings), pieces_(pieces), portals_(portals), location_(location) {}
+
+  bool null() override { return scalar(Value{Value::kNull}); }
+
+  bool boolean(bool val) override {
+    Value value{Value::kBool};
+    value.boolean = val;
+    return scalar(value);
+  }
+
+  bool number_integer(number_integer_t val) override {
+    Value value{Value::kNumber};
+    value.number = val;
+    return scalar(value);
+  }
+
+  bool number_unsigned(number_unsigned_t val) override {
+    if (val > static_cast<number_unsigned_t>(std::numeric_limits<long long>::max()))
+      return fail("number out of range for '" + key() + "'");
+    Value value{Value::kNumber};
+    value.number = static_cast<long long>(val);
+    return scalar(value);
+  }
+
+  bool number_float(number_float_t val, const string_t&) override {
+    Value value{Value::kNumber};
+    value.number = static_cast<long long>(val);
+    return scalar(value);
+  }
+
+  bool string(string_t& val) override {
+    Value value{Value::kString};
+    value.text = &val;
+    return scalar(value);
+  }
+
+  bool binary(binary_t&) override { return fail("unexpected binary value"); }
+
+  bool start_object(std::size_t) override { return enter(true); }
+
+  bool key(string_t& val) override {
+    Frame& frame = stack_.back();
+    const std::vector<const char*>& required = requiredKeys(frame.scope);
+    for (std::size_t i = 0; i < required.size(); i++) {
+      if (val == required[i]) frame.seen |= 1u << i;
+    }
+    frame.key = std::move(val);
+    return true;
+  }
+
+  bool end_object() override {
+    const Frame& frame = stack_.back();
+    const std::vector<const char*>& required = requiredKeys(frame.scope);
+    for (std::size_t i = 0; i < required.size(); i++) {
+      if ((frame.seen & (1u << i)) == 0)
+        return fail(std::string("missing key '") + required[i] + "'");
     }
+    stack_.pop_back();
+    return true;
+  }
+
+  bool start_array(std::size_t) override { return enter(false); }
 
+  bool end_array() override {
+    stack_.pop_back();
     return true;
-  } catch (const std::exception& e) {
-    std::cerr << "Error parsing config file: " << e.what() << std::endl;
+  }
+
+  bool parse_error(std::size_t, const std::string&,
+                   const nlohmann::detail::exception& ex) override {
+    // Keep the lexer's explanation, our location prefix replaces its own
+    std::string message = ex.what();
+    std::size_t column = message.find("column ");
+    std::size_t start = column == std::string::npos ? column : message.find(": ", column);
+    return fail(start == std::string::npos ? message : message.substr(start + 2));
+  }
+
+  const std::string& getError() const { return error_; }
+
+ private:
+  struct Value {
+    enum Kind { kNull, kBool, kNumber, kString } kind;
+    bool boolean{false};
+    long long number{0};
+    std::string* text{nullptr};
+  };
+
+  const std::string& key() const {
+    static const std::string kElement = "array element";
+    return stack_.empty() || stack_.back().key.empty() ? kElement : stack_.back().key;
+  }
+
+  bool fail(const std::string& message) {
+    if (error_.empty()) {
+      error_ = std::to_string(location_.line) + ":" + std::to_string(location_.column) +
+               ": " + message;
+    }
     return false;
   }
-}
 
-void ConfigReader::parseGameSettings(const nlohmann::json& json) {
-  game_settings_.name = json["name"].get<std::string>();
-  game_settings_.board_size = json["board_size"].get<int>();
-  game_settings_.turn_limit = json["turn_limit"].get<int>();
-}
+  bool toInt(const Value& value, int& out) {
+    if (value.kind != Value::kNumber) return fail("expected a number for '" + key() + "'");
+    if (value.number < std::numeric_limits<int>::min() ||
+        value.number > std::numeric_limits<int>::max())
+      return fail("number out of range for '" + key() + "'");
+    out = static_cast<int>(value.number);
+    return true;
+  }
 
-void ConfigReader::parsePieceConfigs(const nlohmann::json& json) {
-  piece_configs_.clear();
+  bool toCoordinate(const Value& value, short& out) {
+    if (value.kind != Value::kNumber) return fail("expected a number for '" + key() + "'");
+    if (value.number < std::numeric_limits<short>::min() ||
+        value.number > std::numeric_limits<short>::max())
+      return fail("coordinate out of range for '" + key() + "'");
+    out = static_cast<short>(value.number);
+    return true;
+  }
 
-  for (const auto& piece : json) {
-    PieceConfig config;
-    config.type = piece["type"].get<std::string>();
-    config.king_type = piece.value("king_type", false);
-
-    // Parse positions for both colors
-    if (piece["positions"].contains("white")) {
-      for (const auto& pos : piece["positions"]["white"]) {
-        Position position;
-        position.x = pos["x"].get<int>();
-        position.y = pos["y"].get<int>();
-        config.white_positions.push_back(position);
-      }
+  bool toBool(const Value& value, bool& out) {
+    if (value.kind != Value::kBool) return fail("expected a boolean for '" + key() + "'");
+    out = value.boolean;
+    return true;
+  }
+
+  bool toString(const Value& value, std::string& out) {
+    if (value.kind != Value::kString) return fail("expected a string for '" + key() + "'");
+    out = std::move(*value.text);
+    return true;
+  }
+
+  // Opens the object or array belonging to the current key
+  bool enter(bool object) {
+    if (stack_.empty()) {
+      if (!object) return fail("expected an object at the top level");
+      stack_.emplace_back(Scope::kDocument);
+      return true;
+    }
+
+    Frame& parent = stack_.back();
+    const std::string& name = parent.key;
+    Frame child(Scope::kSkip);
+
+    switch (parent.scope) {
+      case Scope::kDocument:
+        if (object && name == "game_settings") child.scope = Scope::kSettings;
+        if (!object && name == "pieces") child.scope = Scope::kPieces;
+        if (!object && name == "portals") child.scope = Scope::kPortals;
+        break;
+      case Scope::kPieces:
+        if (!object) break;
+        pieces_.emplace_back();
+        pieces_.back().king_type = false;
+        child.scope = Scope::kPiece;
+        break;
+      case Scope::kPiece:
+        if (object && name == "positions") child.scope = Scope::kPiecePositions;
+        if (object && name == "movement") child.scope = Scope::kMovement;
+        break;
+      case Scope::kPiecePositions:
+        if (object) break;
+        if (name == "white") child.list = &pieces_.back().white_positions;
+        if (name == "black") child.list = &pieces_.back().black_positions;
+        if (child.list != nullptr) child.scope = Scope::kPositionList;
+        break;
+      case Scope::kPositionList:
+        if (!object) break;
+        parent.list->emplace_back();
+        child.point = &parent.list->back();
+        child.scope = Scope::kPosition;
+        break;
+      case Scope::kPortals:
+        if (!object) break;
+        portals_.emplace_back();
+        child.scope = Scope::kPortal;
+        break;
+      case Scope::kPortal:
+        if (object && name == "positions") child.scope = Scope::kPortalPositions;
+        if (object && name == "properties") child.scope = Scope::kProperties;
+        break;
+      case Scope::kPortalPositions:
+        if (!object) break;
+        if (name == "entry") child.point = &portals_.back().positions.entry;
+        if (name == "exit") child.point = &portals_.back().positions.exit;
+        if (child.point != nullptr) child.scope = Scope::kPortalPosition;
+        break;
+      case Scope::kProperties:
+        if (!object && name == "allowed_colors") {
+          portals_.back().properties.allowed_colors.clear();
+          child.scope = Scope::kColors;
+        }
+        break;
+      default:
+        break;
     }
 
-    if (piece["positions"].contains("black")) {
-      for (const auto& pos : piece["positions"]["black"]) {
-        Position position;
-        position.x = pos["x"].get<int>();
-        position.y = pos["y"].get<int>();
-        config.black_positions.push_back(position);
+    stack_.push_back(std::move(child));
+    return true;
+  }
+
+  // Stores a value belonging to the current key
+  bool scalar(const Value& value) {
+    if (stack_.empty()) return fail("expected an object at the top level");
+
+    Frame& frame = stack_.back();
+    const std::string& name = frame.key;
+
+    switch (frame.scope) {
+      case Scope::kSettings:
+        if (name == "name") return toString(value, settings_.name);
+        if (name == "board_size") return toInt(value, settings_.board_size);
+        if (name == "turn_limit") return toInt(value, settings_.turn_limit);
+        break;
+      case Scope::kPiece: {
+        PieceConfig& piece = pieces_.back();
+        if (name == "type") return toString(value, piece.type);
+        if (name == "king_type") return toBool(value, piece.king_type);
+        if (name == "count") return toInt(value, piece.count);
+        break;
       }
+      case Scope::kPosition:
+      case Scope::kPortalPosition:
+        if (name == "x") return toCoordinate(value, frame.point->x);
+        if (name == "y") return toCoordinate(value, frame.point->y);
+        break;
+      case Scope::kMovement: {
+        MovementRules& rules = pieces_.back().movement;
+        if (name == "forward") return toInt(value, rules.forward);
+        if (name == "backward") return toInt(value, rules.backward);
+        if (name == "sideways") return toInt(value, rules.sideways);
+        if (name == "diagonal") return toInt(value, rules.diagonal);
+        if (name == "l_shape") return toBool(value, rules.l_shape);
+        if (name == "first_move_forward") return toInt(value, rules.first_move_forward);
+        if (name == "diagonal_capture") return toInt(value, rules.diagonal_capture);
+        break;
+      }
+      case Scope::kPortal:
+        if (name == "id") return toString(value, portals_.back().id);
+        break;
+      case Scope::kProperties: {
+        PortalProperties& properties = portals_.back().properties;
+        if (name == "preserve_direction") return toBool(value, properties.preserve_direction);
+        if (name == "cooldown") return toInt(value, properties.cooldown);
+        break;
+      }
+      case Scope::kColors: {
+        std::string color;
+        if (!toString(value, color)) return false;
+        portals_.back().properties.allowed_colors.push_back(std::move(color));
+        return true;
+      }
+      default:
+        break;
     }
 
-    // Parse movement rules
-    const auto& movement = piece["movement"];
-    config.movement.forward = movement.value("forward", 0);
-    config.movement.backward = movement.value("backward", 0);
-    config.movement.sideways = movement.value("sideways", 0);
-    config.movement.diagonal = movement.value("diagonal", 0);
-    config.movement.l_shape = movement.value("l_shape", false);
-    config.movement.first_move_forward =
-        movement.value("first_move_forward", 0);
-    config.movement.diagonal_capture = movement.value("diagonal_capture", 0);
+    return true;
+  }
+
+  GameSettings& settings_;
+  std::vector<PieceConfig>& pieces_;
+  std::vector<PortalConfig>& portals_;
+  const Location& location_;
+  std::vector<Frame> stack_;
+  std::string error_;
+};
 
-    config.count = piece["count"].get<int>();
-    piece_configs_.push_back(config);
+}  // namespace
+
+ConfigReader::ConfigReader(const std::string& config_path)
+    : config_path_(config_path) {}
+
+bool ConfigReader::readConfig() {
+  // Map the JSON file, the parser streams straight from the page cache
+  int fd = open(config_path_.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat info;
+  if (fd < 0 || fstat(fd, &info) != 0) {
+    if (fd >= 0) close(fd);
+    error_ = "failed to open " + config_path_;
+    std::cerr << "Failed to open config file: " << config_path_ << std::endl;
+    return false;
   }
-}
 
-void ConfigReader::parsePortalConfigs(const nlohmann::json& json) {
-  portal_configs_.clear();
+  std::size_t size = static_cast<std::size_t>(info.st_size);
+  if (size == 0) {
+    close(fd);
+    return parse("", "");
+  }
 
-  for (const auto& portal : json) {
-    PortalConfig config;
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    error_ = "failed to map " + config_path_;
+    std::cerr << "Failed to open config file: " << config_path_ << std::endl;
+    return false;
+  }
 
-    // Parse portal ID
-    config.id = portal["id"].get<std::string>();
+  const char* data = static_cast<const char*>(mapping);
+  bool result = parse(data, data + size);
+  munmap(mapping, size);
+  return result;
+}
 
-    // Parse positions
-    config.positions.entry.x = portal["positions"]["entry"]["x"].get<int>();
-    config.positions.entry.y = portal["positions"]["entry"]["y"].get<int>();
-    config.positions.exit.x = portal["positions"]["exit"]["x"].get<int>();
-    config.positions.exit.y = portal["positions"]["exit"]["y"].get<int>();
+bool ConfigReader::parseConfig(const std::string& source) {
+  return parse(source.data(), source.data() + source.size());
+}
 
-    // Parse properties
-    const auto& props = portal["properties"];
-    config.properties.preserve_direction =
-        props.value("preserve_direction", true);
-    config.properties.allowed_colors =
-        props["allowed_colors"].get<std::vector<std::string>>();
-    config.properties.cooldown = props.value("cooldown", 0);
+bool ConfigReader::parse(const char* begin, const char* end) {
+  game_settings_ = GameSettings();
+  piece_configs_.clear();
+  portal_configs_.clear();
+  error_.clear();
 
-    portal_configs_.push_back(config);
+  Location location;
+  ConfigHandler handler(game_settings_, piece_configs_, portal_configs_, location);
+  if (!json::sax_parse(LocatingIterator(begin, &location), LocatingIterator(end, &location),
+                       &handler)) {
+    error_ = handler.getError();
+    std::cerr << "Error parsing config file: " << config_path_ << ":" << error_ << std::endl;
+    return false;
   }
+
+  return true;
 }
 
-GameSettings ConfigReader::getGameSettings() const { return game_settings_; }
+const std::string& ConfigReader::getError() const { return error_; }
+
+const GameSettings& ConfigReader::getGameSettings() const { return game_settings_; }
 
-std::vector<PieceConfig> ConfigReader::getPieceConfigs() const {
+const std::vector<PieceConfig>& ConfigReader::getPieceConfigs() const {
   return piece_configs_;
 }
 
-std::vector<PortalConfig> ConfigReader::getPortalConfigs() const {
+const std::vector<PortalConfig>& ConfigReader::getPortalConfigs() const {
   return portal_configs_;
 }
@@ -0,0 +1,172 @@
+#include "Engine.hpp"
+
+#include <algorithm>
+
+static constexpr int INFINITE_SCORE = Engine::MATE_SCORE + 1;
+
+/**
+ * @brief Estimate the value of a piece from its movement rules.
+ * Calibrated so the pieces of the classic configs land near their usual values.
+ */
+static int pieceValue(const PieceType& type) {
+    if (type.king_type)
+        return 0;
+
+    const MovementRules& rule = type.movement;
+    int value = 0;
+    value += rule.forward == -1 ? 150 : (rule.forward > 0 ? 100 : 0);
+    value += rule.backward == -1 ? 100 : (rule.backward > 0 ? 30 : 0);
+    value += rule.sideways == -1 ? 250 : (rule.sideways > 0 ? 60 : 0);
+    value += rule.diagonal == -1 ? 325 : (rule.diagonal > 0 ? 80 : 0);
+    value += rule.l_shape ? 300 : 0;
+    return std::max(value, 100);
+}
+
+Engine::Engine(const Ruleset& ruleset)
+               : stop_flag(nullptr), has_deadline(false), node_limit(0), nodes(0), aborted(false) {
+    for (const PieceType& type : ruleset.getPieceTypes())
+        piece_values.push_back(pieceValue(type));
+}
+
+int Engine::evaluate(GameManager& game) const {
+    int score = 0;
+
+    for (const ChessPiece& piece : game.getBoard().getPieces()) {
+        int value = piece_values[piece.type_id];
+        score += piece.team == game.getCurrentPlayer() ? value : -value;
+    }
+
+    return score;
+}
+
+bool Engine::shouldStop() {
+    if (aborted)
+        return true;
+
+    if (stop_flag->load(std::memory_order_relaxed)
+        || (node_limit > 0 && nodes >= node_limit)
+        || (has_deadline && std::chrono::steady_clock::now() >= deadline))
+        aborted = true;
+
+    return aborted;
+}
+
+void Engine::orderMoves(GameManager& game, std::vector<Move>& moves) const {
+    // Captures of valuable pieces first
+    auto victim = [&](const Move& move) {
+        const ChessPiece* piece = game.getBoard().getPieceAtPosition(move.to);
+        if (piece == nullptr)
+            return 0;
+        return piece_values[piece->type_id];
+    };
+
+    std::stable_sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
+        return victim(a) > victim(b);
+    });
+}
+
+int Engine::negamax(GameManager& game, int depth, int ply, int alpha, int beta) {
+    nodes++;
+    if (shouldStop())
+        return 0;
+
+    if (game.isGameOver()) {
+        if (game.getWinner() == TIE)
+            return 0;
+        return game.getWinner() == game.getCurrentPlayer() ? MATE_SCORE - ply : -(MATE_SCORE - ply);
+    }
+
+    if (depth == 0)
+        return evaluate(game);
+
+    std::vector<Move> moves = game.getCandidateMoves();
+    orderMoves(game, moves);
+
+    int best = -INFINITE_SCORE;
+    for (const Move& move : moves) {
+        GameManager child(game);
+        if (!child.playTurn(move))
+            continue;
+
+        int score = -negamax(child, depth - 1, ply + 1, -beta, -alpha);
+        if (aborted)
+            return 0;
+
+        best = std::max(best, score);
+        alpha = std::max(alpha, score);
+        if (alpha >= beta)
+            break;
+    }
+
+    // Unreachable in practice, game over is detected once no legal move is left
+    return best == -INFINITE_SCORE ? 0 : best;
+}
+
+SearchResult Engine::search(const GameManager& game, const SearchLimits& limits,
+                            const std::atomic<bool>& stop, InfoCallback on_info) {
+    auto start = std::chrono::steady_clock::now();
+    stop_flag = &stop;
+    has_deadline = limits.movetime > 0;
+    deadline = start + std::chrono::milliseconds(limits.movetime);
+    node_limit = limits.nodes;
+    nodes = 0;
+    aborted = false;
+
+    SearchResult result;
+    GameManager root(game);
+    if (root.isGameOver())
+        return result;
+
+    // Only keep legal root moves, so there is always a move to report
+    std::vector<Move> moves = root.getLegalMoves();
+    if (moves.empty())
+        return result;
+
+    orderMoves(root, moves);
+    result.has_move = true;
+    result.best_move = moves.front();
+
+    int max_depth = limits.depth > 0 ? limits.depth : 64;
+    for (int depth = 1; depth <= max_depth; depth++) {
+        int alpha = -INFINITE_SCORE;
+        std::size_t best_index = 0;
+
+        for (std::size_t i = 0; i < moves.size(); i++) {
+            GameManager child(root);
+            child.playTurn(moves[i]);
+
+            int score = -negamax(child, depth - 1, 1, -INFINITE_SCORE, -alpha);
+            if (aborted)
+                break;
+
+            if (score > alpha) {
+                alpha = score;
+                best_index = i;
+            }
+        }
+
+        // Partial iterations are discarded
+        if (aborted)
+            break;
+
+        std::rotate(moves.begin(), moves.begin() + best_index, moves.begin() + best_index + 1);
+        result.best_move = moves.front();
+        result.score = alpha;
+        result.depth = depth;
+        result.nodes = nodes;
+        result.time = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        if (on_info)
+            on_info(result);
+
+        // A forced mate was found, deeper iterations can not improve on it
+        if (std::abs(alpha) >= MATE_SCORE - max_depth)
+            break;
+    }
+
+    result.nodes = nodes;
+    result.time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    return result;
+}
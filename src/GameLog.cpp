@@ -0,0 +1,265 @@
+#include "GameLog.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char MAGIC[8] = { 'C', 'H', 'S', 'S', 'G', 'L', 'O', 'G' };
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t header_size;
+};
+
+struct RecordHeader {
+    std::uint32_t move_count;
+    std::uint8_t result;
+    std::uint8_t move_size;
+    std::uint16_t reserved;
+    std::uint64_t rules_hash;
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0 && sizeof(RecordHeader) % 8 == 0,
+              "Records must stay aligned to 8 bytes");
+
+/**
+ * @brief Bytes of a record of the given moves, padding included
+ */
+std::size_t getRecordSize(std::size_t move_count, std::size_t move_size) {
+    return (sizeof(RecordHeader) + move_count * move_size + 7) & ~std::size_t(7);
+}
+
+GameResult getResult(const GameManager& game) {
+    if (!game.isGameOver())
+        return UNFINISHED;
+    if (game.getWinner() == TIE)
+        return DRAWN;
+    return game.getWinner() == WHITE ? WHITE_WON : BLACK_WON;
+}
+
+} // namespace
+
+Move GameRecord::getMove(std::size_t index) const {
+    if (move_size == 2) {
+        std::uint16_t code;
+        std::memcpy(&code, moves + index * 2, sizeof(code));
+        return Move(Position(code & 15, (code >> 4) & 15), Position((code >> 8) & 15, code >> 12));
+    }
+
+    std::uint16_t codes[4];
+    std::memcpy(codes, moves + index * 8, sizeof(codes));
+    return Move(Position(codes[0], codes[1]), Position(codes[2], codes[3]));
+}
+
+std::shared_ptr<GameLog> GameLog::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    if (info.st_size == 0) {
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.header_size = sizeof(FileHeader);
+        if (write(fd, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header))) {
+            close(fd);
+            return nullptr;
+        }
+    } else {
+        // Cut off a record torn by a crash, appending after it would hide the rest
+        std::unique_ptr<GameLogReader> reader = GameLogReader::open(path);
+        if (reader == nullptr) {
+            close(fd);
+            return nullptr;
+        }
+
+        GameRecord record;
+        while (reader->next(record)) { }
+        if (!reader->isAtEnd() && ftruncate(fd, static_cast<off_t>(reader->getOffset())) != 0) {
+            close(fd);
+            return nullptr;
+        }
+    }
+
+    return std::shared_ptr<GameLog>(new GameLog(fd));
+}
+
+GameLog::GameLog(int fd) : fd(fd), game_count(0) {
+    buffer.reserve(BUFFER_SIZE);
+}
+
+GameLog::~GameLog() {
+    flush();
+    close(fd);
+}
+
+bool GameLog::append(const GameManager& game) {
+    if (game.getHistoryStart() != 0)
+        return false;
+
+    std::vector<Move> moves = game.getHistory();
+    std::size_t move_count = game.getMoveCount();
+    std::size_t move_size = game.getBoard().getSize() > 16 ? 8 : 2;
+    std::size_t record_size = getRecordSize(move_count, move_size);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!buffer.empty() && buffer.size() + record_size > BUFFER_SIZE && !writeBuffer())
+        return false;
+
+    std::size_t offset = buffer.size();
+    buffer.resize(offset + record_size, 0);
+    unsigned char* data = buffer.data() + offset;
+
+    RecordHeader header{ static_cast<std::uint32_t>(move_count), getResult(game),
+                         static_cast<std::uint8_t>(move_size), 0, game.getRuleset()->getRulesHash() };
+    std::memcpy(data, &header, sizeof(header));
+    data += sizeof(header);
+
+    for (std::size_t i = 0; i < move_count; i++) {
+        const Move& move = moves[i];
+        if (move_size == 2) {
+            std::uint16_t code = static_cast<std::uint16_t>(move.from.x | move.from.y << 4
+                                                            | move.to.x << 8 | move.to.y << 12);
+            std::memcpy(data + i * 2, &code, sizeof(code));
+        } else {
+            std::uint16_t codes[4] = { static_cast<std::uint16_t>(move.from.x),
+                                       static_cast<std::uint16_t>(move.from.y),
+                                       static_cast<std::uint16_t>(move.to.x),
+                                       static_cast<std::uint16_t>(move.to.y) };
+            std::memcpy(data + i * 8, codes, sizeof(codes));
+        }
+    }
+
+    game_count++;
+    return buffer.size() < BUFFER_SIZE || writeBuffer();
+}
+
+bool GameLog::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return writeBuffer();
+}
+
+std::uint64_t GameLog::getGameCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return game_count;
+}
+
+bool GameLog::writeBuffer() {
+    // The buffer is dropped on failure, a torn record is cut off on the next open
+    std::size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t length = write(fd, buffer.data() + written, buffer.size() - written);
+        if (length < 0 && errno == EINTR)
+            continue;
+        if (length <= 0)
+            break;
+        written += static_cast<std::size_t>(length);
+    }
+
+    bool complete = written == buffer.size();
+    buffer.clear();
+    return complete;
+}
+
+std::unique_ptr<GameLogReader> GameLogReader::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        close(fd);
+        return nullptr;
+    }
+
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return nullptr;
+
+    // Records are read in order, let the kernel read ahead
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    const FileHeader* header = static_cast<const FileHeader*>(mapping);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != GameLog::VERSION
+        || header->header_size != sizeof(FileHeader)) {
+        munmap(mapping, size);
+        return nullptr;
+    }
+
+    return std::unique_ptr<GameLogReader>(
+        new GameLogReader(static_cast<const unsigned char*>(mapping), size));
+}
+
+GameLogReader::GameLogReader(const unsigned char* data, std::size_t size)
+                             : data(data), size(size), offset(sizeof(FileHeader)) { }
+
+GameLogReader::~GameLogReader() {
+    munmap(const_cast<unsigned char*>(data), size);
+}
+
+bool GameLogReader::next(GameRecord& record) {
+    if (size - offset < sizeof(RecordHeader))
+        return false;
+
+    // Offsets stay aligned to 8 bytes, as does the mapping
+    const RecordHeader* header = reinterpret_cast<const RecordHeader*>(data + offset);
+    if (header->result > UNFINISHED || (header->move_size != 2 && header->move_size != 8)
+        || header->reserved != 0)
+        return false;
+
+    std::size_t record_size = getRecordSize(header->move_count, header->move_size);
+    if (record_size > size - offset)
+        return false;
+
+    record.rules_hash = header->rules_hash;
+    record.move_count = header->move_count;
+    record.result = static_cast<GameResult>(header->result);
+    record.move_size = header->move_size;
+    record.moves = data + offset + sizeof(RecordHeader);
+    offset += record_size;
+    return true;
+}
+
+std::size_t GameLogReader::getOffset() const {
+    return offset;
+}
+
+bool GameLogReader::isAtEnd() const {
+    return offset == size;
+}
+
+bool replayGame(const GameRecord& record, const GameManager& start, std::size_t& rejected,
+                std::vector<std::uint64_t>* positions) {
+    // Replays run on all cores, a cache shared with start would serialize them
+    GameManager game(start, GameManager::OWN_CACHES);
+    if (positions != nullptr)
+        positions->clear();
+
+    for (std::size_t i = 0; i < record.move_count; i++) {
+        if (positions != nullptr)
+            positions->push_back(game.getStateHash());
+
+        if (!game.playTurn(record.getMove(i))) {
+            rejected = i;
+            return false;
+        }
+    }
+
+    rejected = record.move_count;
+    return getResult(game) == record.result;
+}
@@ -1,92 +1,403 @@
 #include "GameManager.hpp"
+#include "GameLog.hpp"
+#include "Ponderer.hpp"
+#include "PositionNotation.hpp"
+
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+
+namespace {
+
+/**
+ * @brief State of a parallel search for a legal move, shared with the jobs
+ * so that jobs starting after the search ended find nothing left to do
+ */
+struct ParallelSearch {
+    const ChessBoard* board;
+    std::vector<PieceHandle> pieces;
+    int partition_count;
+
+    std::atomic<int> next_partition{ 0 };
+    std::atomic<bool> found{ false };
+    Move witness;
+
+    std::mutex mutex;
+    std::condition_variable done;
+    int finished_count = 0;
+};
+
+/**
+ * @brief Play a move on a board, look for a check, then rewind
+ */
+bool isLandingSafe(ChessBoard& board, const MoveValidator& validator, ChessPiece& piece, Position destination) {
+    ChessPiece* opponent_piece = board.getPieceAtPosition(destination);
+    if (opponent_piece != nullptr && opponent_piece->team == piece.team)
+        return false;
+
+    Position og_pos = piece.position;
+    bool og_used = piece.used;
+    if (opponent_piece != nullptr)
+        board.capturePiece(opponent_piece);
+
+    board.movePiece(piece, destination);
+    bool check = validator.findCheckingPiece(piece.team) != nullptr;
+
+    board.movePiece(piece, og_pos);
+    piece.used = og_used;
+    if (opponent_piece != nullptr)
+        board.restorePiece();
+
+    return !check;
+}
+
+/**
+ * @brief Claim partitions until none is left. Partition i holds every
+ * partition_count-th piece from i on, searched on a copy of the board
+ */
+void runParallelSearch(ParallelSearch& search) {
+    int partition;
+    while ((partition = search.next_partition.fetch_add(1)) < search.partition_count) {
+        if (!search.found.load(std::memory_order_relaxed)) {
+            ChessBoard board(*search.board);
+            MoveValidator validator(board);
+            std::vector<Move> moves;
+
+            for (std::size_t i = partition; i < search.pieces.size(); i += search.partition_count) {
+                ChessPiece& piece = board.getPiece(search.pieces[i]);
+                moves.clear();
+                validator.getMoves(piece, moves);
+
+                for (const Move& move : moves) {
+                    if (search.found.load(std::memory_order_relaxed))
+                        break;
+                    if (isLandingSafe(board, validator, piece, move.landing) && !search.found.exchange(true))
+                        search.witness = move;
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(search.mutex);
+            search.finished_count++;
+        }
+        search.done.notify_all();
+    }
+}
+
+}
 
 GameManager::GameManager(const GameSettings& game_setting, 
                          const std::vector<PieceConfig>& piece_configs, 
                          const std::vector<PortalConfig>& portal_configs)
-                         : board(game_setting, piece_configs) 
-                         , validator(board, piece_configs)
-                         , portal_system(board, portal_configs) {
+                         : GameManager(std::make_shared<const Ruleset>(game_setting, piece_configs,
+                                                                       portal_configs)) { }
+
+GameManager::GameManager(std::shared_ptr<const Ruleset> ruleset)
+                         : board(ruleset) 
+                         , validator(board)
+                         , portal_system(board)
+                         , legal_move_cache(std::make_shared<LegalMoveCache>(LEGAL_MOVE_CACHE_SIZE))
+                         , move_cache(std::make_shared<MoveCache>(MOVE_CACHE_SIZE)) {
     current_player = WHITE;
+    winner = TIE;
     game_over = false;
     move_count = 0;
     checking_piece = nullptr;
-    move_limit = game_setting.turn_limit * 2;
+    turn_error = NO_ERROR;
+    move_limit = ruleset->getGameSettings().turn_limit * 2;
+
+    // Bound the moves of a single piece, walks stop at the board edge
+    std::size_t most_moves = 0;
+    for (const PieceType& type : ruleset->getPieceTypes()) {
+        std::size_t type_moves = 0;
+        for (const MovePattern& pattern : type.patterns)
+            type_moves += pattern.distance != 0 ? 1 : board.getSize() - 1;
+        most_moves = std::max(most_moves, type_moves);
+    }
+    scratch_moves.reserve(most_moves);
+    parallel_min_pieces = PARALLEL_MIN_PIECES;
+    history_start = 0;
+    history_player = WHITE;
+    reserveHistory();
 }
 
-bool GameManager::isGameOver() {
+GameManager::GameManager(const GameManager& other) : GameManager(other, SHARED_CACHES) { }
+
+GameManager::GameManager(const GameManager& other, CacheSharing caches)
+                         : board(other.board)
+                         , validator(board)
+                         , portal_system(board)
+                         , legal_move_cache(caches == SHARED_CACHES ? other.legal_move_cache
+                                            : std::make_shared<LegalMoveCache>(LEGAL_MOVE_CACHE_SIZE))
+                         , move_cache(caches == SHARED_CACHES ? other.move_cache
+                                      : std::make_shared<MoveCache>(MOVE_CACHE_SIZE))
+                         , witnesses{ other.witnesses[0], other.witnesses[1] }
+                         , pool(other.pool)
+                         , parallel_min_pieces(other.parallel_min_pieces)
+                         , checkpoint_count(0)
+                         , history_start(other.move_count)
+                         , history_player(other.current_player)
+                         , turn_error(other.turn_error)
+                         , checking_piece(nullptr)
+                         , winner(other.winner)
+                         , current_player(other.current_player)
+                         , game_over(other.game_over)
+                         , move_count(other.move_count)
+                         , move_limit(other.move_limit) {
+    if (other.checking_piece != nullptr)
+        checking_piece = &board.getPiece(other.board.getHandle(*other.checking_piece));
+    scratch_moves.reserve(other.scratch_moves.capacity());
+}
+
+void GameManager::setParallelism(std::shared_ptr<ThreadPool> pool, std::size_t min_pieces) {
+    this->pool = std::move(pool);
+    parallel_min_pieces = min_pieces;
+}
+
+void GameManager::setGameLog(std::shared_ptr<GameLog> log) {
+    game_log = std::move(log);
+}
+
+const std::shared_ptr<const Ruleset>& GameManager::getRuleset() const {
+    return board.getRuleset();
+}
+
+bool GameManager::isGameOver() const {
     return game_over;
 }
 
-int GameManager::getMoveCount() {
+int GameManager::getMoveCount() const {
     return move_count;
 }
 
-team_t GameManager::getCurrentPlayer() {
+team_t GameManager::getCurrentPlayer() const {
     return current_player;
 }
 
-bool GameManager::withTurnError(std::string err) {
+bool GameManager::withTurnError(TurnError err) {
     turn_error = err;
     return false;
 }
 
-std::string GameManager::getTurnError() {
+std::string GameManager::getTurnError() const {
+    return describeTurnError(turn_error);
+}
+
+GameManager::TurnError GameManager::getTurnErrorCode() const {
     return turn_error;
 }
 
-const ChessBoard& GameManager::getBoard() {
+const char* GameManager::describeTurnError(TurnError error) {
+    switch (error) {
+        case NO_ERROR:         return "";
+        case GAME_OVER:        return "Game is Over";
+        case NO_PIECE:         return "No Piece at Position";
+        case INVALID_MOVE:     return "Invalid Move";
+        case WRONG_PLAYER:     return "Wrong Player";
+        case PORTAL_UNUSABLE:  return "Portal is Unusable";
+        case KING_UNDER_CHECK: return "King Under Check! Reversed";
+        case INVALID_INPUT:    return "Invalid Input";
+        case OPPONENT_PIECE:   return "That's Opponent's Piece";
+    }
+
+    return "Unknown Error";
+}
+
+const ChessBoard& GameManager::getBoard() const {
     return board;
 }
 
-team_t GameManager::getWinner() {
+team_t GameManager::getWinner() const {
     return winner;
 }
 
-int GameManager::getMoveLimit() {
+int GameManager::getMoveLimit() const {
     return move_limit;
 }
 
-void GameManager::checkGameOver() {
-    bool still_check = isKingUnderCheck(current_player);
-    bool move_check = true;
-
-    // Check all possible moves by current player
-    std::list<ChessPiece*> team_pieces = board.getPiecesOfTeam(current_player);
-    for (ChessPiece* piece : team_pieces) {
-        Position og_pos = piece->position;
-        std::set<Position> moves = validator.getPossibleMoves(*piece);
-
-        for (Position move : moves) {
-            ChessPiece* opponent_piece = board.getPieceAtPosition(move);
-            ChessPiece op_copy("", false, Position(0,0), WHITE); // Dummy value
-
-            if (opponent_piece != nullptr) {
-                op_copy = *opponent_piece;
-                board.removePiece(opponent_piece);
-            }
+std::string GameManager::getPosition() const {
+    std::string notation(getMaxNotationLength(board), '\0');
+    notation.resize(writePosition(board, current_player, move_count, notation.data(), notation.size()));
+    return notation;
+}
 
-            bool og_used = piece->used;
-            board.movePiece(*piece, move);
-            bool check = isKingUnderCheck(current_player);
+bool GameManager::loadPosition(std::string_view notation) {
+    // Read into a copy, a position without kings can not be played
+    ChessBoard loaded(board);
+    team_t player;
+    int count;
+    if (!readPosition(notation, loaded, player, count)
+        || loaded.getKingOfTeam(WHITE) == nullptr || loaded.getKingOfTeam(BLACK) == nullptr)
+        return false;
+
+    board = loaded;
+    current_player = player;
+    move_count = count;
+    game_over = false;
+    winner = TIE;
+    turn_error = NO_ERROR;
+    checking_piece = nullptr;
+    witnesses[WHITE] = witnesses[BLACK] = Move();
 
-            // Rewind the piece
-            board.movePiece(*piece, og_pos);
-            piece->used = og_used;
-            if (opponent_piece != nullptr)
-                board.addPiece(op_copy);
+    history.clear();
+    history_start = move_count;
+    history_player = current_player;
+    game_log = nullptr;
+    reserveHistory();
 
-            // If legal move is found, break.
-            if (!check) {
-                move_check = false;
-                break;
-            }
+    checkGameOver();
+    return true;
+}
+
+std::shared_ptr<const PositionSnapshot> GameManager::getSnapshot() const {
+    return std::make_shared<const PositionSnapshot>(board, current_player, move_count, game_over, winner);
+}
+
+std::vector<Move> GameManager::getCandidateMoves() {
+    std::vector<Move> moves;
+
+    for (const ChessPiece& piece : board.getPiecesOfTeam(current_player))
+        validator.getMoves(piece, moves);
+
+    return moves;
+}
+
+bool GameManager::isMoveLegal(Move move) {
+    if (isGameOver())
+        return false;
+
+    ChessPiece* piece = board.getPieceAtPosition(move.from);
+    if (piece == nullptr || piece->team != current_player)
+        return false;
+
+    if (!validator.validateMove(*piece, move.to))
+        return false;
+
+    Position landing;
+    if (!validator.resolveLanding(*piece, move.to, landing))
+        return false;
+
+    return isLandingSafe(*piece, landing);
+}
+
+std::vector<bool> GameManager::areMovesLegal(std::span<const Move> moves) {
+    std::vector<bool> legal(moves.size(), false);
+    if (isGameOver())
+        return legal;
+
+    // Bursts list many moves of a piece in a row, its square is looked up once
+    std::vector<MoveQuery> queries;
+    queries.reserve(moves.size());
+    const ChessPiece* mover = nullptr;
+    for (std::size_t i = 0; i < moves.size(); i++) {
+        if (i == 0 || moves[i].from != moves[i - 1].from) {
+            mover = board.getPieceAtPosition(moves[i].from);
+            if (mover != nullptr && mover->team != current_player)
+                mover = nullptr;
         }
+        queries.push_back(MoveQuery{ mover, moves[i].to });
+    }
+    std::vector<bool> valid = validator.validateMoves(queries);
+
+    const ChessPiece* king = board.getKingOfTeam(current_player);
+    bool check = isKingUnderCheck(current_player);
+
+    // Only pieces on a line through the king may shield it. Those are lifted off
+    // the board once: if that uncovers no check, none of their moves does
+    std::vector<std::pair<const ChessPiece*, bool>> shields;
+    auto isShielding = [&](const ChessPiece& piece) {
+        int dx = piece.position.x - king->position.x;
+        int dy = piece.position.y - king->position.y;
+        if (dx != 0 && dy != 0 && std::abs(dx) != std::abs(dy))
+            return false;
+
+        for (const auto& [shield, shielding] : shields)
+            if (shield == &piece)
+                return shielding;
+
+        board.capturePiece(&piece);
+        bool shielding = isKingUnderCheck(current_player);
+        board.restorePiece();
+        shields.emplace_back(&piece, shielding);
+        return shielding;
+    };
+
+    for (std::size_t i = 0; i < moves.size(); i++) {
+        if (!valid[i])
+            continue;
+
+        ChessPiece& piece = *board.getPieceAtPosition(moves[i].from);
+        Position landing;
+        if (!validator.resolveLanding(piece, moves[i].to, landing))
+            continue;
+
+        if (check || piece.king_type || isShielding(piece))
+            legal[i] = isLandingSafe(piece, landing);
+        else
+            legal[i] = true;
     }
 
+    return legal;
+}
+
+bool GameManager::isLandingSafe(ChessPiece& piece, Position destination) {
+    return ::isLandingSafe(board, validator, piece, destination);
+}
+
+std::vector<Move> GameManager::getLegalMoves() {
+    std::vector<Move> moves;
+    if (isGameOver())
+        return moves;
+
+    std::uint64_t key = getStateHash();
+    if (move_cache->get(key, moves))
+        return moves;
+
+    for (const Move& move : getCandidateMoves())
+        if (isMoveLegal(move))
+            moves.push_back(move);
+
+    move_cache->put(key, moves);
+    return moves;
+}
+
+std::uint64_t GameManager::getStateHash() const {
+    return board.getPositionHash() ^ (current_player == WHITE ? 0 : 0x6a09e667f3bcc909ULL);
+}
+
+MoveCacheStats GameManager::getMoveCacheStats() const {
+    return move_cache->getStats();
+}
+
+std::size_t GameManager::getMemoryUsage() const {
+    std::size_t usage = sizeof(GameManager) + board.getHeapUsage() + move_cache->getHeapUsage()
+                      + scratch_moves.capacity() * sizeof(Move)
+                      + history.capacity() * sizeof(TurnRecord) + checkpoints.capacity() * sizeof(ChessBoard);
+    for (const ChessBoard& checkpoint : checkpoints)
+        usage += checkpoint.getHeapUsage();
+    return usage;
+}
+
+void GameManager::reserveHistory() {
+    std::size_t turns = move_limit > 0 ? static_cast<std::size_t>(move_limit) : HISTORY_RESERVE;
+    history.reserve(turns);
+
+    // Boards built for the ruleset reserve room for every capture, copying
+    // the current one in sizes the rest
+    checkpoints.reserve(turns / CHECKPOINT_INTERVAL);
+    while (checkpoints.size() < turns / CHECKPOINT_INTERVAL)
+        checkpoints.emplace_back(board.getRuleset());
+    for (ChessBoard& checkpoint : checkpoints)
+        checkpoint = board;
+    checkpoint_count = 0;
+}
+
+void GameManager::checkGameOver() {
     // If no legal move can be made, game is over.
-    if (move_check) {
+    if (!hasLegalMove()) {
         game_over = true;
-        if (!still_check) {
+        if (!isKingUnderCheck(current_player)) {
             winner = TIE;
         } else {
             winner = current_player == WHITE ? BLACK : WHITE;
@@ -98,17 +409,76 @@ void GameManager::checkGameOver() {
     }
 }
 
-bool GameManager::isKingUnderCheck(team_t team) {
-    const ChessPiece* king = board.getKingOfTeam(team);
+bool GameManager::hasLegalMove() {
+    // Positions repeat within a game and across the copies of a search
+    std::uint64_t key = getStateHash();
+    std::size_t legal_count;
+    if (move_cache->getMoveCount(key, legal_count))
+        return legal_count != 0;
+
+    std::atomic<std::uint64_t>& slot = (*legal_move_cache)[key % LEGAL_MOVE_CACHE_SIZE];
+    std::uint64_t entry = slot.load(std::memory_order_relaxed);
+    if (entry != 0 && (entry | 1) == (key | 1))
+        return entry & 1;
+
+    bool found = findLegalMove();
+    slot.store((key & ~1ULL) | found, std::memory_order_relaxed);
+    return found;
+}
+
+bool GameManager::findLegalMove() {
+    // The move found last turn mostly survives the opponent's reply
+    if (isMoveLegal(witnesses[current_player]))
+        return true;
+
+    // King moves are few & escape most checks, try them before the rest
+    ChessPiece* king = board.getKingOfTeam(current_player);
+    if (king != nullptr && findSafeMove(*king))
+        return true;
+
+    if (pool != nullptr && board.getPiecesOfTeam(current_player).size() >= parallel_min_pieces)
+        return findLegalMoveInParallel(king);
+
+    for (ChessPiece& piece : board.getPiecesOfTeam(current_player))
+        if (&piece != king && findSafeMove(piece))
+            return true;
+
+    return false;
+}
+
+bool GameManager::findLegalMoveInParallel(const ChessPiece* king) {
+    std::shared_ptr<ParallelSearch> search = std::make_shared<ParallelSearch>();
+    search->board = &board;
+    search->partition_count = pool->getWorkerCount() + 1;
+    for (const ChessPiece& piece : board.getPiecesOfTeam(current_player))
+        if (&piece != king)
+            search->pieces.push_back(board.getHandle(piece));
 
-    if (king == nullptr)
-        throw std::runtime_error("There is no king, which is impossible.");
+    // The caller searches as well, so a pool busy with other games cannot
+    // stall it. Only partitions already claimed need to be waited for
+    for (int i = 1; i < search->partition_count; i++)
+        pool->submit([search]() { runParallelSearch(*search); });
+    runParallelSearch(*search);
 
-    for (const ChessPiece& piece : board.getPieces()) {
-        if (validator.validateMove(piece, king->position)) {
-            checking_piece = &piece;
-            //std::cout << "king under check by " << checking_piece->type << std::endl;
-            //std::cout << "king under check from " << piece.position << "to" << king->position << std::endl;
+    std::unique_lock<std::mutex> lock(search->mutex);
+    search->done.wait(lock, [&]() { return search->finished_count == search->partition_count; });
+
+    if (!search->found)
+        return false;
+
+    witnesses[current_player] = search->witness;
+    return true;
+}
+
+bool GameManager::findSafeMove(ChessPiece& piece) {
+    // Check all possible moves of the piece, landing where portals send them
+    scratch_moves.clear();
+    validator.getMoves(piece, scratch_moves);
+
+    for (const Move& move : scratch_moves) {
+        // If legal move is found, keep it for the next turn.
+        if (isLandingSafe(piece, move.landing)) {
+            witnesses[current_player] = move;
             return true;
         }
     }
@@ -116,43 +486,51 @@ bool GameManager::isKingUnderCheck(team_t team) {
     return false;
 }
 
+bool GameManager::isKingUnderCheck(team_t team) {
+    const ChessPiece* piece = validator.findCheckingPiece(team);
+    if (piece == nullptr)
+        return false;
+
+    checking_piece = piece;
+    return true;
+}
+
 bool GameManager::playTurn(Position piece_position, Position destination) {
     ChessPiece* piece = board.getPieceAtPosition(piece_position);
     if (piece == nullptr) 
-        return withTurnError("No Piece at Position");
+        return withTurnError(NO_PIECE);
 
     return playTurn(*piece, destination);
 }
 
+bool GameManager::playTurn(Move move) {
+    return playTurn(move.from, move.to);
+}
+
 bool GameManager::playTurn(ChessPiece& piece, Position destination) {
     if (isGameOver()) 
-        return withTurnError("Game is Over");
-    
-    if (!validator.validateMove(piece, destination))
-        return withTurnError("Invalid Move");
-    
-    if (piece.team != current_player)
-        return withTurnError("Wrong Player");
+        return withTurnError(GAME_OVER);
 
     Position original_position = piece.position;
-
+    bool was_used = piece.used;
     Portal* portal = board.getPortalAtPosition(destination);
-    if (portal != nullptr) {
-        destination = portal->exit == destination ? portal->entry : portal->exit; // which way
 
-        if (!validator.validatePortalUse(piece, *portal))
-            return withTurnError("Portal is Unusable");
-    }
+    Position requested = destination;
+    if (!validator.validateMove(piece, destination))
+        return withTurnError(INVALID_MOVE);
 
-    ChessPiece* opponent_piece = board.getPieceAtPosition(destination);
-    ChessPiece op_copy("", false, Position(0,0), WHITE); // Dummy value
+    if (piece.team != current_player)
+        return withTurnError(WRONG_PLAYER);
 
+    if (!validator.resolveLanding(piece, destination, destination))
+        return withTurnError(PORTAL_UNUSABLE);
+
+    ChessPiece* opponent_piece = board.getPieceAtPosition(destination);
     if (opponent_piece != nullptr) {
         if (opponent_piece->team == current_player) 
             throw std::runtime_error("MoveValidator must have catched this");
 
-        op_copy = *opponent_piece;
-        board.removePiece(opponent_piece);
+        board.capturePiece(opponent_piece);
     }
 
     board.movePiece(piece, destination);
@@ -161,12 +539,17 @@ bool GameManager::playTurn(ChessPiece& piece, Position destination) {
         // Illegal move, rewind
         board.movePiece(piece, original_position);
         if (opponent_piece != nullptr) {
-            board.addPiece(op_copy);
+            board.restorePiece();
         }
-        return withTurnError("King Under Check! Reversed");
+        return withTurnError(KING_UNDER_CHECK);
     }
 
-    portal_system.decreaseCooldowns();
+    // Captured pieces stay on the board's stack, undo puts them back
+    TurnRecord record{ Move(original_position, requested, destination), board.getHandle(piece), was_used,
+                       opponent_piece != nullptr, portal != nullptr, false, TIE,
+                       portal != nullptr ? portal->ready_at : 0 };
+
+    portal_system.advanceClock();
 
     if (portal != nullptr)
         portal_system.startCooldown(portal->entry);
@@ -174,24 +557,154 @@ bool GameManager::playTurn(ChessPiece& piece, Position destination) {
     current_player = current_player == WHITE ? BLACK : WHITE;
     move_count++;
     checkGameOver();
+
+    // Turns taken back are replaced by this one
+    std::size_t turn = move_count - history_start;
+    history.resize(turn - 1);
+    checkpoint_count = std::min(checkpoint_count, (turn - 1) / CHECKPOINT_INTERVAL);
+
+    record.game_over = game_over;
+    record.winner = winner;
+    history.push_back(record);
+    if (turn % CHECKPOINT_INTERVAL == 0) {
+        if (checkpoint_count == checkpoints.size())
+            checkpoints.push_back(board);
+        else
+            checkpoints[checkpoint_count] = board;
+        checkpoint_count++;
+    }
+
+    if (game_over && game_log != nullptr)
+        game_log->append(*this);
     return true;
 }
 
+bool GameManager::undo() {
+    std::size_t turn = move_count - history_start;
+    if (turn == 0)
+        return false;
+
+    const TurnRecord& record = history[turn - 1];
+    ChessPiece& piece = board.getPiece(record.piece);
+    board.movePiece(piece, record.move.from);
+    piece.used = record.was_used;
+    if (record.captured)
+        board.restorePiece();
+
+    portal_system.rewindClock();
+    if (record.portal)
+        portal_system.rewindCooldown(record.move.to, record.portal_ready_at);
+
+    // Turns are only played in games which are not over
+    current_player = current_player == WHITE ? BLACK : WHITE;
+    move_count--;
+    game_over = false;
+    winner = TIE;
+    checking_piece = nullptr;
+    return true;
+}
+
+bool GameManager::redo() {
+    std::size_t turn = move_count - history_start;
+    if (turn == history.size())
+        return false;
+
+    const TurnRecord& record = history[turn];
+    if (record.captured)
+        board.capturePiece(board.getPieceAtPosition(record.move.landing));
+    board.movePiece(board.getPiece(record.piece), record.move.landing);
+
+    portal_system.advanceClock();
+    if (record.portal)
+        portal_system.startCooldown(record.move.to);
+
+    current_player = current_player == WHITE ? BLACK : WHITE;
+    move_count++;
+    game_over = record.game_over;
+    winner = record.winner;
+    checking_piece = nullptr;
+    return true;
+}
+
+bool GameManager::seek(int move_count) {
+    int target = move_count - history_start;
+    if (target < 0 || target > static_cast<int>(history.size()))
+        return false;
+
+    // Restore the checkpoint before or after the target if it is closer
+    int best = std::abs(this->move_count - history_start - target);
+    int best_checkpoint = 0;
+    for (int checkpoint : { target / CHECKPOINT_INTERVAL, target / CHECKPOINT_INTERVAL + 1 }) {
+        int distance = std::abs(checkpoint * CHECKPOINT_INTERVAL - target);
+        if (checkpoint >= 1 && checkpoint <= static_cast<int>(checkpoint_count) && distance < best) {
+            best = distance;
+            best_checkpoint = checkpoint;
+        }
+    }
+
+    if (best_checkpoint != 0) {
+        int turn = best_checkpoint * CHECKPOINT_INTERVAL;
+        board = checkpoints[best_checkpoint - 1];
+        current_player = turn % 2 == 0 ? history_player : (history_player == WHITE ? BLACK : WHITE);
+        this->move_count = history_start + turn;
+        game_over = history[turn - 1].game_over;
+        winner = history[turn - 1].winner;
+        checking_piece = nullptr;
+    }
+
+    while (this->move_count - history_start > target)
+        undo();
+    while (this->move_count - history_start < target)
+        redo();
+    return true;
+}
+
+std::vector<Move> GameManager::getHistory() const {
+    std::vector<Move> moves;
+    moves.reserve(history.size());
+    for (const TurnRecord& record : history)
+        moves.push_back(record.move);
+    return moves;
+}
+
+int GameManager::getHistoryStart() const {
+    return history_start;
+}
+
 void GameManager::playInteractively() {
     bool was_valid = true;
+    bool show_hint = false;
+
+    // Legal moves, the check status & a hint are worked out while the player types
+    Ponderer ponderer(*getRuleset());
+    ponderer.start(*this);
 
     while (!isGameOver()) {
-        std::set<Position> team_positions = board.getPositionsOfTeam(current_player);
-        board.printBoard(team_positions);
+        Move hint;
+        int hint_depth = 0;
+        bool has_hint = show_hint && ponderer.getHint(hint, hint_depth);
+        if (has_hint)
+            board.printBoard(std::set<Position>{ hint.from, hint.to });
+        else
+            board.printBoard(board.getPositionsOfTeam(current_player));
         std::cout << std::endl;
 
+        if (show_hint) {
+            if (has_hint)
+                std::cout << "=== Hint: " << hint << " (depth " << hint_depth << ") ===" << std::endl;
+            else
+                std::cout << "=== No hint yet ===" << std::endl;
+            std::cout << std::endl;
+            show_hint = false;
+        }
+
         if (!was_valid) {
             // Last error message
-            std::cout << "=== " << turn_error << " ===" << std::endl;
+            std::cout << "=== " << describeTurnError(turn_error) << " ===" << std::endl;
             std::cout << std::endl;
         }
 
-        if (isKingUnderCheck(current_player)) {
+        if (ponderer.isKingUnderCheck()) {
             std::cout << "=== " << "King is Under Check!" << " ===" << std::endl;
             std::cout << std::endl;
         }
@@ -199,34 +712,61 @@ void GameManager::playInteractively() {
         std::cout << "=== Move " << move_count + 1 << " ===" << std::endl;
         std::cout << "Turn: " << (current_player == WHITE ? "White" : "Black") << std::endl;
         
-        unsigned char x;
-        int y;
-        std::cout << "Select piece (cN): ";
-        std::cin >> x;
-        std::cin >> y;
-        if (std::cin.fail()) {
+        std::string square;
+        Position origin;
+        std::cout << "Select piece (cN), hint, undo, redo or goto N: ";
+        std::cin >> square;
+        if (!std::cin.fail() && square == "hint") {
+            show_hint = true;
+            was_valid = true;
+            continue;
+        }
+        if (!std::cin.fail() && (square == "undo" || square == "redo" || square == "goto")) {
+            int turn = 0;
+            if (square == "goto")
+                std::cin >> turn;
+
+            bool moved = !std::cin.fail() && (square == "undo" ? undo() : square == "redo" ? redo() : seek(turn));
+            if (std::cin.fail()) {
+                std::cin.clear();
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            }
+            if (!moved) {
+                turn_error = INVALID_INPUT;
+                was_valid = false;
+                continue;
+            }
+            ponderer.start(*this);
+            was_valid = true;
+            continue;
+        }
+        if (std::cin.fail() || parseSquare(square, origin) != square.size()) {
             std::cin.clear();
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            turn_error = "Invalid Input";
+            turn_error = INVALID_INPUT;
             was_valid = false;
             continue;
         }
 
-        ChessPiece* piece = board.getPieceAtPosition(Position(x - 'a', y - 1));
+        ChessPiece* piece = board.getPieceAtPosition(origin);
 
         if (piece == nullptr) {
-            turn_error = "No Piece at Position";
+            turn_error = NO_PIECE;
             was_valid = false;
             continue;
         }
 
         if (piece->team != current_player) {
-            turn_error = "That's Opponent's Piece";
+            turn_error = OPPONENT_PIECE;
             was_valid = false;
             continue;
         }
 
-        std::set<Position> moves = validator.getPossibleMoves(*piece);
+        // Listed in the background, playTurn still checks the chosen one in full
+        std::set<Position> moves;
+        for (const Move& move : ponderer.getLegalMoves())
+            if (move.from == piece->position)
+                moves.insert(move.to);
         std::set<Position> highlight = moves;
         highlight.insert(piece->position);
 
@@ -234,36 +774,38 @@ void GameManager::playInteractively() {
         board.printBoard(highlight);
         std::cout << std::endl;
 
-        std::cout << "=== Selected " << piece->type << " ===" << std::endl;
+        std::cout << "=== Selected " << board.getTypeName(*piece) << " ===" << std::endl;
 
         std::cout << "Possible Moves: ";
         for (const Position& move : moves) 
             std::cout << move << " ";
         std::cout << std::endl;
 
-        unsigned char dx;
-        int dy;
+        Position destination;
         std::cout << "Select destination (cN): ";
-        std::cin >> dx;
-        std::cin >> dy;
-        if (std::cin.fail()) {
+        std::cin >> square;
+        if (std::cin.fail() || parseSquare(square, destination) != square.size()) {
             std::cin.clear();
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            turn_error = "Invalid Input";
+            turn_error = INVALID_INPUT;
             was_valid = false;
             continue;
         }
         
         std::cout << std::endl;
 
-        was_valid = playTurn(*piece, Position(dx - 'a', dy - 1));
+        was_valid = playTurn(*piece, destination);
+        if (was_valid)
+            ponderer.start(*this);
     }
+    ponderer.stop();
 
-    if (checking_piece == nullptr)
-        throw std::runtime_error("Checking piece was not set");
-        
+    // A stalemate has no checking piece to show
     ChessPiece* king_piece = board.getKingOfTeam(current_player);
-    board.printBoard(std::set<Position>{checking_piece->position, king_piece->position});
+    std::set<Position> highlight{ king_piece->position };
+    if (const ChessPiece* checking = validator.findCheckingPiece(current_player))
+        highlight.insert(checking->position);
+    board.printBoard(highlight);
     std::cout << std::endl;
 
     std::cout << "=== Game Finished ===" << std::endl;
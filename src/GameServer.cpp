@@ -0,0 +1,491 @@
+#include "GameServer.hpp"
+#include "GameLog.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <sstream>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @brief Requests longer than this close the connection
+ */
+static constexpr std::size_t MAX_LINE_LENGTH = 64 * 1024;
+
+static const char* teamName(team_t team) {
+    return team == WHITE ? "white" : team == BLACK ? "black" : "tie";
+}
+
+GameServer::Session::Session(std::shared_ptr<const Ruleset> ruleset) : game(ruleset) { }
+
+GameServer::GameServer(int worker_count)
+                       : epoll_fd(epoll_create1(EPOLL_CLOEXEC))
+                       , wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+                       , running(true)
+                       , next_session_id(1)
+                       , pool(worker_count) {
+    if (epoll_fd < 0 || wake_fd < 0)
+        throw std::runtime_error("Failed to create event loop.");
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wake_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+}
+
+GameServer::~GameServer() {
+    for (auto& entry : connections) {
+        std::lock_guard<std::mutex> lock(entry.second->mutex);
+        entry.second->closed = true;
+        close(entry.first);
+    }
+
+    for (int fd : listen_fds)
+        close(fd);
+    if (!unix_path.empty())
+        unlink(unix_path.c_str());
+
+    close(wake_fd);
+    close(epoll_fd);
+}
+
+bool GameServer::addListener(int fd) {
+    if (listen(fd, SOMAXCONN) < 0) {
+        close(fd);
+        return false;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    listen_fds.push_back(fd);
+    return true;
+}
+
+bool GameServer::listenUnix(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path))
+        return false;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    unlink(path.c_str());
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close(fd);
+        return false;
+    }
+
+    unix_path = path;
+    return addListener(fd);
+}
+
+bool GameServer::listenTcp(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+
+    int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close(fd);
+        return false;
+    }
+
+    return addListener(fd);
+}
+
+void GameServer::run() {
+    epoll_event events[64];
+
+    while (running) {
+        int count = epoll_wait(epoll_fd, events, 64, -1);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error("Event loop failed.");
+        }
+
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+
+            if (fd == wake_fd) {
+                std::uint64_t value;
+                while (read(wake_fd, &value, sizeof(value)) > 0) { }
+                continue;
+            }
+
+            if (std::find(listen_fds.begin(), listen_fds.end(), fd) != listen_fds.end()) {
+                acceptConnections(fd);
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end())
+                continue;
+            std::shared_ptr<Connection> connection = it->second;
+
+            if (events[i].events & EPOLLOUT) {
+                bool answered;
+                {
+                    std::lock_guard<std::mutex> lock(connection->mutex);
+                    flushConnection(*connection);
+                    answered = isAnswered(*connection);
+                }
+                if (answered) {
+                    closeConnection(fd);
+                    continue;
+                }
+            }
+
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                readConnection(connection, events[i].events & (EPOLLHUP | EPOLLERR));
+        }
+    }
+}
+
+void GameServer::stop() {
+    running = false;
+    std::uint64_t value = 1;
+    if (write(wake_fd, &value, sizeof(value)) < 0) { }
+}
+
+void GameServer::acceptConnections(int listen_fd) {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        auto connection = std::make_shared<Connection>();
+        connection->fd = fd;
+        connections[fd] = connection;
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+void GameServer::readConnection(const std::shared_ptr<Connection>& connection, bool hangup) {
+    char buffer[4096];
+    bool end_of_input = false;
+    std::string received;
+
+    while (true) {
+        ssize_t length = read(connection->fd, buffer, sizeof(buffer));
+        if (length > 0) {
+            received.append(buffer, length);
+        } else {
+            end_of_input = length == 0;
+            hangup = hangup || (length < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+            break;
+        }
+    }
+
+    bool schedule = false;
+    bool answered = false;
+    {
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        connection->input += received;
+
+        // The client sends nothing more, a last line may lack its line break
+        if (end_of_input && !connection->input.empty() && connection->input.back() != '\n')
+            connection->input += '\n';
+
+        std::size_t start = 0, end;
+        while ((end = connection->input.find('\n', start)) != std::string::npos) {
+            std::string line = connection->input.substr(start, end - start);
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            connection->pending.push_back(std::move(line));
+            start = end + 1;
+        }
+        connection->input.erase(0, start);
+
+        if (connection->input.size() > MAX_LINE_LENGTH)
+            hangup = true;
+
+        if (!connection->busy && !connection->pending.empty()) {
+            connection->busy = true;
+            schedule = true;
+        }
+
+        // Stop reading, the connection closes once the pending requests are answered
+        if (end_of_input && !hangup && !connection->read_closed) {
+            connection->read_closed = true;
+            watchConnection(*connection);
+        }
+        answered = isAnswered(*connection);
+    }
+
+    if (schedule)
+        pool.submit([this, connection]() { processConnection(connection); });
+
+    if (hangup || answered)
+        closeConnection(connection->fd);
+}
+
+void GameServer::processConnection(const std::shared_ptr<Connection>& connection) {
+    while (true) {
+        std::string line;
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            if (connection->closed || connection->pending.empty()) {
+                connection->busy = false;
+                if (connection->read_closed)
+                    watchConnection(*connection);
+                return;
+            }
+            line = std::move(connection->pending.front());
+            connection->pending.pop_front();
+        }
+
+        std::string response = handleLine(line);
+
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        if (connection->closed) {
+            connection->busy = false;
+            return;
+        }
+        connection->output += response;
+        connection->output += '\n';
+        flushConnection(*connection);
+    }
+}
+
+void GameServer::flushConnection(Connection& connection) {
+    if (connection.closed)
+        return;
+
+    while (!connection.output.empty()) {
+        ssize_t length = send(connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL);
+        if (length > 0) {
+            connection.output.erase(0, length);
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break; // Continue once the socket is writable again
+        } else {
+            return; // Hangup is noticed by the event loop
+        }
+    }
+
+    watchConnection(connection);
+}
+
+void GameServer::watchConnection(Connection& connection) {
+    if (connection.closed)
+        return;
+
+    // A writable socket wakes the loop, which then closes an answered connection
+    epoll_event event{};
+    if (!connection.read_closed)
+        event.events |= EPOLLIN;
+    if (!connection.output.empty() || isAnswered(connection))
+        event.events |= EPOLLOUT;
+    event.data.fd = connection.fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, connection.fd, &event);
+}
+
+bool GameServer::isAnswered(const Connection& connection) {
+    return connection.read_closed && !connection.busy && connection.pending.empty() && connection.output.empty();
+}
+
+void GameServer::closeConnection(int fd) {
+    auto it = connections.find(fd);
+    if (it == connections.end())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(it->second->mutex);
+        it->second->closed = true;
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+    }
+    connections.erase(it);
+}
+
+bool GameServer::addConfig(const std::string& config_path) {
+    auto ruleset = Ruleset::load(config_path);
+    if (ruleset == nullptr)
+        return false;
+
+    if (default_ruleset == nullptr)
+        default_ruleset = ruleset;
+    rulesets.push_back(ruleset);
+
+    // An earlier config keeps a file name both share
+    configs.emplace(config_path, ruleset);
+    configs.emplace(config_path.substr(config_path.find_last_of('/') + 1), ruleset);
+    return true;
+}
+
+std::shared_ptr<const Ruleset> GameServer::getRuleset(const std::string& config) const {
+    // Configs are only added before serving, so lookups need no lock
+    if (config.empty())
+        return default_ruleset;
+
+    auto it = configs.find(config);
+    return it == configs.end() ? nullptr : it->second;
+}
+
+void GameServer::setGameLog(std::shared_ptr<GameLog> log) {
+    game_log = std::move(log);
+}
+
+std::shared_ptr<GameServer::Session> GameServer::findSession(const std::string& id) {
+    std::uint64_t session_id = std::strtoull(id.c_str(), nullptr, 10);
+
+    std::shared_lock<std::shared_mutex> lock(sessions_mutex);
+    auto it = sessions.find(session_id);
+    return it == sessions.end() ? nullptr : it->second;
+}
+
+std::string GameServer::handleLine(const std::string& line) {
+    std::istringstream args(line);
+    std::string command, id;
+    args >> command;
+
+    try {
+        if (command == "PING")
+            return "OK PONG";
+
+        if (command == "STATS")
+            return handleStats();
+
+        if (command == "NEW") {
+            std::string config;
+            args >> config;
+
+            std::shared_ptr<const Ruleset> ruleset = getRuleset(config);
+            if (ruleset == nullptr)
+                return "ERR unknown config";
+
+            auto session = std::make_shared<Session>(ruleset);
+            session->game.setGameLog(game_log);
+            std::unique_lock<std::shared_mutex> lock(sessions_mutex);
+            std::uint64_t session_id = next_session_id++;
+            sessions[session_id] = session;
+            return "OK " + std::to_string(session_id);
+        }
+
+        args >> id;
+        if (command == "CLOSE") {
+            std::shared_ptr<Session> session;
+            {
+                std::unique_lock<std::shared_mutex> lock(sessions_mutex);
+                auto it = sessions.find(std::strtoull(id.c_str(), nullptr, 10));
+                if (it == sessions.end())
+                    return "ERR unknown session";
+                session = std::move(it->second);
+                sessions.erase(it);
+            }
+
+            // Finished games were logged by their last turn
+            if (game_log != nullptr) {
+                std::lock_guard<std::mutex> lock(session->mutex);
+                if (!session->game.isGameOver())
+                    game_log->append(session->game);
+            }
+            return "OK";
+        }
+
+        if (command != "MOVE" && command != "MOVES" && command != "STATE")
+            return "ERR unknown command";
+
+        std::shared_ptr<Session> session = findSession(id);
+        if (session == nullptr)
+            return "ERR unknown session";
+
+        std::lock_guard<std::mutex> lock(session->mutex);
+        GameManager& game = session->game;
+
+        if (command == "MOVE") {
+            std::string text;
+            Move move;
+            args >> text;
+            if (!parseMove(text, move))
+                return "ERR Invalid Input";
+
+            auto start = std::chrono::steady_clock::now();
+            bool played = game.playTurn(move);
+            turn_latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+
+            if (!played)
+                return "ERR " + game.getTurnError();
+            if (game.isGameOver())
+                return std::string("OK GAMEOVER ") + teamName(game.getWinner());
+            return "OK";
+        }
+
+        if (command == "MOVES") {
+            std::ostringstream response;
+            response << "OK";
+            for (const Move& move : game.getLegalMoves())
+                response << " " << move;
+            return response.str();
+        }
+
+        if (command == "STATE") {
+            std::ostringstream response;
+            response << "OK " << teamName(game.getCurrentPlayer()) << " " << game.getMoveCount() << " "
+                     << (game.isGameOver() ? teamName(game.getWinner()) : "running");
+            return response.str();
+        }
+    } catch (const std::exception& e) {
+        return std::string("ERR ") + e.what();
+    }
+
+    return "ERR unknown command";
+}
+
+std::string GameServer::handleStats() {
+    std::vector<std::shared_ptr<Session>> snapshot;
+    {
+        std::shared_lock<std::shared_mutex> lock(sessions_mutex);
+        snapshot.reserve(sessions.size());
+        for (const auto& entry : sessions)
+            snapshot.push_back(entry.second);
+    }
+
+    // Configs are shared between sessions, so they are not part of a session's footprint
+    std::size_t total_bytes = 0;
+    for (const auto& session : snapshot) {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        total_bytes += sizeof(Session) + session->game.getMemoryUsage() - sizeof(GameManager);
+    }
+
+    std::ostringstream response;
+    response << "OK sessions=" << snapshot.size()
+             << " configs=" << rulesets.size()
+             << " session_bytes=" << (snapshot.empty() ? 0 : total_bytes / snapshot.size())
+             << " turns=" << turn_latency.getCount()
+             << " p50_us=" << turn_latency.getPercentile(50) / 1000.0
+             << " p99_us=" << turn_latency.getPercentile(99) / 1000.0;
+    return response.str();
+}
+
+std::size_t GameServer::getSessionCount() {
+    std::shared_lock<std::shared_mutex> lock(sessions_mutex);
+    return sessions.size();
+}
@@ -0,0 +1,61 @@
+#include "LatencyHistogram.hpp"
+
+#include <bit>
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+int LatencyHistogram::bucketOf(std::uint64_t value) {
+    if (value < LINEAR_BUCKETS)
+        return static_cast<int>(value);
+
+    int exponent = std::bit_width(value) - 1; // At least 4
+    int sub = static_cast<int>((value >> (exponent - 3)) & (SUB_BUCKETS - 1));
+    return LINEAR_BUCKETS + (exponent - 4) * SUB_BUCKETS + sub;
+}
+
+std::uint64_t LatencyHistogram::bucketMidpoint(int bucket) {
+    if (bucket < LINEAR_BUCKETS)
+        return bucket;
+
+    int exponent = (bucket - LINEAR_BUCKETS) / SUB_BUCKETS + 4;
+    int sub = (bucket - LINEAR_BUCKETS) % SUB_BUCKETS;
+    std::uint64_t width = std::uint64_t(1) << (exponent - 3);
+    return (SUB_BUCKETS + sub) * width + width / 2;
+}
+
+void LatencyHistogram::record(std::uint64_t nanoseconds) {
+    buckets[bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::getPercentile(double percentile) const {
+    std::uint64_t total = getCount();
+    if (total == 0)
+        return 0;
+
+    // Rank of the wanted sample, 1-based
+    std::uint64_t rank = static_cast<std::uint64_t>(percentile / 100.0 * total + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > total) rank = total;
+
+    std::uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return bucketMidpoint(i);
+    }
+
+    return bucketMidpoint(BUCKET_COUNT - 1);
+}
+
+std::uint64_t LatencyHistogram::getCount() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+}
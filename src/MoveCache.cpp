@@ -0,0 +1,84 @@
+#include "MoveCache.hpp"
+
+MoveCache::MoveCache(std::size_t capacity)
+                     : capacity(capacity == 0 ? 1 : capacity), hand(0), hits(0), misses(0) { }
+
+MoveCache::Slot* MoveCache::touch(std::uint64_t key) {
+    auto it = index.find(key);
+    if (it == index.end()) {
+        misses++;
+        return nullptr;
+    }
+
+    hits++;
+    Slot& slot = slots[it->second];
+    slot.referenced = true;
+    return &slot;
+}
+
+bool MoveCache::get(std::uint64_t key, std::vector<Move>& moves) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Slot* slot = touch(key);
+    if (slot == nullptr)
+        return false;
+
+    moves = slot->moves;
+    return true;
+}
+
+bool MoveCache::getMoveCount(std::uint64_t key, std::size_t& count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Slot* slot = touch(key);
+    if (slot == nullptr)
+        return false;
+
+    count = slot->moves.size();
+    return true;
+}
+
+void MoveCache::put(std::uint64_t key, const std::vector<Move>& moves) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+        slots[it->second].moves = moves;
+        slots[it->second].referenced = true;
+        return;
+    }
+
+    if (slots.size() < capacity) {
+        index[key] = slots.size();
+        slots.push_back(Slot{ key, false, moves });
+        return;
+    }
+
+    // Give referenced slots a second chance, evict the first one which was not
+    while (slots[hand].referenced) {
+        slots[hand].referenced = false;
+        hand = (hand + 1) % slots.size();
+    }
+
+    Slot& victim = slots[hand];
+    index.erase(victim.key);
+    index[key] = hand;
+    victim.key = key;
+    victim.moves = moves;
+    hand = (hand + 1) % slots.size();
+}
+
+MoveCacheStats MoveCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return MoveCacheStats{ hits, misses, slots.size(), capacity };
+}
+
+std::size_t MoveCache::getHeapUsage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Map nodes hold the next link & cached hash next to the element
+    std::size_t usage = slots.capacity() * sizeof(Slot) + index.bucket_count() * sizeof(void*)
+                      + index.size() * (sizeof(std::pair<const std::uint64_t, std::size_t>) + 2 * sizeof(void*));
+    for (const Slot& slot : slots)
+        usage += slot.moves.capacity() * sizeof(Move);
+
+    return usage;
+}
@@ -1,96 +1,185 @@
 #include "GameManager.hpp"
 
-MoveValidator::MoveValidator(const ChessBoard& board,
-                             const std::vector<PieceConfig>& piece_configs) 
-                             : board(board) {
-    for(auto &piece_config : piece_configs) {
-        rules[piece_config.type] = piece_config.movement;
-    }
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+
+#ifdef CHESS_VARIANT
+#include "VariantRules.hpp"
+#endif
+
+MoveValidator::MoveValidator(const ChessBoard& board, bool specialize)
+                             : board(board), ruleset(*board.getRuleset()), specialization(0),
+                               compiled(false) {
+    for (int size : SPECIALIZED_SIZES)
+        if (specialize && size == board.getSize())
+            specialization = size;
+
+#ifdef CHESS_VARIANT
+    compiled = specialize && VariantRules::matches(ruleset);
+#endif
+
+    if (board.getSize() <= Bitboard256::WIDTH)
+        board_mask = Bitboard256::getBoardMask(board.getSize());
 }
 
-#define PUSH_IF_VALID(p,x) if (validateMove(p, x)) moves.insert(x);
-std::set<Position> MoveValidator::getPossibleMoves(const ChessPiece& piece) {
-    std::set<Position> moves;
-    Position origin = piece.position;
-    MovementRules rule = rules[piece.type];
-
-    if (rule.forward == -1) {
-        for (int i = 0; i < board.getSize(); i++)
-            PUSH_IF_VALID(piece, Position(origin.x, i)); // Vertical, same as BW
-    } else {
-        PUSH_IF_VALID(piece, Position(origin.x, origin.y + rule.forward)); // White
-        PUSH_IF_VALID(piece, Position(origin.x, origin.y - rule.forward)); // Black
-    }
+bool MoveValidator::isSpecialized() const {
+    return specialization != 0;
+}
 
-    if (rule.first_move_forward == -1) {
-        for (int i = 0; i < board.getSize(); i++)
-            PUSH_IF_VALID(piece, Position(origin.x, i)); // Vertical, same as FW
-    } else {
-        PUSH_IF_VALID(piece, Position(origin.x, origin.y + rule.first_move_forward)); // White
-        PUSH_IF_VALID(piece, Position(origin.x, origin.y - rule.first_move_forward)); // Black
-    }
+bool MoveValidator::isCompiled() const {
+    return compiled;
+}
 
-    if (rule.backward == -1) {
-        for (int i = 0; i < board.getSize(); i++)
-            PUSH_IF_VALID(piece, Position(origin.x, i)); // Vertical, same as FW
-    } else {
-        PUSH_IF_VALID(piece, Position(origin.x, origin.y - rule.backward)); // White
-        PUSH_IF_VALID(piece, Position(origin.x, origin.y + rule.backward)); // Black
-    }
+bool MoveValidator::hasAttackMaps() const {
+    return board.getSize() >= ATTACK_MAP_MIN_SIZE && board.getSize() <= Bitboard256::WIDTH
+        && static_cast<int>(ruleset.getPieceTypes().size()) <= ATTACK_MAP_TYPE_LIMIT;
+}
+
+template <typename Function>
+auto MoveValidator::withRules(Function&& function) const {
+#ifdef CHESS_VARIANT
+    if (compiled)
+        return function(BoardGeometry<VariantRules::BOARD_SIZE>(), VariantRules());
+#endif
 
-    if (rule.sideways == -1) {
-        for (int i = 0; i < board.getSize(); i++)
-            PUSH_IF_VALID(piece, Position(i, origin.y)); // Horizontal
-    } else {
-        PUSH_IF_VALID(piece, Position(origin.x + rule.sideways, origin.y)); // Both
-        PUSH_IF_VALID(piece, Position(origin.x - rule.sideways, origin.y)); // Both
+    InterpretedRules rules(ruleset);
+    switch (specialization) {
+    case 8:  return function(BoardGeometry<8>(), rules);
+    case 10: return function(BoardGeometry<10>(), rules);
+    case 16: return function(BoardGeometry<16>(), rules);
+    default: return function(GenericGeometry(board.getSize()), rules);
     }
+}
+
+template <typename Geometry, typename Rules, typename Visit>
+void MoveValidator::forEachTarget(const Geometry& geometry, const Rules& rules,
+                                  const ChessPiece& piece, Visit&& visit) const {
+    Position origin = piece.position;
+    int direction = piece.team == BLACK ? -1 : 1;
+
+    for (const MovePattern& pattern : rules.getPatterns(piece.type_id)) {
+        if (pattern.first_move && piece.used)
+            continue;
 
-    if (rule.diagonal == -1) {
-        for (int i = 0; i < board.getSize(); i++) {
-            PUSH_IF_VALID(piece, Position(origin.x - origin.y + i, i)); // R Diagonal
-            PUSH_IF_VALID(piece, Position(origin.x + origin.y - i, i)); // L Diagonal
+        int dx = pattern.dx;
+        int dy = pattern.dy * direction;
 
+        if (pattern.distance != 0) {
+            Position target(origin.x + dx * pattern.distance, origin.y + dy * pattern.distance);
+            if (checkMove(geometry, rules, piece, target))
+                visit(target);
+            continue;
         }
-    } else {
-        PUSH_IF_VALID(piece, Position(origin.x + rule.diagonal, origin.y + rule.diagonal));
-        PUSH_IF_VALID(piece, Position(origin.x + rule.diagonal, origin.y - rule.diagonal));
-        PUSH_IF_VALID(piece, Position(origin.x - rule.diagonal, origin.y + rule.diagonal));
-        PUSH_IF_VALID(piece, Position(origin.x - rule.diagonal, origin.y - rule.diagonal));
-    }
 
-    if (rule.diagonal_capture == -1) {
-        for (int i = 0; i < board.getSize(); i++) {
-            PUSH_IF_VALID(piece, Position(origin.x - origin.y + i, i)); // R Diagonal
-            PUSH_IF_VALID(piece, Position(origin.x + origin.y - i, i)); // L Diagonal
+        // Any distance, walk up to the board edge or up to & including the first blocker
+        int steps = geometry.getEdgeDistance(origin, getDirection(dx, dy));
+        Position blocker;
+        if (board.findFirstBlocker(origin, dx, dy, blocker))
+            steps = std::max(std::abs(blocker.x - origin.x), std::abs(blocker.y - origin.y));
 
+        for (int step = 1; step <= steps; step++) {
+            Position target(origin.x + dx * step, origin.y + dy * step);
+            if (checkMove(geometry, rules, piece, target))
+                visit(target);
         }
-    } else {
-        PUSH_IF_VALID(piece, Position(origin.x + rule.diagonal_capture, origin.y + rule.diagonal_capture));
-        PUSH_IF_VALID(piece, Position(origin.x + rule.diagonal_capture, origin.y - rule.diagonal_capture));
-        PUSH_IF_VALID(piece, Position(origin.x - rule.diagonal_capture, origin.y + rule.diagonal_capture));
-        PUSH_IF_VALID(piece, Position(origin.x - rule.diagonal_capture, origin.y - rule.diagonal_capture));
     }
+}
+
+std::set<Position> MoveValidator::getPossibleMoves(const ChessPiece& piece) const {
+    std::set<Position> moves;
+    withRules([&](const auto& geometry, const auto& rules) {
+        forEachTarget(geometry, rules, piece, [&](Position target) { moves.insert(target); });
+    });
+    return moves;
+}
+
+void MoveValidator::getMoves(const ChessPiece& piece, std::vector<Move>& moves) const {
+    // Patterns are pruned when compiled, only a first move may reach a square twice
+    bool overlaps = !piece.used && ruleset.getPieceType(piece.type_id).first_move_overlaps;
+
+    withRules([&](const auto& geometry, const auto& rules) {
+        std::size_t first = moves.size();
+
+        forEachTarget(geometry, rules, piece, [&](Position target) {
+            Position landing;
+            if (!resolveLanding(piece, target, landing))
+                return;
 
-    if (rule.l_shape) {
-        PUSH_IF_VALID(piece, Position(origin.x + 2, origin.y + 1));
-        PUSH_IF_VALID(piece, Position(origin.x + 2, origin.y - 1));
-        PUSH_IF_VALID(piece, Position(origin.x - 2, origin.y + 1));
-        PUSH_IF_VALID(piece, Position(origin.x - 2, origin.y - 1));
-        PUSH_IF_VALID(piece, Position(origin.x + 1, origin.y + 2));
-        PUSH_IF_VALID(piece, Position(origin.x + 1, origin.y - 2));
-        PUSH_IF_VALID(piece, Position(origin.x - 1, origin.y + 2));
-        PUSH_IF_VALID(piece, Position(origin.x - 1, origin.y - 2));
+            for (std::size_t i = first; overlaps && i < moves.size(); i++)
+                if (moves[i].to == target)
+                    return;
+
+            moves.emplace_back(piece.position, target, landing);
+        });
+    });
+}
+
+bool MoveValidator::resolveLanding(const ChessPiece& piece, Position target, Position& landing) const {
+    const PortalTransition* transition = board.getTransition(target);
+    if (transition == nullptr) {
+        landing = target;
+        return true;
     }
 
-    return moves;
+    if (!validatePortalUse(piece, board.getPortals()[transition->portal]))
+        return false;
+
+    // The exit must not hold a piece of the same team, the moving one included.
+    // Kings are never taken, check detection does not look through portals
+    const ChessPiece* occupant = board.getPieceAtPosition(transition->landing);
+    if (occupant != nullptr && (occupant->team == piece.team || occupant->king_type))
+        return false;
+
+    landing = transition->landing;
+    return true;
+}
+
+bool MoveValidator::validateMove(const ChessPiece& piece, Position destination) const {
+    return withRules([&](const auto& geometry, const auto& rules) {
+        return checkMove(geometry, rules, piece, destination);
+    });
+}
+
+std::vector<bool> MoveValidator::validateMoves(std::span<const MoveQuery> queries) const {
+    std::vector<bool> valid(queries.size(), false);
+    std::vector<Position> targets;
+
+    withRules([&](const auto& geometry, const auto& rules) {
+        std::size_t end;
+        for (std::size_t begin = 0; begin < queries.size(); begin = end) {
+            const ChessPiece* piece = queries[begin].piece;
+            end = begin + 1;
+            while (end < queries.size() && queries[end].piece == piece)
+                end++;
+
+            if (piece == nullptr)
+                continue;
+
+            if (end - begin < TARGET_LIST_MIN_QUERIES) {
+                for (std::size_t i = begin; i < end; i++)
+                    valid[i] = checkMove(geometry, rules, *piece, queries[i].destination);
+                continue;
+            }
+
+            // Long runs of one piece, as from hover previews, list its targets once
+            targets.clear();
+            forEachTarget(geometry, rules, *piece, [&](Position target) { targets.push_back(target); });
+            std::sort(targets.begin(), targets.end());
+            for (std::size_t i = begin; i < end; i++)
+                valid[i] = std::binary_search(targets.begin(), targets.end(), queries[i].destination);
+        }
+    });
+
+    return valid;
 }
-#undef PUSH_IF_VALID
 
-bool MoveValidator::validateMove(const ChessPiece& piece, Position destination) {
+template <typename Geometry, typename Rules>
+bool MoveValidator::checkMove(const Geometry& geometry, const Rules& rules,
+                              const ChessPiece& piece, Position destination) const {
     // Check 0: Out of bounds
-    if (destination.x >= board.getSize() || destination.y >= board.getSize()
-        || destination.x < 0 || destination.y < 0)
+    if (!geometry.contains(destination))
         return false;
 
     const ChessPiece* opponent = board.getPieceAtPosition(destination);
@@ -103,77 +192,94 @@ bool MoveValidator::validateMove(const ChessPiece& piece, Position destination)
 
     // Check 2: Validate path
     Position origin = piece.position;
-    MovementRules rule = rules[piece.type];
-
     int dx = destination.x - origin.x;
     int dy = destination.y - origin.y;
 
     if (piece.team == BLACK) dy = -dy;
 
-    if (dx == 0 && dy == 0) {
-        // No movement
-        return false;
-    }
-    else if (abs(dx) == abs(dy)) {
-        // Diagonal
-        bool valid = false;
-        if (rule.diagonal == -1 || rule.diagonal == abs(dx))
-            valid = true;
-        if (opponent != nullptr && dy > 0 // Diagonal cap. requires forward
-            && (rule.diagonal_capture == -1 || rule.diagonal_capture == abs(dx)))
-            valid = true;
-        if (!valid) return false;
-    }
-    else if (dy == 0) {
-        // Horizontal
-        if (rule.sideways != -1 && rule.sideways != abs(dx))
-            return false;
-    }
-    else if (dx == 0 && dy > 0) {
-        // Forward
-        if (piece.type == "pawn" && opponent != nullptr)
-            return false;
-            
-        bool valid = false;
-        if (rule.forward == -1 || rule.forward == dy)
-            valid = true;
-        if (!piece.used && (rule.first_move_forward == -1 || rule.first_move_forward == dy))
-            valid = true;
-        if (!valid) return false;
-    }
-    else if (dx == 0 && dy < 0) {
-        // Backward
-        if (rule.backward != -1 && rule.backward != -dy)
-            return false;
-    }
-    else if ((abs(dx) == 1 && abs(dy) == 2) || (abs(dx) == 2 && abs(dy) == 1)) {
-        // L-shape
-        if (rule.l_shape)
-            return true;
-        else
-            return false;
-    }
-    else {
-        // Invalid
-        return false;
-    }
+    MoveShape shape = rules.checkShape(piece.type_id, dx, dy, opponent != nullptr, piece.used);
+    if (shape != PATH_SHAPE)
+        return shape == LEAP_SHAPE;
 
     // Check 3: Obstacle on path
-    int range = std::max(std::abs(dx), std::abs(dy));
-    for (int i = 1; i < range; i++) {
-        int x = (destination.x - origin.x) / range * i + origin.x;
-        int y = (destination.y - origin.y) / range * i + origin.y;
-        if (board.getPieceAtPosition(Position(x, y)) != nullptr)
-            return false;
-    }
-    
-    return true;
+    return board.isPathClear(origin, destination);
 }
 
-bool MoveValidator::validatePortalUse(const ChessPiece& piece, Portal& portal) {
-    if (portal.current_cooldown == 0 && 
+bool MoveValidator::validatePortalUse(const ChessPiece& piece, const Portal& portal) const {
+    if (board.getPortalCooldown(portal) == 0 && 
         ((portal.black_allowed && piece.team == BLACK) || (portal.white_allowed && piece.team == WHITE)))
         return true;
     else
         return false;
-}
\ No newline at end of file
+}
+
+bool MoveValidator::getTeamAttacks(team_t team, Bitboard256& attacks) const {
+    int size = board.getSize();
+    int type_count = static_cast<int>(ruleset.getPieceTypes().size());
+    if (size > Bitboard256::WIDTH || type_count > ATTACK_MAP_TYPE_LIMIT)
+        return false;
+
+    // Ranks are 16-bit lanes of the bitboard
+    Bitboard256 empty = board_mask;
+    for (int y = 0; y < size; y++)
+        empty.words[y / 4] &= ~(board.getRankOccupancy(y) << (y % 4 * Bitboard256::WIDTH));
+
+    // Pieces of a type move alike, first move patterns only apply to unused ones
+    Bitboard256 type_origins[ATTACK_MAP_TYPE_LIMIT];
+    Bitboard256 unused_origins[ATTACK_MAP_TYPE_LIMIT];
+    std::uint64_t present = 0;
+    for (const ChessPiece& piece : board.getPiecesOfTeam(team)) {
+        std::uint64_t bit = std::uint64_t(1) << piece.type_id;
+        if (!(present & bit)) {
+            present |= bit;
+            type_origins[piece.type_id] = {};
+            unused_origins[piece.type_id] = {};
+        }
+        type_origins[piece.type_id].set(piece.position);
+        if (!piece.used)
+            unused_origins[piece.type_id].set(piece.position);
+    }
+
+    // A kernel call per pattern of each type, merging equal patterns of
+    // different types costs more than the calls it saves
+    const AttackKernels& kernels = AttackKernels::get();
+    attacks = {};
+    for (; present != 0; present &= present - 1) {
+        int type_id = std::countr_zero(present);
+        const PieceType& type = ruleset.getPieceType(type_id);
+
+        for (const MovePattern& pattern : type.patterns) {
+            const Bitboard256& origins = pattern.first_move ? unused_origins[type_id] : type_origins[type_id];
+            if (pattern.distance >= size || origins.isEmpty())
+                continue;
+            if (pattern.dx == 0 && pattern.dy > 0 && !type.forward_captures)
+                continue;
+
+            int dy = team == BLACK ? -pattern.dy : pattern.dy;
+            if (pattern.distance == 0)
+                attacks |= kernels.slide(origins, empty, board_mask, pattern.dx, dy);
+            else
+                attacks |= kernels.step(origins, empty, board_mask, pattern.dx, dy, pattern.distance);
+        }
+    }
+
+    return true;
+}
+
+const ChessPiece* MoveValidator::findCheckingPiece(team_t team) const {
+    const ChessPiece* king = board.getKingOfTeam(team);
+    if (king == nullptr)
+        throw std::runtime_error("There is no king, which is impossible.");
+
+    // Most positions are not in check, the checking piece is only looked for when one is
+    Bitboard256 attacks;
+    if (hasAttackMaps() && getTeamAttacks(team == WHITE ? BLACK : WHITE, attacks)
+        && !attacks.test(king->position))
+        return nullptr;
+
+    for (const ChessPiece& piece : board.getPieces())
+        if (validateMove(piece, king->position))
+            return &piece;
+
+    return nullptr;
+}
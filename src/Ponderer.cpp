@@ -0,0 +1,100 @@
+#include "Ponderer.hpp"
+
+Ponderer::Ponderer(const Ruleset& ruleset)
+                   : engine(ruleset), stop_flag(false), moves_ready(false), check(false)
+                   , has_hint(false), hint_depth(0) { }
+
+Ponderer::~Ponderer() {
+    stop();
+}
+
+void Ponderer::start(const GameManager& game) {
+    stop();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        moves_ready = false;
+        legal_moves.clear();
+        check = false;
+        error = nullptr;
+        has_hint = false;
+        hint_depth = 0;
+    }
+
+    stop_flag = false;
+    auto position = std::make_shared<GameManager>(game);
+    worker = std::thread(&Ponderer::analyse, this, position);
+}
+
+void Ponderer::stop() {
+    stop_flag = true;
+    if (worker.joinable())
+        worker.join();
+}
+
+std::vector<Move> Ponderer::getLegalMoves() {
+    std::unique_lock<std::mutex> lock(mutex);
+    listed.wait(lock, [this]() { return moves_ready; });
+    if (error != nullptr)
+        std::rethrow_exception(error);
+    return legal_moves;
+}
+
+bool Ponderer::isKingUnderCheck() {
+    std::unique_lock<std::mutex> lock(mutex);
+    listed.wait(lock, [this]() { return moves_ready; });
+    if (error != nullptr)
+        std::rethrow_exception(error);
+    return check;
+}
+
+bool Ponderer::getHint(Move& hint, int& depth) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (error != nullptr)
+        std::rethrow_exception(error);
+    if (!has_hint)
+        return false;
+
+    hint = this->hint;
+    depth = hint_depth;
+    return true;
+}
+
+void Ponderer::analyse(std::shared_ptr<GameManager> game) {
+    // The selection prompt waits on these, so they are never cut short. An
+    // exception escaping the worker would end the program, the prompt gets it
+    std::vector<Move> moves;
+    bool under_check = false;
+    std::exception_ptr listing_error;
+    try {
+        moves = game->getLegalMoves();
+        under_check = game->isKingUnderCheck(game->getCurrentPlayer());
+    } catch (...) {
+        listing_error = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        legal_moves = std::move(moves);
+        check = under_check;
+        error = listing_error;
+        moves_ready = true;
+    }
+    listed.notify_all();
+
+    if (stop_flag || legal_moves.empty())
+        return;
+
+    // A failed search reaches the prompt like a failed listing, on its next query
+    try {
+        engine.search(*game, SearchLimits{}, stop_flag, [this](const SearchResult& info) {
+            std::lock_guard<std::mutex> lock(mutex);
+            has_hint = true;
+            hint = info.best_move;
+            hint_depth = info.depth;
+        });
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = std::current_exception();
+    }
+}
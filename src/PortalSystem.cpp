@@ -2,35 +2,37 @@
 
 #include <iostream>
 #include <exception>
-#include <algorithm>
 
 PortalSystem::PortalSystem(ChessBoard& board,
                            const std::vector<PortalConfig>& portal_configs)
                            : board(board) {
     
-    for (const PortalConfig& portal_config : portal_configs) {
-        auto &ac = portal_config.properties.allowed_colors;
-        Portal portal(portal_config.id,
-                      portal_config.positions.entry,
-                      portal_config.positions.exit, 
-                      !portal_config.properties.preserve_direction,
-                      std::find(ac.begin(), ac.end(), "white") != ac.end(), 
-                      std::find(ac.begin(), ac.end(), "black") != ac.end(), 
-                      portal_config.properties.cooldown);
-        board.addPortal(portal);
-    }
+    for (const PortalConfig& portal_config : portal_configs)
+        board.addPortal(Ruleset::compilePortal(portal_config));
 }
 
+PortalSystem::PortalSystem(ChessBoard& board) : board(board) { }
+
 void PortalSystem::startCooldown(Position position) {
     Portal* portal = board.getPortalAtPosition(position);
     if (portal == nullptr)
         throw std::runtime_error("startCooldown called on null portal");
 
-    portal->current_cooldown = portal->cooldown;
+    portal->ready_at = board.getPortalClock() + portal->cooldown;
+}
+
+void PortalSystem::advanceClock() {
+    board.advancePortalClock();
+}
+
+void PortalSystem::rewindClock() {
+    board.rewindPortalClock();
 }
 
-void PortalSystem::decreaseCooldowns() {
-    for (Portal& portal : board.getPortals()) {
-        if (portal.current_cooldown > 0) portal.current_cooldown--;
-    }
-}
\ No newline at end of file
+void PortalSystem::rewindCooldown(Position position, int ready_at) {
+    Portal* portal = board.getPortalAtPosition(position);
+    if (portal == nullptr)
+        throw std::runtime_error("rewindCooldown called on null portal");
+
+    portal->ready_at = ready_at;
+}
@@ -0,0 +1,306 @@
+#include "PositionIndex.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <queue>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char MAGIC[8] = { 'C', 'H', 'S', 'S', 'P', 'I', 'D', 'X' };
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t header_size;
+    std::uint64_t rules_hash;
+    std::uint64_t game_count;
+    std::uint64_t entry_count;
+    std::uint64_t block_count;
+    std::uint64_t entry_offset;
+    std::uint64_t fence_offset;
+};
+
+/**
+ * @brief Counts of a move played in a position, as stored in runs & in the index
+ */
+struct Entry {
+    std::uint64_t position;
+    std::uint32_t move;
+    std::uint32_t games[4];
+    std::uint32_t reserved;
+
+    bool operator<(const Entry& other) const {
+        return position != other.position ? position < other.position : move < other.move;
+    }
+};
+
+static_assert(sizeof(Header) % 8 == 0 && sizeof(Entry) == 32, "Entries must stay aligned to 8 bytes");
+
+/**
+ * @brief A byte per coordinate, boards up to 256 squares a side
+ */
+std::uint32_t encodeMove(const Move& move) {
+    return static_cast<std::uint32_t>(move.from.x) | static_cast<std::uint32_t>(move.from.y) << 8
+           | static_cast<std::uint32_t>(move.to.x) << 16 | static_cast<std::uint32_t>(move.to.y) << 24;
+}
+
+Move decodeMove(std::uint32_t code) {
+    return Move(Position(code & 255, (code >> 8) & 255), Position((code >> 16) & 255, code >> 24));
+}
+
+/**
+ * @brief Writes sorted entries, merging the counts of equal ones, & collects
+ * the fence of every block
+ */
+class EntryWriter {
+public:
+    explicit EntryWriter(std::ostream& file) : file(file), count(0), has_pending(false) { }
+
+    void add(const Entry& entry) {
+        if (has_pending && pending.position == entry.position && pending.move == entry.move) {
+            for (int i = 0; i < 4; i++)
+                pending.games[i] += entry.games[i];
+            return;
+        }
+
+        writePending();
+        pending = entry;
+        has_pending = true;
+    }
+
+    void writePending() {
+        if (!has_pending)
+            return;
+        if (count % PositionIndex::BLOCK_SIZE == 0)
+            fences.push_back(pending.position);
+        file.write(reinterpret_cast<const char*>(&pending), sizeof(Entry));
+        count++;
+        has_pending = false;
+    }
+
+    std::ostream& file;
+    std::uint64_t count;
+    std::vector<std::uint64_t> fences;
+
+private:
+    Entry pending;
+    bool has_pending;
+};
+
+} // namespace
+
+PositionIndexBuilder::PositionIndexBuilder(const std::string& path, const GameManager& start,
+                                           std::size_t run_turns)
+                                           : path(path), start(start), run_turns(std::max<std::size_t>(run_turns, 1))
+                                           , game_count(0), failed(false) { }
+
+PositionIndexBuilder::~PositionIndexBuilder() {
+    for (const std::string& run_path : run_paths)
+        std::remove(run_path.c_str());
+}
+
+bool PositionIndexBuilder::addGame(const GameRecord& record) {
+    if (record.rules_hash != start.getRuleset()->getRulesHash() || start.getBoard().getSize() > 256)
+        return false;
+
+    std::vector<std::uint64_t> positions;
+    std::size_t rejected;
+    if (!replayGame(record, start, rejected, &positions))
+        return false;
+
+    // A full buffer is sorted & written outside the lock, other workers keep
+    // replaying into a fresh one meanwhile
+    std::vector<Turn> run;
+    std::string run_path;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::size_t i = 0; i < record.move_count; i++)
+            turns.push_back(Turn{ positions[i], encodeMove(record.getMove(i)), record.result });
+        game_count++;
+        if (turns.size() < run_turns)
+            return true;
+
+        run.swap(turns);
+        run_path = claimRunPath();
+    }
+
+    if (!spillRun(run, run_path)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        failed = true;
+    }
+    return true;
+}
+
+std::string PositionIndexBuilder::claimRunPath() {
+    std::string run_path = path + ".run" + std::to_string(run_paths.size()) + "." + std::to_string(getpid());
+    run_paths.push_back(run_path);
+    return run_path;
+}
+
+bool PositionIndexBuilder::spillRun(std::vector<Turn>& run, const std::string& run_path) {
+    // Runs hold merged entries, repeated openings shrink to a single one
+    std::sort(run.begin(), run.end(), [](const Turn& a, const Turn& b) {
+        return a.position != b.position ? a.position < b.position : a.move < b.move;
+    });
+
+    std::ofstream file(run_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    EntryWriter writer(file);
+    for (const Turn& turn : run) {
+        Entry entry{ turn.position, turn.move, { 0, 0, 0, 0 }, 0 };
+        entry.games[turn.result] = 1;
+        writer.add(entry);
+    }
+    writer.writePending();
+    run.clear();
+    return file.good();
+}
+
+bool PositionIndexBuilder::finish() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (failed || !spillRun(turns, claimRunPath()))
+        return false;
+
+    // Readers never observe a partially written index
+    std::string temp_path = path + ".tmp" + std::to_string(getpid());
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    Header header{};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Merge the runs, the smallest head of all runs goes first
+    std::vector<std::ifstream> runs;
+    using Head = std::pair<Entry, std::size_t>;
+    auto later = [](const Head& a, const Head& b) { return b.first < a.first; };
+    std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+    for (const std::string& run_path : run_paths) {
+        runs.emplace_back(run_path, std::ios::binary);
+        Entry entry;
+        if (runs.back().read(reinterpret_cast<char*>(&entry), sizeof(Entry)))
+            heads.push(Head{ entry, runs.size() - 1 });
+    }
+
+    EntryWriter writer(file);
+    while (!heads.empty()) {
+        Head head = heads.top();
+        heads.pop();
+        writer.add(head.first);
+        if (runs[head.second].read(reinterpret_cast<char*>(&head.first), sizeof(Entry)))
+            heads.push(head);
+    }
+    writer.writePending();
+    file.write(reinterpret_cast<const char*>(writer.fences.data()), writer.fences.size() * sizeof(std::uint64_t));
+
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = PositionIndex::VERSION;
+    header.header_size = sizeof(Header);
+    header.rules_hash = start.getRuleset()->getRulesHash();
+    header.game_count = game_count;
+    header.entry_count = writer.count;
+    header.block_count = writer.fences.size();
+    header.entry_offset = sizeof(Header);
+    header.fence_offset = sizeof(Header) + writer.count * sizeof(Entry);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+
+    if (!file.good() || std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<PositionIndex> PositionIndex::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header))) {
+        close(fd);
+        return nullptr;
+    }
+
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return nullptr;
+
+    // Lookups jump around, reading ahead would only evict useful pages
+    madvise(mapping, size, MADV_RANDOM);
+
+    // Validate the header before trusting any offset
+    const Header* header = static_cast<const Header*>(mapping);
+    bool valid = std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0
+        && header->version == VERSION
+        && header->header_size == sizeof(Header)
+        && header->entry_offset == sizeof(Header)
+        && header->entry_count <= (size - sizeof(Header)) / sizeof(Entry)
+        && header->block_count == (header->entry_count + BLOCK_SIZE - 1) / BLOCK_SIZE
+        && header->fence_offset == sizeof(Header) + header->entry_count * sizeof(Entry)
+        && size - header->fence_offset == header->block_count * sizeof(std::uint64_t);
+    if (!valid) {
+        munmap(mapping, size);
+        return nullptr;
+    }
+
+    return std::unique_ptr<PositionIndex>(new PositionIndex(static_cast<const unsigned char*>(mapping), size));
+}
+
+PositionIndex::PositionIndex(const unsigned char* data, std::size_t size) : data(data), size(size) { }
+
+PositionIndex::~PositionIndex() {
+    munmap(const_cast<unsigned char*>(data), size);
+}
+
+std::uint64_t PositionIndex::find(std::uint64_t position, std::vector<MoveStats>& stats) const {
+    const Header* header = reinterpret_cast<const Header*>(data);
+    const Entry* entries = reinterpret_cast<const Entry*>(data + header->entry_offset);
+    const std::uint64_t* fences = reinterpret_cast<const std::uint64_t*>(data + header->fence_offset);
+    stats.clear();
+
+    // Entries of a position may begin in the block before the first fence reaching it
+    std::size_t block = std::lower_bound(fences, fences + header->block_count, position) - fences;
+    if (block > 0)
+        block--;
+
+    const Entry* end = entries + header->entry_count;
+    const Entry* block_begin = entries + block * BLOCK_SIZE;
+    const Entry* block_end = std::min(end, block_begin + BLOCK_SIZE);
+    const Entry* entry = std::lower_bound(block_begin, block_end, position,
+                                          [](const Entry& e, std::uint64_t p) { return e.position < p; });
+
+    std::uint64_t turns = 0;
+    for (; entry != end && entry->position == position; entry++) {
+        MoveStats move_stats{ decodeMove(entry->move), {} };
+        std::copy(entry->games, entry->games + 4, move_stats.games);
+        stats.push_back(move_stats);
+        turns += move_stats.getGameCount();
+    }
+    return turns;
+}
+
+std::uint64_t PositionIndex::getRulesHash() const {
+    return reinterpret_cast<const Header*>(data)->rules_hash;
+}
+
+std::uint64_t PositionIndex::getGameCount() const {
+    return reinterpret_cast<const Header*>(data)->game_count;
+}
+
+std::uint64_t PositionIndex::getEntryCount() const {
+    return reinterpret_cast<const Header*>(data)->entry_count;
+}
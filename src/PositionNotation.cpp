@@ -0,0 +1,292 @@
+#include "PositionNotation.hpp"
+
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+
+namespace {
+
+/**
+ * @brief Appends to a fixed buffer, remembering whether anything did not fit
+ */
+class NotationWriter {
+public:
+    inline NotationWriter(char* buffer, std::size_t capacity)
+        : begin(buffer), next(buffer), end(buffer + capacity), overflow(false) { }
+
+    inline void put(char c) {
+        if (next == end)
+            overflow = true;
+        else
+            *next++ = c;
+    }
+
+    inline void putNumber(int value) {
+        std::to_chars_result result = std::to_chars(next, end, value);
+        if (result.ec != std::errc())
+            overflow = true;
+        else
+            next = result.ptr;
+    }
+
+    inline bool putPiece(const ChessBoard& board, const ChessPiece& piece) {
+        char symbol = board.getRuleset()->getPieceType(piece.type_id).symbol;
+        if (symbol == 0)
+            return false;
+
+        put(piece.team == WHITE ? static_cast<char>(symbol - 'a' + 'A') : symbol);
+        if (piece.used)
+            put('*');
+        return true;
+    }
+
+    inline std::size_t finish() const {
+        return overflow ? 0 : static_cast<std::size_t>(next - begin);
+    }
+
+private:
+    char* begin;
+    char* next;
+    char* end;
+    bool overflow;
+};
+
+/**
+ * @brief Pieces a position may hold to be read in a single pass, the text
+ * of larger ones is checked first & then read again
+ */
+constexpr std::size_t STAGED_PIECES = 1024;
+
+/**
+ * @brief A piece read from the text, placed once all of it is known to be well formed
+ */
+struct StagedPiece {
+    std::int16_t x;
+    std::int16_t y;
+    std::int16_t type_id;
+    team_t team;
+    bool used;
+};
+
+/**
+ * @brief Reads decimal numbers & expected characters off the text
+ */
+class NotationReader {
+public:
+    inline NotationReader(std::string_view text) : next(text.data()), end(text.data() + text.size()) { }
+
+    inline bool readNumber(int& value) {
+        std::from_chars_result result = std::from_chars(next, end, value);
+        if (result.ec != std::errc() || result.ptr == next)
+            return false;
+        next = result.ptr;
+        return true;
+    }
+
+    inline bool expect(char c) {
+        if (next == end || *next != c)
+            return false;
+        next++;
+        return true;
+    }
+
+    const char* next;
+    const char* end;
+};
+
+/**
+ * @brief Reads the ranks. Pieces go to staged while they fit, else onto the
+ * board when place is set, which clearPieces must have emptied
+ */
+bool readPieces(NotationReader& reader, ChessBoard& board, StagedPiece* staged, bool place,
+                std::size_t& piece_count) {
+    const Ruleset& ruleset = *board.getRuleset();
+    int size = board.getSize();
+    piece_count = 0;
+
+    for (int y = size - 1; y >= 0; y--) {
+        int x = 0;
+        while (x < size && reader.next != reader.end && *reader.next != '/' && *reader.next != ' ') {
+            char c = *reader.next;
+            if (c >= '0' && c <= '9') {
+                int run;
+                if (!reader.readNumber(run) || run <= 0 || run > size - x)
+                    return false;
+                x += run;
+                continue;
+            }
+
+            int type_id = ruleset.findPieceSymbol(c);
+            if (type_id < 0)
+                return false;
+            team_t team = c >= 'a' ? BLACK : WHITE;
+            reader.next++;
+            bool used = reader.expect('*');
+
+            if (place)
+                board.placePiece(ChessPiece(type_id, ruleset.getPieceType(type_id).king_type,
+                                            Position(x, y), team, used));
+            else if (piece_count < STAGED_PIECES)
+                staged[piece_count] = StagedPiece{ static_cast<std::int16_t>(x), static_cast<std::int16_t>(y),
+                                                   static_cast<std::int16_t>(type_id), team, used };
+            piece_count++;
+            x++;
+        }
+
+        if (x != size || (y > 0 && !reader.expect('/')))
+            return false;
+    }
+
+    return piece_count <= std::numeric_limits<PieceHandle>::max();
+}
+
+/**
+ * @brief Reads the portals on cooldown, only checking them unless apply is set
+ */
+bool readCooldowns(NotationReader reader, ChessBoard& board, bool apply) {
+    std::vector<Portal>& portals = board.getPortals();
+    if (apply)
+        for (Portal& portal : portals)
+            board.setPortalCooldown(portal, 0);
+
+    if (reader.expect('-'))
+        return reader.next == reader.end;
+
+    while (true) {
+        int index, turns;
+        if (!reader.readNumber(index) || index < 0 || index >= static_cast<int>(portals.size()))
+            return false;
+        if (!reader.expect(':') || !reader.readNumber(turns) || turns <= 0)
+            return false;
+        if (apply)
+            board.setPortalCooldown(portals[index], turns);
+
+        if (reader.next == reader.end)
+            return true;
+        if (!reader.expect(','))
+            return false;
+    }
+}
+
+}
+
+std::size_t getMaxNotationLength(const ChessBoard& board) {
+    // A rank has one more run than pieces, each run at most as long as the size
+    std::size_t digits = 1;
+    for (int size = board.getSize(); size >= 10; size /= 10)
+        digits++;
+    std::size_t pieces = board.getPieces().size();
+    std::size_t size = board.getSize();
+    std::size_t portals = board.getPortals().size();
+    return pieces * (digits + 2) + size * (digits + 1) + 16 + portals * 24;
+}
+
+std::size_t writePosition(const ChessBoard& board, team_t player, int move_count,
+                          char* buffer, std::size_t capacity) {
+    NotationWriter writer(buffer, capacity);
+    int size = board.getSize();
+
+    if (!board.isSparse()) {
+        // Map the squares to pieces once, ranks then come from their occupancy
+        PieceHandle squares[ChessBoard::MAX_DENSE_SIZE * ChessBoard::MAX_DENSE_SIZE];
+        for (const ChessPiece& piece : board.getPieces())
+            squares[piece.position.y * size + piece.position.x] = board.getHandle(piece);
+
+        for (int y = size - 1; y >= 0; y--) {
+            std::uint64_t occupied = board.getRankOccupancy(y);
+            int x = 0;
+            while (occupied != 0) {
+                int file = std::countr_zero(occupied);
+                occupied &= occupied - 1;
+                if (file > x)
+                    writer.putNumber(file - x);
+                if (!writer.putPiece(board, board.getPiece(squares[y * size + file])))
+                    return 0;
+                x = file + 1;
+            }
+            if (x < size)
+                writer.putNumber(size - x);
+            if (y > 0)
+                writer.put('/');
+        }
+    } else {
+        // Walk each rank from blocker to blocker
+        for (int y = size - 1; y >= 0; y--) {
+            int x = 0;
+            while (x < size) {
+                Position square(x, y);
+                if (!board.isOccupied(square) && !board.findFirstBlocker(square, 1, 0, square))
+                    break;
+                if (square.x > x)
+                    writer.putNumber(square.x - x);
+                if (!writer.putPiece(board, *board.getPieceAtPosition(square)))
+                    return 0;
+                x = square.x + 1;
+            }
+            if (x < size)
+                writer.putNumber(size - x);
+            if (y > 0)
+                writer.put('/');
+        }
+    }
+
+    writer.put(' ');
+    writer.put(player == WHITE ? 'w' : 'b');
+    writer.put(' ');
+    writer.putNumber(move_count);
+    writer.put(' ');
+
+    bool cooldowns = false;
+    const std::vector<Portal>& portals = board.getPortals();
+    for (std::size_t i = 0; i < portals.size(); i++) {
+        int turns = board.getPortalCooldown(portals[i]);
+        if (turns == 0)
+            continue;
+        if (cooldowns)
+            writer.put(',');
+        writer.putNumber(static_cast<int>(i));
+        writer.put(':');
+        writer.putNumber(turns);
+        cooldowns = true;
+    }
+    if (!cooldowns)
+        writer.put('-');
+
+    return writer.finish();
+}
+
+bool readPosition(std::string_view text, ChessBoard& board, team_t& player, int& move_count) {
+    // The board is only touched once the whole text is known to be well formed
+    StagedPiece staged[STAGED_PIECES];
+    NotationReader reader(text);
+    std::size_t piece_count;
+    if (!readPieces(reader, board, staged, false, piece_count))
+        return false;
+
+    // Player to move & turns played
+    int turns;
+    if (!reader.expect(' ') || reader.next == reader.end || (*reader.next != 'w' && *reader.next != 'b'))
+        return false;
+    team_t next_player = *reader.next++ == 'w' ? WHITE : BLACK;
+    if (!reader.expect(' ') || !reader.readNumber(turns) || turns < 0 || !reader.expect(' '))
+        return false;
+    if (!readCooldowns(reader, board, false))
+        return false;
+
+    const Ruleset& ruleset = *board.getRuleset();
+    board.clearPieces();
+    if (piece_count <= STAGED_PIECES) {
+        for (std::size_t i = 0; i < piece_count; i++)
+            board.placePiece(ChessPiece(staged[i].type_id, ruleset.getPieceType(staged[i].type_id).king_type,
+                                        Position(staged[i].x, staged[i].y), staged[i].team, staged[i].used));
+    } else {
+        NotationReader again(text);
+        readPieces(again, board, staged, true, piece_count);
+    }
+    readCooldowns(reader, board, true);
+
+    player = next_player;
+    move_count = turns;
+    return true;
+}
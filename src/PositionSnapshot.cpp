@@ -0,0 +1,46 @@
+#include "PositionSnapshot.hpp"
+
+PositionSnapshot::PositionSnapshot(const ChessBoard& board, team_t current_player, int move_count,
+                                   bool game_over, team_t winner)
+                                   : board(board), validator(this->board), current_player(current_player),
+                                     move_count(move_count), game_over(game_over), winner(winner) { }
+
+const ChessBoard& PositionSnapshot::getBoard() const {
+    return board;
+}
+
+team_t PositionSnapshot::getCurrentPlayer() const {
+    return current_player;
+}
+
+int PositionSnapshot::getMoveCount() const {
+    return move_count;
+}
+
+bool PositionSnapshot::isGameOver() const {
+    return game_over;
+}
+
+team_t PositionSnapshot::getWinner() const {
+    return winner;
+}
+
+bool PositionSnapshot::validateMove(Position from, Position to) const {
+    const ChessPiece* piece = board.getPieceAtPosition(from);
+    return piece != nullptr && validator.validateMove(*piece, to);
+}
+
+std::set<Position> PositionSnapshot::getPossibleMoves(Position from) const {
+    const ChessPiece* piece = board.getPieceAtPosition(from);
+    if (piece == nullptr)
+        return {};
+    return validator.getPossibleMoves(*piece);
+}
+
+bool PositionSnapshot::isKingUnderCheck(team_t team) const {
+    return validator.findCheckingPiece(team) != nullptr;
+}
+
+const ChessPiece* PositionSnapshot::getCheckingPiece(team_t team) const {
+    return validator.findCheckingPiece(team);
+}
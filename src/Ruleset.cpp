@@ -0,0 +1,276 @@
+#include "Ruleset.hpp"
+#include "RulesetCache.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief Add the directions of a single movement rule
+ * A rule of -1 allows any distance, a positive rule exactly that distance.
+ */
+static void addPatterns(std::vector<MovePattern>& patterns, int rule,
+                        std::initializer_list<std::pair<short, short>> steps,
+                        bool first_move = false) {
+    if (rule != -1 && rule <= 0)
+        return;
+
+    short distance = rule == -1 ? 0 : static_cast<short>(rule);
+    for (const auto& step : steps)
+        patterns.push_back(MovePattern{step.first, step.second, distance, false, first_move});
+}
+
+static PieceType compilePieceType(const PieceConfig& piece_config) {
+    PieceType type;
+    type.name = piece_config.type;
+    type.king_type = piece_config.king_type;
+    type.forward_captures = piece_config.type != "pawn";
+    type.movement = piece_config.movement;
+    type.symbol = 0;
+
+    const MovementRules& rule = piece_config.movement;
+    addPatterns(type.patterns, rule.forward, {{0, 1}});
+    addPatterns(type.patterns, rule.first_move_forward, {{0, 1}}, true);
+    addPatterns(type.patterns, rule.backward, {{0, -1}});
+    addPatterns(type.patterns, rule.sideways, {{1, 0}, {-1, 0}});
+    addPatterns(type.patterns, rule.diagonal, {{1, 1}, {-1, 1}, {1, -1}, {-1, -1}});
+    addPatterns(type.patterns, rule.diagonal_capture, {{1, 1}, {-1, 1}}); // Forward only
+
+    if (rule.l_shape) {
+        for (auto step : {std::pair<short, short>{1, 2}, {2, 1}, {2, -1}, {1, -2},
+                          {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}})
+            type.patterns.push_back(MovePattern{step.first, step.second, 1, true, false});
+    }
+
+    return type;
+}
+
+/**
+ * @brief Whether covering reaches every square of pattern, whenever pattern applies
+ */
+static bool reachesAll(const MovePattern& covering, const MovePattern& pattern) {
+    return covering.dx == pattern.dx && covering.dy == pattern.dy && covering.leap == pattern.leap
+        && (covering.distance == pattern.distance || (covering.distance == 0 && !covering.leap))
+        && (!covering.first_move || pattern.first_move);
+}
+
+Ruleset::Ruleset(const GameSettings& game_setting,
+                 const std::vector<PieceConfig>& piece_configs,
+                 const std::vector<PortalConfig>& portal_configs)
+                 : game_settings(game_setting) {
+    // Intern piece types, a repeated type overrides the earlier rules
+    for (const PieceConfig& piece_config : piece_configs) {
+        auto it = type_ids.find(piece_config.type);
+        if (it == type_ids.end()) {
+            type_ids[piece_config.type] = static_cast<int>(piece_types.size());
+            piece_types.push_back(compilePieceType(piece_config));
+        } else {
+            piece_types[it->second] = compilePieceType(piece_config);
+        }
+    }
+    for (PieceType& type : piece_types)
+        prunePatterns(type);
+
+    for (const PieceConfig& piece_config : piece_configs) {
+        if (piece_config.count > static_cast<int>(piece_config.black_positions.size())
+            || piece_config.count > static_cast<int>(piece_config.white_positions.size()))
+            throw std::runtime_error("Piece count exceeds the given positions.");
+
+        int type_id = type_ids[piece_config.type];
+        for (int i = 0; i < piece_config.count; i++) {
+            placements.push_back(PiecePlacement{type_id, BLACK, piece_config.black_positions[i]});
+            placements.push_back(PiecePlacement{type_id, WHITE, piece_config.white_positions[i]});
+        }
+    }
+
+    for (const PortalConfig& portal_config : portal_configs)
+        portals.push_back(compilePortal(portal_config));
+
+    assignSymbols();
+    computeRulesHash();
+}
+
+void Ruleset::prunePatterns(PieceType& type) {
+    // Equal directions overlap, a walk reaches the square of any step along it
+    std::vector<MovePattern> kept;
+    for (const MovePattern& pattern : type.patterns) {
+        if (std::any_of(kept.begin(), kept.end(),
+                        [&](const MovePattern& other) { return reachesAll(other, pattern); }))
+            continue;
+
+        std::erase_if(kept, [&](const MovePattern& other) { return reachesAll(pattern, other); });
+        kept.push_back(pattern);
+    }
+    type.patterns = std::move(kept);
+
+    // Left are first moves reaching squares of patterns which stay after it
+    type.first_move_overlaps = false;
+    for (const MovePattern& first : type.patterns) {
+        for (MovePattern pattern : type.patterns) {
+            if (!first.first_move || pattern.first_move)
+                continue;
+            pattern.first_move = true;
+            type.first_move_overlaps |= reachesAll(first, pattern);
+        }
+    }
+}
+
+void Ruleset::assignSymbols() {
+    // Kings pick first, so that knights fall back to n as in FEN. A type takes
+    // the first free letter of its name, else the first free letter at all
+    symbol_types.fill(-1);
+    for (bool kings : { true, false }) {
+        for (std::size_t type_id = 0; type_id < piece_types.size(); type_id++) {
+            PieceType& type = piece_types[type_id];
+            if (type.king_type != kings)
+                continue;
+
+            type.symbol = 0;
+            for (char c : type.name) {
+                int letter = std::tolower(static_cast<unsigned char>(c)) - 'a';
+                if (letter >= 0 && letter < 26 && symbol_types[letter] < 0) {
+                    type.symbol = static_cast<char>('a' + letter);
+                    break;
+                }
+            }
+            for (int letter = 0; type.symbol == 0 && letter < 26; letter++)
+                if (symbol_types[letter] < 0)
+                    type.symbol = static_cast<char>('a' + letter);
+
+            if (type.symbol != 0)
+                symbol_types[type.symbol - 'a'] = static_cast<std::int16_t>(type_id);
+        }
+    }
+}
+
+std::shared_ptr<const Ruleset> Ruleset::load(const std::string& config_path) {
+    std::ifstream config_file(config_path);
+    if (!config_file.is_open()) {
+        std::cerr << "Failed to open config file: " << config_path << std::endl;
+        return nullptr;
+    }
+
+    std::stringstream source;
+    source << config_file.rdbuf();
+    std::string text = source.str();
+
+    // Only hash the source, the cache is keyed by its contents
+    std::uint64_t source_hash = RulesetCache::hashSource(text);
+    std::string cache_path = RulesetCache::getCachePath(config_path);
+    std::shared_ptr<const Ruleset> ruleset = RulesetCache::read(cache_path, source_hash);
+    if (ruleset != nullptr)
+        return ruleset;
+
+    ConfigReader reader(config_path);
+    if (!reader.parseConfig(text))
+        return nullptr;
+
+    try {
+        ruleset = std::make_shared<const Ruleset>(reader.getGameSettings(),
+                                                  reader.getPieceConfigs(),
+                                                  reader.getPortalConfigs());
+    } catch (const std::exception& e) {
+        std::cerr << "Error compiling config file: " << e.what() << std::endl;
+        return nullptr;
+    }
+
+    // Best effort, configs may live in read-only directories
+    RulesetCache::write(*ruleset, source_hash, cache_path);
+    return ruleset;
+}
+
+Portal Ruleset::compilePortal(const PortalConfig& portal_config) {
+    auto& ac = portal_config.properties.allowed_colors;
+    return Portal(portal_config.id,
+                  portal_config.positions.entry,
+                  portal_config.positions.exit,
+                  !portal_config.properties.preserve_direction,
+                  std::find(ac.begin(), ac.end(), "white") != ac.end(),
+                  std::find(ac.begin(), ac.end(), "black") != ac.end(),
+                  portal_config.properties.cooldown);
+}
+
+const GameSettings& Ruleset::getGameSettings() const {
+    return game_settings;
+}
+
+int Ruleset::getBoardSize() const {
+    return game_settings.board_size;
+}
+
+const std::vector<PieceType>& Ruleset::getPieceTypes() const {
+    return piece_types;
+}
+
+const PieceType& Ruleset::getPieceType(int type_id) const {
+    return piece_types[type_id];
+}
+
+int Ruleset::findPieceType(const std::string& name) const {
+    auto it = type_ids.find(name);
+    return it == type_ids.end() ? -1 : it->second;
+}
+
+std::uint64_t Ruleset::getRulesHash() const {
+    return rules_hash;
+}
+
+void Ruleset::computeRulesHash() {
+    // Fields are mixed one by one, padding & field order in memory never matter
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](long long value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= static_cast<std::uint64_t>(value >> (i * 8)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+    auto mixString = [&mix](const std::string& text) {
+        mix(static_cast<long long>(text.size()));
+        for (char c : text)
+            mix(c);
+    };
+
+    mix(game_settings.board_size);
+    mix(game_settings.turn_limit);
+    mix(static_cast<long long>(piece_types.size()));
+    for (const PieceType& type : piece_types) {
+        const MovementRules& rule = type.movement;
+        mixString(type.name);
+        mix(type.king_type);
+        mix(type.forward_captures);
+        for (int value : { rule.forward, rule.backward, rule.sideways, rule.diagonal,
+                           rule.first_move_forward, rule.diagonal_capture })
+            mix(value);
+        mix(rule.l_shape);
+    }
+
+    mix(static_cast<long long>(placements.size()));
+    for (const PiecePlacement& placement : placements) {
+        mix(placement.type_id);
+        mix(placement.team);
+        mix(placement.position.x);
+        mix(placement.position.y);
+    }
+
+    mix(static_cast<long long>(portals.size()));
+    for (const Portal& portal : portals) {
+        for (short value : { portal.entry.x, portal.entry.y, portal.exit.x, portal.exit.y })
+            mix(value);
+        mix(portal.both_ways);
+        mix(portal.white_allowed);
+        mix(portal.black_allowed);
+        mix(portal.cooldown);
+    }
+    rules_hash = hash;
+}
+
+const std::vector<PiecePlacement>& Ruleset::getPlacements() const {
+    return placements;
+}
+
+const std::vector<Portal>& Ruleset::getPortals() const {
+    return portals;
+}
@@ -0,0 +1,381 @@
+#include "RulesetCache.hpp"
+
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char MAGIC[8] = { 'C', 'H', 'S', 'S', 'R', 'S', 'E', 'T' };
+
+/**
+ * @brief Reference into the string pool
+ */
+struct StringRecord {
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t header_size;
+    std::uint64_t source_hash;
+    std::uint64_t file_size;
+    std::uint64_t checksum;         // FNV-1a 64 of everything after the header
+
+    std::int32_t board_size;
+    std::int32_t turn_limit;
+    StringRecord name;
+
+    std::uint32_t type_offset, type_count;
+    std::uint32_t pattern_offset, pattern_count;
+    std::uint32_t placement_offset, placement_count;
+    std::uint32_t portal_offset, portal_count;
+    std::uint32_t string_offset, string_size;
+};
+
+struct TypeRecord {
+    StringRecord name;
+    std::uint8_t king_type;
+    std::uint8_t forward_captures;
+    std::uint8_t l_shape;
+    std::uint8_t padding;
+    std::int32_t forward, backward, sideways, diagonal;
+    std::int32_t first_move_forward, diagonal_capture;
+    std::uint32_t pattern_begin, pattern_count;
+};
+
+struct PatternRecord {
+    std::int16_t dx, dy, distance;
+    std::uint8_t leap, first_move;
+};
+
+struct PlacementRecord {
+    std::int32_t type_id;
+    std::uint8_t team;
+    std::uint8_t padding;
+    std::int16_t x, y;
+};
+
+struct PortalRecord {
+    StringRecord id;
+    std::int16_t entry_x, entry_y, exit_x, exit_y;
+    std::uint8_t both_ways, white_allowed, black_allowed, padding;
+    std::int32_t cooldown;
+};
+
+std::uint64_t fnv1a(const char* data, std::size_t size) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Appends records & strings while writing a cache
+ */
+class Writer {
+public:
+    template <typename T>
+    std::uint32_t add(const T& record) {
+        std::uint32_t offset = static_cast<std::uint32_t>(body.size());
+        const char* bytes = reinterpret_cast<const char*>(&record);
+        body.insert(body.end(), bytes, bytes + sizeof(T));
+        return offset;
+    }
+
+    StringRecord addString(const std::string& text) {
+        StringRecord record{ static_cast<std::uint32_t>(strings.size()),
+                             static_cast<std::uint32_t>(text.size()) };
+        strings += text;
+        return record;
+    }
+
+    std::vector<char> body;
+    std::string strings;
+};
+
+/**
+ * @brief Bounds checked view of a mapped cache
+ */
+class Reader {
+public:
+    Reader(const char* data, std::size_t size) : data(data), size(size) { }
+
+    template <typename T>
+    const T* array(std::uint32_t offset, std::uint32_t count) const {
+        if (offset % alignof(T) != 0 || offset > size
+            || count > (size - offset) / sizeof(T))
+            return nullptr;
+        return reinterpret_cast<const T*>(data + offset);
+    }
+
+    const char* data;
+    std::size_t size;
+};
+
+/**
+ * @brief Round a body offset up so the next record array is aligned
+ */
+void align(std::vector<char>& body) {
+    while (body.size() % 8 != 0)
+        body.push_back(0);
+}
+
+} // namespace
+
+std::uint64_t RulesetCache::hashSource(const std::string& source) {
+    return fnv1a(source.data(), source.size());
+}
+
+std::string RulesetCache::getCachePath(const std::string& config_path) {
+    return config_path + ".rsc";
+}
+
+bool RulesetCache::write(const Ruleset& ruleset, std::uint64_t source_hash,
+                         const std::string& cache_path) {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.header_size = sizeof(Header);
+    header.source_hash = source_hash;
+    header.board_size = ruleset.game_settings.board_size;
+    header.turn_limit = ruleset.game_settings.turn_limit;
+
+    // Offsets are relative to the file, the body starts after the header
+    Writer writer;
+    writer.body.resize(sizeof(Header));
+    header.name = writer.addString(ruleset.game_settings.name);
+
+    std::vector<PatternRecord> patterns;
+    header.type_offset = static_cast<std::uint32_t>(writer.body.size());
+    header.type_count = static_cast<std::uint32_t>(ruleset.piece_types.size());
+    for (const PieceType& type : ruleset.piece_types) {
+        TypeRecord record{};
+        record.name = writer.addString(type.name);
+        record.king_type = type.king_type;
+        record.forward_captures = type.forward_captures;
+        record.l_shape = type.movement.l_shape;
+        record.forward = type.movement.forward;
+        record.backward = type.movement.backward;
+        record.sideways = type.movement.sideways;
+        record.diagonal = type.movement.diagonal;
+        record.first_move_forward = type.movement.first_move_forward;
+        record.diagonal_capture = type.movement.diagonal_capture;
+        record.pattern_begin = static_cast<std::uint32_t>(patterns.size());
+        record.pattern_count = static_cast<std::uint32_t>(type.patterns.size());
+        writer.add(record);
+
+        for (const MovePattern& pattern : type.patterns)
+            patterns.push_back(PatternRecord{ pattern.dx, pattern.dy, pattern.distance,
+                                              pattern.leap, pattern.first_move });
+    }
+
+    align(writer.body);
+    header.pattern_offset = static_cast<std::uint32_t>(writer.body.size());
+    header.pattern_count = static_cast<std::uint32_t>(patterns.size());
+    for (const PatternRecord& pattern : patterns)
+        writer.add(pattern);
+
+    align(writer.body);
+    header.placement_offset = static_cast<std::uint32_t>(writer.body.size());
+    header.placement_count = static_cast<std::uint32_t>(ruleset.placements.size());
+    for (const PiecePlacement& placement : ruleset.placements)
+        writer.add(PlacementRecord{ placement.type_id, placement.team, 0,
+                                    placement.position.x, placement.position.y });
+
+    align(writer.body);
+    header.portal_offset = static_cast<std::uint32_t>(writer.body.size());
+    header.portal_count = static_cast<std::uint32_t>(ruleset.portals.size());
+    for (const Portal& portal : ruleset.portals) {
+        PortalRecord record{};
+        record.id = writer.addString(portal.id);
+        record.entry_x = portal.entry.x;
+        record.entry_y = portal.entry.y;
+        record.exit_x = portal.exit.x;
+        record.exit_y = portal.exit.y;
+        record.both_ways = portal.both_ways;
+        record.white_allowed = portal.white_allowed;
+        record.black_allowed = portal.black_allowed;
+        record.cooldown = portal.cooldown;
+        writer.add(record);
+    }
+
+    header.string_offset = static_cast<std::uint32_t>(writer.body.size());
+    header.string_size = static_cast<std::uint32_t>(writer.strings.size());
+    writer.body.insert(writer.body.end(), writer.strings.begin(), writer.strings.end());
+
+    header.file_size = writer.body.size();
+    header.checksum = fnv1a(writer.body.data() + sizeof(Header), writer.body.size() - sizeof(Header));
+    std::memcpy(writer.body.data(), &header, sizeof(Header));
+
+    // Readers never observe a partially written cache. Threads of a process
+    // may write the same cache at once, each gets a temp file of its own
+    static std::atomic<unsigned> temp_count(0);
+    std::string temp_path = cache_path + ".tmp" + std::to_string(getpid()) + "." + std::to_string(temp_count++);
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+        file.write(writer.body.data(), writer.body.size());
+        if (!file.good()) {
+            file.close();
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(temp_path.c_str(), cache_path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+std::shared_ptr<const Ruleset> RulesetCache::read(const std::string& cache_path,
+                                                  std::uint64_t source_hash) {
+    int fd = open(cache_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header))) {
+        close(fd);
+        return nullptr;
+    }
+
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return nullptr;
+
+    const char* data = static_cast<const char*>(mapping);
+    Reader reader(data, size);
+    std::shared_ptr<Ruleset> ruleset;
+
+    // Validate the header before trusting any offset
+    const Header* header = reader.array<Header>(0, 1);
+    bool valid = header != nullptr
+        && std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0
+        && header->version == VERSION
+        && header->header_size == sizeof(Header)
+        && header->source_hash == source_hash
+        && header->file_size == size
+        && header->checksum == fnv1a(data + sizeof(Header), size - sizeof(Header));
+
+    const TypeRecord* types = nullptr;
+    const PatternRecord* patterns = nullptr;
+    const PlacementRecord* placements = nullptr;
+    const PortalRecord* portals = nullptr;
+    const char* strings = nullptr;
+    if (valid) {
+        types = reader.array<TypeRecord>(header->type_offset, header->type_count);
+        patterns = reader.array<PatternRecord>(header->pattern_offset, header->pattern_count);
+        placements = reader.array<PlacementRecord>(header->placement_offset, header->placement_count);
+        portals = reader.array<PortalRecord>(header->portal_offset, header->portal_count);
+        strings = reader.array<char>(header->string_offset, header->string_size);
+        valid = types != nullptr && patterns != nullptr && placements != nullptr
+                && portals != nullptr && strings != nullptr;
+    }
+
+    auto string_at = [&](const StringRecord& record, std::string& out) {
+        if (record.offset > header->string_size
+            || record.length > header->string_size - record.offset)
+            return false;
+        out.assign(strings + record.offset, record.length);
+        return true;
+    };
+
+    // Everything placed on the board must lie on it
+    valid = valid && header->board_size > 0 && header->board_size <= SHRT_MAX;
+    auto on_board = [&](std::int16_t x, std::int16_t y) {
+        return x >= 0 && x < header->board_size && y >= 0 && y < header->board_size;
+    };
+
+    if (valid) {
+        ruleset = std::shared_ptr<Ruleset>(new Ruleset());
+        ruleset->game_settings.board_size = header->board_size;
+        ruleset->game_settings.turn_limit = header->turn_limit;
+        valid = string_at(header->name, ruleset->game_settings.name);
+    }
+
+    for (std::uint32_t i = 0; valid && i < header->type_count; i++) {
+        const TypeRecord& record = types[i];
+        if (record.pattern_begin > header->pattern_count
+            || record.pattern_count > header->pattern_count - record.pattern_begin) {
+            valid = false;
+            break;
+        }
+
+        PieceType type;
+        valid = string_at(record.name, type.name);
+        type.king_type = record.king_type;
+        type.forward_captures = record.forward_captures;
+        type.movement.forward = record.forward;
+        type.movement.backward = record.backward;
+        type.movement.sideways = record.sideways;
+        type.movement.diagonal = record.diagonal;
+        type.movement.l_shape = record.l_shape;
+        type.movement.first_move_forward = record.first_move_forward;
+        type.movement.diagonal_capture = record.diagonal_capture;
+
+        type.patterns.reserve(record.pattern_count);
+        for (std::uint32_t p = 0; p < record.pattern_count; p++) {
+            const PatternRecord& pattern = patterns[record.pattern_begin + p];
+            type.patterns.push_back(MovePattern{ pattern.dx, pattern.dy, pattern.distance,
+                                                 pattern.leap != 0, pattern.first_move != 0 });
+        }
+        Ruleset::prunePatterns(type);
+
+        ruleset->type_ids[type.name] = static_cast<int>(i);
+        ruleset->piece_types.push_back(std::move(type));
+    }
+
+    if (valid) {
+        ruleset->placements.reserve(header->placement_count);
+        for (std::uint32_t i = 0; i < header->placement_count; i++) {
+            const PlacementRecord& record = placements[i];
+            if (record.type_id < 0 || record.type_id >= static_cast<std::int32_t>(header->type_count)
+                || record.team > BLACK || !on_board(record.x, record.y)) {
+                valid = false;
+                break;
+            }
+            ruleset->placements.push_back(PiecePlacement{ record.type_id, record.team,
+                                                          Position(record.x, record.y) });
+        }
+    }
+
+    for (std::uint32_t i = 0; valid && i < header->portal_count; i++) {
+        const PortalRecord& record = portals[i];
+        std::string id;
+        valid = string_at(record.id, id) && on_board(record.entry_x, record.entry_y)
+                && on_board(record.exit_x, record.exit_y);
+        if (!valid)
+            break;
+        ruleset->portals.push_back(Portal(id,
+                                          Position(record.entry_x, record.entry_y),
+                                          Position(record.exit_x, record.exit_y),
+                                          record.both_ways, record.white_allowed,
+                                          record.black_allowed, record.cooldown));
+    }
+
+    munmap(mapping, size);
+    if (valid) {
+        ruleset->assignSymbols();
+        ruleset->computeRulesHash();
+    }
+    return valid ? ruleset : nullptr;
+}
@@ -0,0 +1,59 @@
+#include "TensorEncoder.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+TensorEncoder::TensorEncoder(const Ruleset& ruleset)
+                             : type_count(static_cast<int>(ruleset.getPieceTypes().size()))
+                             , size(ruleset.getBoardSize()) { }
+
+std::size_t TensorEncoder::getPlaneCount() const {
+    return static_cast<std::size_t>(type_count) * 2;
+}
+
+std::size_t TensorEncoder::getTensorSize() const {
+    return getPlaneCount() * size * size;
+}
+
+template <typename T>
+void TensorEncoder::scatter(const ChessBoard& board, T* out) const {
+    if (board.getSize() != size)
+        throw std::runtime_error("Board size does not match the encoder.");
+
+    const std::size_t plane_size = static_cast<std::size_t>(size) * size;
+    for (const ChessPiece& piece : board.getPieces()) {
+        if (piece.type_id < 0 || piece.type_id >= type_count)
+            throw std::runtime_error("Piece type is not known by the encoder.");
+
+        std::size_t plane = piece.type_id * 2 + piece.team;
+        out[plane * plane_size + piece.position.y * size + piece.position.x] = T(1);
+    }
+}
+
+void TensorEncoder::encode(const ChessBoard& board, float* out) const {
+    const ChessBoard* boards[] = { &board };
+    encodeBatch(boards, 1, out);
+}
+
+void TensorEncoder::encode(const ChessBoard& board, std::uint8_t* out) const {
+    const ChessBoard* boards[] = { &board };
+    encodeBatch(boards, 1, out);
+}
+
+// The whole batch is cleared with a single memset, which libc vectorizes,
+// so only the occupied squares are touched afterwards.
+void TensorEncoder::encodeBatch(const ChessBoard* const* boards, std::size_t count, float* out) const {
+    const std::size_t tensor_size = getTensorSize();
+    std::memset(out, 0, count * tensor_size * sizeof(float));
+
+    for (std::size_t i = 0; i < count; i++)
+        scatter(*boards[i], out + i * tensor_size);
+}
+
+void TensorEncoder::encodeBatch(const ChessBoard* const* boards, std::size_t count, std::uint8_t* out) const {
+    const std::size_t tensor_size = getTensorSize();
+    std::memset(out, 0, count * tensor_size);
+
+    for (std::size_t i = 0; i < count; i++)
+        scatter(*boards[i], out + i * tensor_size);
+}
@@ -0,0 +1,207 @@
+#include "UciProtocol.hpp"
+
+#include <exception>
+#include <sstream>
+
+UciProtocol::UciProtocol(std::ostream& out, const std::string& config_path)
+                         : out(out), stop_flag(false), infinite_search(false) {
+    loadConfig(config_path);
+}
+
+UciProtocol::~UciProtocol() {
+    stopSearch();
+}
+
+void UciProtocol::send(const std::string& line) {
+    std::lock_guard<std::mutex> lock(out_mutex);
+    out << line << std::endl;
+}
+
+bool UciProtocol::loadConfig(const std::string& config_path) {
+    auto new_ruleset = Ruleset::load(config_path);
+    if (new_ruleset == nullptr) {
+        send("info string failed to load config " + config_path);
+        return false;
+    }
+
+    ruleset = std::move(new_ruleset);
+    this->config_path = config_path;
+    game = std::make_unique<GameManager>(ruleset);
+    engine = std::make_unique<Engine>(*ruleset);
+    return true;
+}
+
+void UciProtocol::run(std::istream& in) {
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!handleCommand(line))
+            return;
+    }
+
+    // Input ended, let a bounded search report before leaving
+    if (infinite_search)
+        stopSearch();
+    else
+        waitForSearch();
+}
+
+bool UciProtocol::handleCommand(const std::string& line) {
+    std::istringstream args(line);
+    std::string command;
+    args >> command;
+
+    if (command.empty()) {
+        return true;
+    } else if (command == "uci") {
+        send("id name chess-game");
+        send("id author chess-game developers");
+        send("option name Config type string default " + config_path);
+        send("uciok");
+    } else if (command == "isready") {
+        send("readyok");
+    } else if (command == "ucinewgame") {
+        stopSearch();
+        std::istringstream startpos("startpos");
+        setupPosition(startpos);
+    } else if (command == "setoption") {
+        stopSearch();
+        std::string token, name, value;
+        args >> token >> name >> token >> value;
+        if (name == "Config")
+            loadConfig(value);
+        else
+            send("info string unknown option " + name);
+    } else if (command == "position") {
+        stopSearch();
+        setupPosition(args);
+    } else if (command == "go") {
+        stopSearch();
+        startSearch(args);
+    } else if (command == "stop") {
+        stopSearch();
+    } else if (command == "quit") {
+        stopSearch();
+        return false;
+    } else {
+        send("info string unknown command " + command);
+    }
+
+    return true;
+}
+
+void UciProtocol::setupPosition(std::istringstream& args) {
+    std::string token;
+    args >> token;
+
+    if (token == "config") {
+        std::string config_path;
+        args >> config_path;
+        if (!loadConfig(config_path))
+            return;
+    } else if (token != "startpos") {
+        send("info string expected startpos or config");
+        return;
+    }
+
+    if (ruleset == nullptr) {
+        send("info string no config loaded");
+        return;
+    }
+
+    game = std::make_unique<GameManager>(ruleset);
+
+    args >> token;
+    if (token != "moves")
+        return;
+
+    while (args >> token) {
+        Move move;
+        if (!parseMove(token, move) || !game->playTurn(move)) {
+            send("info string illegal move " + token);
+            return;
+        }
+    }
+}
+
+void UciProtocol::startSearch(std::istringstream& args) {
+    if (game == nullptr) {
+        send("bestmove (none)");
+        return;
+    }
+
+    SearchLimits limits;
+    long time_left[2] = { 0, 0 };
+    long increment[2] = { 0, 0 };
+    long moves_to_go = 30;
+    bool infinite = false;
+
+    std::string token;
+    while (args >> token) {
+        if (token == "infinite") infinite = true;
+        else if (token == "depth") args >> limits.depth;
+        else if (token == "nodes") args >> limits.nodes;
+        else if (token == "movetime") args >> limits.movetime;
+        else if (token == "wtime") args >> time_left[WHITE];
+        else if (token == "btime") args >> time_left[BLACK];
+        else if (token == "winc") args >> increment[WHITE];
+        else if (token == "binc") args >> increment[BLACK];
+        else if (token == "movestogo") args >> moves_to_go;
+    }
+
+    // Spend an even share of the remaining clock
+    team_t side = game->getCurrentPlayer();
+    if (!infinite && limits.movetime == 0 && time_left[side] > 0)
+        limits.movetime = std::max(1L, time_left[side] / std::max(1L, moves_to_go) + increment[side] / 2);
+
+    stop_flag = false;
+    infinite_search = infinite;
+    auto position = std::make_shared<GameManager>(*game);
+    worker = std::thread([this, position, limits, infinite]() {
+        // An exception escaping the worker would end the engine, report it instead
+        SearchResult result;
+        try {
+            result = engine->search(*position, limits, stop_flag, [this](const SearchResult& info) {
+                std::ostringstream line;
+                line << "info depth " << info.depth;
+                if (std::abs(info.score) >= Engine::MATE_SCORE - info.depth) {
+                    int plies = Engine::MATE_SCORE - std::abs(info.score);
+                    line << " score mate " << (info.score > 0 ? (plies + 1) / 2 : -(plies + 1) / 2);
+                } else {
+                    line << " score cp " << info.score;
+                }
+                line << " nodes " << info.nodes << " time " << info.time << " pv " << info.best_move;
+                send(line.str());
+            });
+        } catch (const std::exception& e) {
+            send(std::string("info string search failed: ") + e.what());
+        }
+
+        // An infinite search reports only after being stopped
+        if (infinite) {
+            std::unique_lock<std::mutex> lock(stop_mutex);
+            stopped.wait(lock, [this]() { return stop_flag.load(); });
+        }
+
+        std::ostringstream line;
+        if (result.has_move)
+            line << "bestmove " << result.best_move;
+        else
+            line << "bestmove (none)";
+        send(line.str());
+    });
+}
+
+void UciProtocol::stopSearch() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        stop_flag = true;
+    }
+    stopped.notify_all();
+    if (worker.joinable())
+        worker.join();
+}
+
+void UciProtocol::waitForSearch() {
+    if (worker.joinable())
+        worker.join();
+}
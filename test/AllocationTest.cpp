@@ -0,0 +1,154 @@
+#include "GameManager.hpp"
+#include "PositionNotation.hpp"
+#include "unity.h"
+#include "unity_fixture.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Unity's leak checker renames malloc & free, the counter needs the real ones
+#undef malloc
+#undef free
+
+// Every allocation of the test binary is counted
+static std::atomic<std::size_t> allocation_count(0);
+
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+static GameManager* chess;
+
+TEST_GROUP(Allocation);
+
+TEST_SETUP(Allocation)
+{
+    ConfigReader reader("./data/chess_pieces.json");
+    if (!reader.readConfig()) {
+        TEST_FAIL_MESSAGE("Failed to read configuration file");
+    }
+
+    chess = new GameManager(reader.getGameSettings(), reader.getPieceConfigs(), reader.getPortalConfigs());
+}
+
+TEST_TEAR_DOWN(Allocation)
+{
+    delete chess;
+}
+
+TEST(Allocation, PlayTurn)
+{
+    std::size_t before = allocation_count.load();
+
+    // Knights out & back past a checkpoint, then turns taken back & played
+    // again, so the checkpoint is stored twice
+    bool played = true;
+    for (int round = 0; round < 2 * GameManager::CHECKPOINT_INTERVAL / 4 + 1; round++) {
+        played &= chess->playTurn(Position(1, 0), Position(0, 2));           // Knight a3
+        played &= chess->playTurn(Position(1, 7), Position(0, 5));           // Knight a6
+        played &= chess->playTurn(Position(0, 2), Position(1, 0));           // Knight b1
+        played &= chess->playTurn(Position(0, 5), Position(1, 7));           // Knight b8
+    }
+    for (int turn = 0; turn < GameManager::CHECKPOINT_INTERVAL + 4; turn++)
+        played &= chess->undo();
+    for (int round = 0; round < GameManager::CHECKPOINT_INTERVAL / 4 + 1; round++) {
+        played &= chess->playTurn(Position(1, 0), Position(2, 2));           // Knight c3
+        played &= chess->playTurn(Position(1, 7), Position(2, 5));           // Knight c6
+        played &= chess->playTurn(Position(2, 2), Position(1, 0));           // Knight b1
+        played &= chess->playTurn(Position(2, 5), Position(1, 7));           // Knight b8
+    }
+    played &= chess->seek(GameManager::CHECKPOINT_INTERVAL);
+
+    // Scholar's mate, with every kind of rejected turn along the way
+    played &= chess->playTurn(Position(4, 1), Position(4, 3));                // Pawn e4
+    played &= chess->playTurn(Position(4, 6), Position(4, 4));                // Pawn e5
+    played &= chess->playTurn(Position(5, 0), Position(2, 3));                // Bishop c4
+    played &= chess->playTurn(Position(1, 7), Position(2, 5));                // Knight c6
+    played &= chess->playTurn(Position(3, 0), Position(7, 4));                // Queen h5
+
+    played &= !chess->playTurn(Position(4, 4), Position(4, 3));
+    GameManager::TurnError blocked = chess->getTurnErrorCode();
+    played &= !chess->playTurn(Position(0, 1), Position(0, 2));
+    GameManager::TurnError wrong_player = chess->getTurnErrorCode();
+    played &= !chess->playTurn(Position(3, 3), Position(3, 4));
+    GameManager::TurnError no_piece = chess->getTurnErrorCode();
+    played &= !chess->playTurn(Position(5, 6), Position(5, 5));               // Opens the king
+    GameManager::TurnError check = chess->getTurnErrorCode();
+
+    played &= chess->playTurn(Position(6, 7), Position(5, 5));                // Knight f6
+    played &= chess->playTurn(Position(7, 4), Position(5, 6));                // Queen takes f7, mate
+    played &= !chess->playTurn(Position(4, 7), Position(5, 6));
+    GameManager::TurnError game_over = chess->getTurnErrorCode();
+
+    std::size_t allocations = allocation_count.load() - before;
+
+    TEST_ASSERT_TRUE(played);
+    TEST_ASSERT_EQUAL(GameManager::INVALID_MOVE, blocked);
+    TEST_ASSERT_EQUAL(GameManager::WRONG_PLAYER, wrong_player);
+    TEST_ASSERT_EQUAL(GameManager::NO_PIECE, no_piece);
+    TEST_ASSERT_EQUAL(GameManager::KING_UNDER_CHECK, check);
+    TEST_ASSERT_EQUAL(GameManager::GAME_OVER, game_over);
+    TEST_ASSERT_TRUE(chess->isGameOver());
+    TEST_ASSERT_EQUAL(WHITE, chess->getWinner());
+    TEST_ASSERT_EQUAL(0, allocations);
+}
+
+TEST(Allocation, ReadPosition)
+{
+    ChessBoard board(chess->getRuleset());
+    std::uint64_t hash = board.getPositionHash();
+    team_t player = BLACK;
+    int move_count = 7;
+    std::size_t before = allocation_count.load();
+
+    // Rejected late in the text, after every piece was read
+    bool rejected = !readPosition("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w 4 0:1", board,
+                                  player, move_count);
+    rejected &= !readPosition("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w 0 - ", board, player, move_count);
+    rejected &= !readPosition("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR/8 w 0 -", board, player, move_count);
+    std::size_t rejected_allocations = allocation_count.load() - before;
+    std::uint64_t rejected_hash = board.getPositionHash();
+
+    bool read = readPosition("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w 4 -", board,
+                             player, move_count);
+    std::size_t allocations = allocation_count.load() - before;
+
+    TEST_ASSERT_TRUE(rejected);
+    TEST_ASSERT_EQUAL_UINT64(hash, rejected_hash);
+    TEST_ASSERT_EQUAL(0, rejected_allocations);
+    TEST_ASSERT_TRUE(read);
+    TEST_ASSERT_EQUAL(WHITE, player);
+    TEST_ASSERT_EQUAL(4, move_count);
+    TEST_ASSERT_EQUAL(0, allocations);
+}
+
+TEST_GROUP_RUNNER(Allocation)
+{
+    RUN_TEST_CASE(Allocation, PlayTurn);
+    RUN_TEST_CASE(Allocation, ReadPosition);
+}
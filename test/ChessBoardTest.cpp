@@ -1,4 +1,6 @@
 #include "ChessBoard.hpp"
+#include "GameManager.hpp"
+#include "PositionNotation.hpp"
 #include "unity.h"
 #include "unity_fixture.h"
 
@@ -47,9 +49,9 @@ TEST(ChessBoard, BoardInitialization)
         TEST_ASSERT_NOT_NULL(nPawn);
         TEST_ASSERT_EQUAL(nPawn->team, BLACK); // North is black team
         TEST_ASSERT_NOT_NULL(sPawn);
-        TEST_ASSERT_EQUAL_STRING(nPawn->type.c_str(), "pawn");
+        TEST_ASSERT_EQUAL_STRING(board->getTypeName(*nPawn).c_str(), "pawn");
         TEST_ASSERT_EQUAL(sPawn->team, WHITE); // South is white team
-        TEST_ASSERT_EQUAL_STRING(sPawn->type.c_str(), "pawn");
+        TEST_ASSERT_EQUAL_STRING(board->getTypeName(*sPawn).c_str(), "pawn");
     }
 }
 
@@ -91,20 +93,20 @@ TEST(ChessBoard, RemovePiece)
     board->removePiece(piece);
 
     TEST_ASSERT_NULL(board->getPieceAtPosition(Position(0, 1)));
-    std::list<ChessPiece*> teamPieces = board->getPiecesOfTeam(piece->team);
-    for (const ChessPiece* teamPiece : teamPieces) {
-        TEST_ASSERT_NOT_EQUAL(teamPiece, piece);
+    TEST_ASSERT_EQUAL(15, board->getPiecesOfTeam(WHITE).size());
+    for (const ChessPiece& teamPiece : board->getPiecesOfTeam(WHITE)) {
+        TEST_ASSERT_NOT_EQUAL(&teamPiece, piece);
     }
 }
 
 TEST(ChessBoard, AddPiece)
 {
-    ChessPiece newPiece("queen", false, Position(4, 4), BLACK);
+    ChessPiece newPiece(board->getRuleset()->findPieceType("queen"), false, Position(4, 4), BLACK);
     board->addPiece(newPiece);
 
     ChessPiece* piece = board->getPieceAtPosition(Position(4, 4));
     TEST_ASSERT_NOT_NULL(piece);
-    TEST_ASSERT_EQUAL_STRING(piece->type.c_str(), "queen");
+    TEST_ASSERT_EQUAL_STRING(board->getTypeName(*piece).c_str(), "queen");
     TEST_ASSERT_EQUAL(piece->team, BLACK);
 }
 
@@ -119,11 +121,34 @@ TEST(ChessBoard, AddPortal)
     TEST_ASSERT_EQUAL_MEMORY(&portal->exit, &ePos, sizeof(Position));
 }
 
+TEST(ChessBoard, PortalIndex)
+{
+    board->addPortal(Portal("A", Position(2, 3), Position(5, 3), true, true, true, 2));
+    board->addPortal(Portal("B", Position(2, 4), Position(5, 4), false, true, true, 0));
+    board->addPortal(Portal("C", Position(6, 5), Position(5, 3), true, true, true, 0));
+
+    TEST_ASSERT_EQUAL_STRING("A", board->getPortalAtPosition(Position(5, 3))->id.c_str()); // First wins
+    TEST_ASSERT_EQUAL_STRING("C", board->getPortalAtPosition(Position(6, 5))->id.c_str());
+    TEST_ASSERT_NULL(board->getPortalAtPosition(Position(5, 4))); // One way exit
+    TEST_ASSERT_NULL(board->getPortalAtPosition(Position(-1, 3)));
+    TEST_ASSERT_NULL(board->getPortalAtPosition(Position(8, 3)));
+
+    // Cooldowns are derived from the clock
+    Portal* portal = board->getPortalAtPosition(Position(2, 3));
+    portal->ready_at = board->getPortalClock() + portal->cooldown;
+    TEST_ASSERT_EQUAL(2, board->getPortalCooldown(*portal));
+    board->advancePortalClock();
+    TEST_ASSERT_EQUAL(1, board->getPortalCooldown(*portal));
+    board->advancePortalClock();
+    board->advancePortalClock();
+    TEST_ASSERT_EQUAL(0, board->getPortalCooldown(*portal));
+}
+
 TEST(ChessBoard, GetPieceAtPosition)
 {
     ChessPiece* piece = board->getPieceAtPosition(Position(0, 0));
     TEST_ASSERT_NOT_NULL(piece);
-    TEST_ASSERT_EQUAL_STRING(piece->type.c_str(), "rook");
+    TEST_ASSERT_EQUAL_STRING(board->getTypeName(*piece).c_str(), "rook");
 
     ChessPiece* emptyPiece = board->getPieceAtPosition(Position(5, 5));
     TEST_ASSERT_NULL(emptyPiece);
@@ -133,13 +158,13 @@ TEST(ChessBoard, GetKingOfTeam)
 {
     ChessPiece* whiteKing = board->getKingOfTeam(WHITE);
     TEST_ASSERT_NOT_NULL(whiteKing);
-    TEST_ASSERT_EQUAL_STRING(whiteKing->type.c_str(), "King");
+    TEST_ASSERT_EQUAL_STRING(board->getTypeName(*whiteKing).c_str(), "King");
     TEST_ASSERT_TRUE(whiteKing->king_type);
     TEST_ASSERT_EQUAL(whiteKing->team, WHITE);
 
     ChessPiece* blackKing = board->getKingOfTeam(BLACK);
     TEST_ASSERT_NOT_NULL(blackKing);
-    TEST_ASSERT_EQUAL_STRING(blackKing->type.c_str(), "King");
+    TEST_ASSERT_EQUAL_STRING(board->getTypeName(*blackKing).c_str(), "King");
     TEST_ASSERT_TRUE(whiteKing->king_type);
     TEST_ASSERT_EQUAL(blackKing->team, BLACK);
 }
@@ -159,6 +184,186 @@ TEST(ChessBoard, ExchangePiecePositions)
     TEST_ASSERT_EQUAL_MEMORY(&other->position, &sPos, sizeof(Position));
 }
 
+TEST(ChessBoard, Occupancy)
+{
+    Position blocker;
+    TEST_ASSERT_TRUE(board->findFirstBlocker(Position(0, 2), 0, 1, blocker));
+    TEST_ASSERT_TRUE(blocker == Position(0, 6));
+    TEST_ASSERT_TRUE(board->findFirstBlocker(Position(2, 2), -1, -1, blocker));
+    TEST_ASSERT_TRUE(blocker == Position(1, 1));
+    TEST_ASSERT_TRUE(board->findFirstBlocker(Position(3, 3), -1, 1, blocker));
+    TEST_ASSERT_TRUE(blocker == Position(0, 6));
+    TEST_ASSERT_TRUE(board->findFirstBlocker(Position(3, 3), 1, -1, blocker));
+    TEST_ASSERT_TRUE(blocker == Position(5, 1));
+    TEST_ASSERT_FALSE(board->findFirstBlocker(Position(0, 3), -1, 0, blocker)); // Board edge
+
+    TEST_ASSERT_FALSE(board->isPathClear(Position(0, 0), Position(0, 7)));
+    TEST_ASSERT_TRUE(board->isPathClear(Position(0, 1), Position(0, 6)));
+    TEST_ASSERT_TRUE(board->isPathClear(Position(2, 2), Position(6, 6)));
+
+    // Bits follow moves & captures
+    board->movePiece(*board->getPieceAtPosition(Position(0, 1)), Position(0, 3));
+    TEST_ASSERT_FALSE(board->isOccupied(Position(0, 1)));
+    TEST_ASSERT_TRUE(board->findFirstBlocker(Position(0, 0), 0, 1, blocker));
+    TEST_ASSERT_TRUE(blocker == Position(0, 3));
+    board->capturePiece(board->getPieceAtPosition(Position(0, 3)));
+    TEST_ASSERT_TRUE(board->isPathClear(Position(0, 0), Position(0, 6)));
+    board->restorePiece();
+    TEST_ASSERT_TRUE(board->isOccupied(Position(0, 3)));
+
+    // Boards too large for the bitsets search sorted lines instead
+    ConfigReader reader("./data/chess_pieces.json");
+    TEST_ASSERT_TRUE(reader.readConfig());
+    GameSettings settings = reader.getGameSettings();
+    settings.board_size = 70;
+    ChessBoard large(settings, reader.getPieceConfigs());
+    TEST_ASSERT_TRUE(large.isSparse());
+    TEST_ASSERT_FALSE(large.isPathClear(Position(0, 0), Position(0, 7)));
+    TEST_ASSERT_TRUE(large.findFirstBlocker(Position(0, 2), 0, 1, blocker));
+    TEST_ASSERT_TRUE(blocker == Position(0, 6));
+    TEST_ASSERT_FALSE(large.findFirstBlocker(Position(0, 7), 0, 1, blocker));
+}
+
+TEST(ChessBoard, SparseBoard)
+{
+    ConfigReader reader("./data/fantasy_chess.json");
+    TEST_ASSERT_TRUE(reader.readConfig());
+    GameSettings settings = reader.getGameSettings();
+    settings.board_size = 300;
+    Ruleset ruleset(settings, reader.getPieceConfigs(), reader.getPortalConfigs());
+    ChessBoard sparse(std::make_shared<const Ruleset>(ruleset));
+    ChessBoard dense(std::make_shared<const Ruleset>(reader.getGameSettings(), reader.getPieceConfigs(),
+                                                     reader.getPortalConfigs()));
+    TEST_ASSERT_TRUE(sparse.isSparse());
+    TEST_ASSERT_FALSE(dense.isSparse());
+
+    // Same answers as the dense board on the squares both have
+    for (int y = 0; y < dense.getSize(); y++) {
+        for (int x = 0; x < dense.getSize(); x++) {
+            Position square(x, y);
+            TEST_ASSERT_EQUAL(dense.isOccupied(square), sparse.isOccupied(square));
+            TEST_ASSERT_EQUAL(dense.getTransition(square) != nullptr, sparse.getTransition(square) != nullptr);
+            if (dense.isOccupied(square))
+                TEST_ASSERT_EQUAL(dense.getHandle(*dense.getPieceAtPosition(square)),
+                                  sparse.getHandle(*sparse.getPieceAtPosition(square)));
+        }
+    }
+
+    // Lines run on past the dense board
+    Position blocker;
+    TEST_ASSERT_FALSE(sparse.findFirstBlocker(Position(0, 7), 0, 1, blocker));
+    TEST_ASSERT_TRUE(sparse.isPathClear(Position(7, 7), Position(299, 299)));
+    TEST_ASSERT_TRUE(sparse.findFirstBlocker(Position(299, 299), -1, -1, blocker));
+    TEST_ASSERT_TRUE(blocker == Position(7, 7));
+
+    // Squares & lines follow moves, captures & exchanges
+    ChessPiece& rook = *sparse.getPieceAtPosition(Position(7, 7));
+    sparse.movePiece(rook, Position(200, 200));
+    TEST_ASSERT_NULL(sparse.getPieceAtPosition(Position(7, 7)));
+    TEST_ASSERT_TRUE(sparse.getPieceAtPosition(Position(200, 200)) == &rook);
+    TEST_ASSERT_FALSE(sparse.isPathClear(Position(6, 6), Position(299, 299)));
+    TEST_ASSERT_TRUE(sparse.findFirstBlocker(Position(200, 0), 0, 1, blocker));
+    TEST_ASSERT_TRUE(blocker == Position(200, 200));
+
+    sparse.capturePiece(&rook);
+    TEST_ASSERT_FALSE(sparse.isOccupied(Position(200, 200)));
+    TEST_ASSERT_FALSE(sparse.findFirstBlocker(Position(200, 0), 0, 1, blocker));
+    sparse.restorePiece();
+    TEST_ASSERT_TRUE(sparse.getPieceAtPosition(Position(200, 200)) == &rook);
+
+    ChessPiece& king = *sparse.getKingOfTeam(WHITE);
+    Position king_square = king.position;
+    sparse.exchangePiecePositions(rook, king);
+    TEST_ASSERT_TRUE(sparse.getPieceAtPosition(Position(200, 200)) == &king);
+    TEST_ASSERT_TRUE(sparse.getPieceAtPosition(king_square) == &rook);
+
+    // Memory grows with the board side, not its area
+    TEST_ASSERT_TRUE(sparse.getHeapUsage() < 300 * 300);
+}
+
+TEST(ChessBoard, PositionNotation)
+{
+    char text[512];
+    std::size_t length = writePosition(*board, WHITE, 0, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w 0 -", std::string(text, length).c_str());
+    TEST_ASSERT_TRUE(length <= getMaxNotationLength(*board));
+    TEST_ASSERT_EQUAL(0, writePosition(*board, WHITE, 0, text, length - 1));
+
+    // Positions of a game with portals read back into a fresh board
+    std::shared_ptr<const Ruleset> ruleset = Ruleset::load("./data/fantasy_chess.json");
+    GameManager game(ruleset);
+    ChessBoard loaded(ruleset);
+    std::uint32_t seed = 13;
+    while (!game.isGameOver() && game.getMoveCount() < 120) {
+        std::string notation = game.getPosition();
+        team_t player;
+        int move_count;
+        TEST_ASSERT_TRUE(readPosition(notation, loaded, player, move_count));
+        TEST_ASSERT_EQUAL(game.getCurrentPlayer(), player);
+        TEST_ASSERT_EQUAL(game.getMoveCount(), move_count);
+        TEST_ASSERT_EQUAL_UINT64(game.getBoard().getPositionHash(), loaded.getPositionHash());
+        length = writePosition(loaded, player, move_count, text, sizeof(text));
+        TEST_ASSERT_EQUAL_STRING(notation.c_str(), std::string(text, length).c_str());
+
+        std::vector<Move> moves = game.getLegalMoves();
+        seed = seed * 1664525u + 1013904223u;
+        TEST_ASSERT_TRUE(game.playTurn(moves[(seed >> 8) % moves.size()]));
+    }
+
+    // Malformed text leaves the board as it was
+    std::uint64_t hash = loaded.getPositionHash();
+    const char* malformed[] = {
+        "", "rnbqkbnr/pppppppp/10/10/10/10/PPPPPPPP/RNBQKBNR w 0 -",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBN w 0 -",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR/8 w 0 -",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBZR w 0 -",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x 0 -",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w -1 -",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w 0 9:1",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w 0 0:1,",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w 0 0:1x",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w 0 - ",
+    };
+    for (const char* notation : malformed) {
+        team_t player;
+        int move_count;
+        TEST_ASSERT_FALSE(readPosition(notation, loaded, player, move_count));
+        TEST_ASSERT_EQUAL_UINT64(hash, loaded.getPositionHash());
+    }
+
+    // Runs of empty squares take as many digits as the board needs
+    ConfigReader reader("./data/chess_pieces.json");
+    TEST_ASSERT_TRUE(reader.readConfig());
+    GameSettings settings = reader.getGameSettings();
+    settings.board_size = 70;
+    ChessBoard large(settings, reader.getPieceConfigs());
+    large.movePiece(*large.getPieceAtPosition(Position(4, 1)), Position(69, 69));
+    std::string notation(getMaxNotationLength(large), ' ');
+    notation.resize(writePosition(large, BLACK, 1, notation.data(), notation.size()));
+    TEST_ASSERT_EQUAL_STRING("69P*/70/", notation.substr(0, 8).c_str());
+    TEST_ASSERT_TRUE(notation.find("/rnbqkbnr62/") != std::string::npos);
+
+    ChessBoard copy(settings, reader.getPieceConfigs());
+    team_t player;
+    int move_count;
+    TEST_ASSERT_TRUE(readPosition(notation, copy, player, move_count));
+    TEST_ASSERT_EQUAL(BLACK, player);
+    TEST_ASSERT_EQUAL_UINT64(large.getPositionHash(), copy.getPositionHash());
+
+    // Positions of more pieces than are read in one pass
+    std::string crowded;
+    for (int y = 69; y >= 0; y--)
+        crowded += (y < 20 ? std::string(70, 'P') : "70") + (y > 0 ? "/" : "");
+    crowded += " w 0 -";
+    TEST_ASSERT_FALSE(readPosition(crowded + "x", copy, player, move_count));
+    TEST_ASSERT_EQUAL_UINT64(large.getPositionHash(), copy.getPositionHash());
+    TEST_ASSERT_TRUE(readPosition(crowded, copy, player, move_count));
+    TEST_ASSERT_EQUAL(1400, copy.getPieces().size());
+    notation.resize(getMaxNotationLength(copy));
+    notation.resize(writePosition(copy, WHITE, 0, notation.data(), notation.size()));
+    TEST_ASSERT_EQUAL_STRING(crowded.c_str(), notation.c_str());
+}
+
 TEST_GROUP_RUNNER(ChessBoard)
 {
   RUN_TEST_CASE(ChessBoard, BoardInitialization);
@@ -166,7 +371,11 @@ TEST_GROUP_RUNNER(ChessBoard)
   RUN_TEST_CASE(ChessBoard, RemovePiece);
   RUN_TEST_CASE(ChessBoard, AddPiece);
   RUN_TEST_CASE(ChessBoard, AddPortal);
+  RUN_TEST_CASE(ChessBoard, PortalIndex);
   RUN_TEST_CASE(ChessBoard, GetPieceAtPosition);
   RUN_TEST_CASE(ChessBoard, GetKingOfTeam);
   RUN_TEST_CASE(ChessBoard, ExchangePiecePositions);
+  RUN_TEST_CASE(ChessBoard, Occupancy);
+  RUN_TEST_CASE(ChessBoard, SparseBoard);
+  RUN_TEST_CASE(ChessBoard, PositionNotation);
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "ConfigReader.hpp"
+#include "unity.h"
+#include "unity_fixture.h"
+
+static ConfigReader* reader;
+
+TEST_GROUP(ConfigReader);
+
+TEST_SETUP(ConfigReader)
+{
+    reader = new ConfigReader("inline.json");
+}
+
+TEST_TEAR_DOWN(ConfigReader)
+{
+    delete reader;
+}
+
+TEST(ConfigReader, ReadPortals)
+{
+    ConfigReader file_reader("./data/fantasy_color.json");
+    TEST_ASSERT_TRUE(file_reader.readConfig());
+    TEST_ASSERT_EQUAL(8, file_reader.getGameSettings().board_size);
+    TEST_ASSERT_EQUAL(6, file_reader.getPieceConfigs().size());
+
+    const PieceConfig& pawn = file_reader.getPieceConfigs()[0];
+    TEST_ASSERT_EQUAL_STRING("pawn", pawn.type.c_str());
+    TEST_ASSERT_EQUAL(8, pawn.white_positions.size());
+    TEST_ASSERT_EQUAL(2, pawn.movement.first_move_forward);
+
+    const std::vector<PortalConfig>& portals = file_reader.getPortalConfigs();
+    TEST_ASSERT_EQUAL(3, portals.size());
+    TEST_ASSERT_EQUAL_STRING("X", portals[1].id.c_str());
+    TEST_ASSERT_TRUE(portals[1].positions.exit == Position(7, 2));
+    TEST_ASSERT_EQUAL(5, portals[1].properties.cooldown);
+    TEST_ASSERT_EQUAL(2, portals[2].properties.allowed_colors.size());
+    TEST_ASSERT_TRUE(portals[2].properties.preserve_direction);
+}
+
+TEST(ConfigReader, IgnoreUnknownKeys)
+{
+    TEST_ASSERT_TRUE(reader->parseConfig(
+        "{ \"comment\": { \"pieces\": [1, 2] },\n"
+        "  \"game_settings\": { \"name\": \"tiny\", \"board_size\": 3, \"turn_limit\": 5, \"theme\": [] },\n"
+        "  \"pieces\": [ { \"type\": \"king\", \"king_type\": true, \"count\": 1,\n"
+        "                \"positions\": { \"white\": [ { \"x\": 0, \"y\": 0 } ],\n"
+        "                               \"black\": [ { \"x\": 2, \"y\": 2 } ] },\n"
+        "                \"movement\": { \"sideways\": 1, \"glow\": true } } ] }"));
+    TEST_ASSERT_EQUAL_STRING("tiny", reader->getGameSettings().name.c_str());
+    TEST_ASSERT_EQUAL(1, reader->getPieceConfigs().size());
+    TEST_ASSERT_TRUE(reader->getPieceConfigs()[0].king_type);
+    TEST_ASSERT_TRUE(reader->getPieceConfigs()[0].black_positions[0] == Position(2, 2));
+    TEST_ASSERT_EQUAL(0, reader->getPortalConfigs().size());
+    TEST_ASSERT_EQUAL_STRING("", reader->getError().c_str());
+}
+
+TEST(ConfigReader, ErrorLocations)
+{
+    // Syntax error on the second line
+    TEST_ASSERT_FALSE(reader->parseConfig("{\n  \"game_settings\": { \"name\" \"x\" } }"));
+    TEST_ASSERT_EQUAL(0, reader->getError().rfind("2:31: ", 0));
+
+    // Wrong type
+    TEST_ASSERT_FALSE(reader->parseConfig(
+        "{ \"game_settings\": {\n  \"name\": \"x\",\n  \"board_size\": \"big\" } }"));
+    TEST_ASSERT_EQUAL_STRING("3:21: expected a number for 'board_size'", reader->getError().c_str());
+
+    // Missing key, reported at the end of its object
+    TEST_ASSERT_FALSE(reader->parseConfig(
+        "{ \"game_settings\": { \"name\": \"x\", \"board_size\": 8, \"turn_limit\": 1 },\n"
+        "  \"pieces\": [ { \"type\": \"rook\", \"count\": 1,\n"
+        "                \"positions\": { \"white\": [ { \"x\": 0 } ] } } ] }"));
+    TEST_ASSERT_EQUAL_STRING("3:52: missing key 'y'", reader->getError().c_str());
+}
+
+TEST_GROUP_RUNNER(ConfigReader)
+{
+    RUN_TEST_CASE(ConfigReader, ReadPortals);
+    RUN_TEST_CASE(ConfigReader, IgnoreUnknownKeys);
+    RUN_TEST_CASE(ConfigReader, ErrorLocations);
+}
@@ -0,0 +1,163 @@
+#include "Engine.hpp"
+#include "Ponderer.hpp"
+#include "UciProtocol.hpp"
+#include "unity.h"
+#include "unity_fixture.h"
+
+#include <sstream>
+#include <thread>
+
+static ConfigReader* reader;
+static GameManager* chess;
+
+TEST_GROUP(Engine);
+
+TEST_SETUP(Engine)
+{
+    reader = new ConfigReader("./data/chess_pieces.json");
+    if (!reader->readConfig()) {
+        TEST_FAIL_MESSAGE("Failed to read configuration file");
+    }
+
+    chess = new GameManager(reader->getGameSettings(), reader->getPieceConfigs(), reader->getPortalConfigs());
+}
+
+TEST_TEAR_DOWN(Engine)
+{
+    delete chess;
+    delete reader;
+}
+
+TEST(Engine, MoveNotation)
+{
+    Move move;
+    TEST_ASSERT_TRUE(parseMove("e2e4", move));
+    TEST_ASSERT_TRUE(move == Move(Position(4, 1), Position(4, 3)));
+    TEST_ASSERT_TRUE(parseMove("a10b12", move));
+    TEST_ASSERT_TRUE(move == Move(Position(0, 9), Position(1, 11)));
+
+    TEST_ASSERT_FALSE(parseMove("e2", move));
+    TEST_ASSERT_FALSE(parseMove("e2e4x", move));
+    TEST_ASSERT_FALSE(parseMove("E2e4", move));
+    TEST_ASSERT_FALSE(parseMove("e0e4", move));
+
+    // Files past z take more letters
+    TEST_ASSERT_TRUE(parseMove("z1aa1", move));
+    TEST_ASSERT_TRUE(move == Move(Position(25, 0), Position(26, 0)));
+    TEST_ASSERT_TRUE(parseMove("zz300aaa1", move));
+    TEST_ASSERT_TRUE(move == Move(Position(701, 299), Position(702, 0)));
+
+    std::ostringstream text;
+    text << Move(Position(6, 0), Position(5, 2));
+    TEST_ASSERT_EQUAL_STRING("g1f3", text.str().c_str());
+    text.str("");
+    text << Move(Position(27, 127), Position(255, 255));
+    TEST_ASSERT_EQUAL_STRING("ab128iv256", text.str().c_str());
+}
+
+TEST(Engine, CopyGame)
+{
+    TEST_ASSERT_TRUE(chess->playTurn(Move(Position(4, 1), Position(4, 3))));
+
+    GameManager copy(*chess);
+    TEST_ASSERT_TRUE(copy.playTurn(Move(Position(4, 6), Position(4, 4))));
+
+    // The original game is not affected by the copy
+    TEST_ASSERT_EQUAL(chess->getCurrentPlayer(), BLACK);
+    TEST_ASSERT_NULL(chess->getBoard().getPieceAtPosition(Position(4, 4)));
+    TEST_ASSERT_EQUAL(copy.getCurrentPlayer(), WHITE);
+    TEST_ASSERT_NOT_NULL(copy.getBoard().getPieceAtPosition(Position(4, 4)));
+}
+
+TEST(Engine, FindsMateInOne)
+{
+    TEST_ASSERT_TRUE(chess->playTurn(Position(5, 1), Position(5, 2))); // f2 f3
+    TEST_ASSERT_TRUE(chess->playTurn(Position(4, 6), Position(4, 4))); // e7 e5
+    TEST_ASSERT_TRUE(chess->playTurn(Position(6, 1), Position(6, 3))); // g2 g4
+
+    Engine engine(*chess->getRuleset());
+    std::atomic<bool> stop(false);
+    SearchLimits limits;
+    limits.depth = 2;
+
+    SearchResult result = engine.search(*chess, limits, stop);
+    TEST_ASSERT_TRUE(result.has_move);
+    TEST_ASSERT_TRUE(result.best_move == Move(Position(3, 7), Position(7, 3))); // Qd8 h4
+    TEST_ASSERT_EQUAL(Engine::MATE_SCORE - 1, result.score);
+}
+
+TEST(Engine, ProtocolSearch)
+{
+    std::ostringstream out;
+    {
+        UciProtocol protocol(out, "./data/chess_pieces.json");
+        TEST_ASSERT_TRUE(protocol.handleCommand("uci"));
+        TEST_ASSERT_TRUE(protocol.handleCommand("isready"));
+        TEST_ASSERT_TRUE(protocol.handleCommand("position startpos moves f2f3 e7e5 g2g4"));
+        TEST_ASSERT_TRUE(protocol.handleCommand("go depth 2"));
+        protocol.waitForSearch();
+        TEST_ASSERT_FALSE(protocol.handleCommand("quit"));
+    }
+
+    std::string text = out.str();
+    TEST_ASSERT_TRUE(text.find("uciok\n") != std::string::npos);
+    TEST_ASSERT_TRUE(text.find("readyok\n") != std::string::npos);
+    TEST_ASSERT_TRUE(text.find("bestmove d8h4\n") != std::string::npos);
+}
+
+TEST(Engine, ProtocolStop)
+{
+    std::ostringstream out;
+    UciProtocol protocol(out, "./data/chess_pieces.json");
+    TEST_ASSERT_TRUE(protocol.handleCommand("position startpos moves e2e4"));
+    TEST_ASSERT_TRUE(protocol.handleCommand("go infinite"));
+
+    auto start = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(protocol.handleCommand("isready"));
+    TEST_ASSERT_TRUE(protocol.handleCommand("stop"));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    TEST_ASSERT_TRUE(elapsed < std::chrono::milliseconds(500));
+    TEST_ASSERT_TRUE(out.str().find("readyok\n") != std::string::npos);
+    TEST_ASSERT_TRUE(out.str().find("bestmove ") != std::string::npos);
+}
+
+TEST(Engine, Ponderer)
+{
+    TEST_ASSERT_TRUE(chess->playTurn(Position(5, 1), Position(5, 2))); // f2 f3
+    TEST_ASSERT_TRUE(chess->playTurn(Position(4, 6), Position(4, 4))); // e7 e5
+    TEST_ASSERT_TRUE(chess->playTurn(Position(6, 1), Position(6, 3))); // g2 g4
+
+    Ponderer ponderer(*chess->getRuleset());
+    ponderer.start(*chess);
+    std::vector<Move> moves = ponderer.getLegalMoves();
+    TEST_ASSERT_EQUAL(chess->getLegalMoves().size(), moves.size());
+    TEST_ASSERT_FALSE(ponderer.isKingUnderCheck());
+
+    // The hint shows up in the background, mates end the search early
+    Move hint;
+    int depth = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!ponderer.getHint(hint, depth) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    TEST_ASSERT_EQUAL(1, depth);
+    TEST_ASSERT_TRUE(hint == Move(Position(3, 7), Position(7, 3))); // Qd8 h4
+
+    // Retargeting drops the results of the last position
+    TEST_ASSERT_TRUE(chess->playTurn(hint));
+    ponderer.start(*chess);
+    TEST_ASSERT_TRUE(ponderer.getLegalMoves().empty());
+    TEST_ASSERT_TRUE(ponderer.isKingUnderCheck());
+    ponderer.stop();
+    TEST_ASSERT_FALSE(ponderer.getHint(hint, depth));
+}
+
+TEST_GROUP_RUNNER(Engine)
+{
+    RUN_TEST_CASE(Engine, MoveNotation);
+    RUN_TEST_CASE(Engine, CopyGame);
+    RUN_TEST_CASE(Engine, FindsMateInOne);
+    RUN_TEST_CASE(Engine, ProtocolSearch);
+    RUN_TEST_CASE(Engine, ProtocolStop);
+    RUN_TEST_CASE(Engine, Ponderer);
+}
@@ -1,8 +1,18 @@
+#include "GameLog.hpp"
 #include "GameManager.hpp"
 #include "PortalSystem.hpp"
+#include "PositionIndex.hpp"
 #include "unity.h"
 #include "unity_fixture.h"
 
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <thread>
+
+#include <unistd.h>
+
 static GameManager* chess;
 
 TEST_GROUP(GameManager);
@@ -156,6 +166,483 @@ TEST(GameManager, Stalemate)
     TEST_ASSERT_EQUAL(chess->getWinner(), TIE);
 }
 
+TEST(GameManager, SharedRuleset)
+{
+    std::shared_ptr<const Ruleset> ruleset = chess->getRuleset();
+    GameManager other(ruleset);
+    TEST_ASSERT_TRUE(other.getRuleset() == ruleset);
+
+    // Games sharing a ruleset keep their own state
+    TEST_ASSERT_TRUE(other.playTurn(Position(4, 1), Position(4, 3)));
+    TEST_ASSERT_EQUAL(other.getMoveCount(), 1);
+    TEST_ASSERT_EQUAL(chess->getMoveCount(), 0);
+    TEST_ASSERT_NOT_NULL(chess->getBoard().getPieceAtPosition(Position(4, 1)));
+
+    int pawn = ruleset->findPieceType("pawn");
+    TEST_ASSERT_TRUE(pawn >= 0);
+    TEST_ASSERT_FALSE(ruleset->getPieceType(pawn).forward_captures);
+    TEST_ASSERT_EQUAL(ruleset->findPieceType("dragon"), -1);
+}
+
+TEST(GameManager, GameOverCache)
+{
+    TEST_ASSERT_TRUE(chess->playTurn(Position(5, 1), Position(5, 2)));
+    TEST_ASSERT_TRUE(chess->playTurn(Position(4, 6), Position(4, 4)));
+    TEST_ASSERT_TRUE(chess->playTurn(Position(6, 1), Position(6, 3)));
+
+    // Transposed move order reaches the same position hash
+    GameManager other(chess->getRuleset());
+    TEST_ASSERT_TRUE(other.playTurn(Position(6, 1), Position(6, 3)));
+    TEST_ASSERT_TRUE(other.playTurn(Position(4, 6), Position(4, 4)));
+    TEST_ASSERT_FALSE(other.getBoard().getPositionHash() == chess->getBoard().getPositionHash());
+    TEST_ASSERT_TRUE(other.playTurn(Position(5, 1), Position(5, 2)));
+    TEST_ASSERT_TRUE(other.getBoard().getPositionHash() == chess->getBoard().getPositionHash());
+
+    // A copy hitting the cached mate still ends its game
+    GameManager copy(*chess);
+    TEST_ASSERT_TRUE(chess->playTurn(Position(3, 7), Position(7, 3))); // Checkmate by queen
+    TEST_ASSERT_TRUE(chess->isGameOver());
+    TEST_ASSERT_TRUE(copy.playTurn(Position(3, 7), Position(7, 3)));
+    TEST_ASSERT_TRUE(copy.isGameOver());
+    TEST_ASSERT_EQUAL(copy.getWinner(), BLACK);
+}
+
+TEST(GameManager, MoveCache)
+{
+    std::vector<Move> moves = chess->getLegalMoves();
+    TEST_ASSERT_EQUAL(20, moves.size());
+    MoveCacheStats stats = chess->getMoveCacheStats();
+    TEST_ASSERT_EQUAL(0, stats.hits);
+    TEST_ASSERT_EQUAL(1, stats.size);
+
+    TEST_ASSERT_EQUAL(20, chess->getLegalMoves().size());
+    TEST_ASSERT_EQUAL(1, chess->getMoveCacheStats().hits);
+
+    // Turns are checked in full whatever the cache holds, then the game over
+    // check of the new position fills it
+    TEST_ASSERT_FALSE(chess->playTurn(Position(4, 1), Position(4, 4)));
+    TEST_ASSERT_EQUAL_STRING("Invalid Move", chess->getTurnError().c_str());
+    TEST_ASSERT_TRUE(chess->playTurn(Position(4, 1), Position(4, 3)));
+    TEST_ASSERT_EQUAL(1, chess->getMoveCacheStats().hits);
+    TEST_ASSERT_NOT_NULL(chess->getBoard().getPieceAtPosition(Position(4, 3)));
+
+    // Copies share the cache
+    GameManager copy(*chess);
+    copy.getLegalMoves();
+    TEST_ASSERT_EQUAL(2, chess->getMoveCacheStats().size);
+}
+
+TEST(GameManager, AreMovesLegal)
+{
+    std::shared_ptr<const Ruleset> rulesets[] = {
+        chess->getRuleset(), Ruleset::load("./data/fantasy_chess.json")
+    };
+
+    for (const std::shared_ptr<const Ruleset>& ruleset : rulesets) {
+        GameManager game(ruleset);
+        std::uint32_t seed = 5;
+
+        for (int ply = 0; ply < 60 && !game.isGameOver(); ply++) {
+            // Every piece of both teams to every square, empty squares included
+            const ChessBoard& board = game.getBoard();
+            std::vector<Move> moves;
+            std::vector<MoveQuery> queries;
+            for (int from = 0; from < board.getSize() * board.getSize(); from += 3) {
+                Position origin(from % board.getSize(), from / board.getSize());
+                for (int y = 0; y < board.getSize(); y++) {
+                    for (int x = 0; x < board.getSize(); x++) {
+                        moves.emplace_back(origin, Position(x, y));
+                        queries.push_back(MoveQuery{ board.getPieceAtPosition(origin), Position(x, y) });
+                    }
+                }
+            }
+
+            std::vector<bool> legal = game.areMovesLegal(moves);
+            MoveValidator validator(board);
+            std::vector<bool> valid = validator.validateMoves(queries);
+            TEST_ASSERT_EQUAL(moves.size(), legal.size());
+            for (std::size_t i = 0; i < moves.size(); i++) {
+                TEST_ASSERT_EQUAL(game.isMoveLegal(moves[i]), legal[i]);
+                TEST_ASSERT_EQUAL(queries[i].piece != nullptr
+                                  && validator.validateMove(*queries[i].piece, queries[i].destination), valid[i]);
+            }
+
+            std::vector<Move> played = game.getLegalMoves();
+            seed = seed * 1664525u + 1013904223u;
+            game.playTurn(played[(seed >> 8) % played.size()]);
+        }
+    }
+}
+
+/**
+ * @brief Run every query of a snapshot, flattened into numbers
+ */
+static std::vector<int> analyse(const PositionSnapshot& snapshot)
+{
+    std::vector<int> results;
+    int size = snapshot.getBoard().getSize();
+    for (int from = 0; from < size * size; from++) {
+        Position origin(from % size, from / size);
+        results.push_back(static_cast<int>(snapshot.getPossibleMoves(origin).size()));
+        for (int to = 0; to < size * size; to++)
+            results.push_back(snapshot.validateMove(origin, Position(to % size, to / size)));
+    }
+
+    for (team_t team : { WHITE, BLACK }) {
+        const ChessPiece* checking = snapshot.getCheckingPiece(team);
+        results.push_back(snapshot.isKingUnderCheck(team));
+        results.push_back(checking == nullptr ? -1 : checking->position.y * size + checking->position.x);
+    }
+    results.push_back(snapshot.isGameOver());
+    results.push_back(snapshot.getWinner());
+    return results;
+}
+
+TEST(GameManager, ConcurrentQueries)
+{
+    TEST_ASSERT_TRUE(chess->playTurn(Position(5, 1), Position(5, 2)));
+    TEST_ASSERT_TRUE(chess->playTurn(Position(4, 6), Position(4, 4)));
+    TEST_ASSERT_TRUE(chess->playTurn(Position(6, 1), Position(6, 3)));
+    std::shared_ptr<const PositionSnapshot> snapshots[] = {
+        chess->getSnapshot(), nullptr
+    };
+    TEST_ASSERT_TRUE(chess->playTurn(Position(3, 7), Position(7, 3))); // Checkmate by queen
+    snapshots[1] = chess->getSnapshot();
+
+    TEST_ASSERT_FALSE(snapshots[0]->isGameOver());
+    TEST_ASSERT_FALSE(snapshots[0]->isKingUnderCheck(WHITE));
+    TEST_ASSERT_TRUE(snapshots[1]->isGameOver());
+    TEST_ASSERT_TRUE(snapshots[1]->isKingUnderCheck(WHITE));
+    TEST_ASSERT_TRUE(snapshots[1]->getCheckingPiece(WHITE)->position == Position(7, 3));
+    TEST_ASSERT_EQUAL(BLACK, snapshots[1]->getWinner());
+
+    // A game with portals keeps playing while its snapshot is analysed
+    GameManager fantasy(Ruleset::load("./data/fantasy_chess.json"));
+    std::uint32_t seed = 9;
+    for (int ply = 0; ply < 12; ply++) {
+        std::vector<Move> moves = fantasy.getLegalMoves();
+        seed = seed * 1664525u + 1013904223u;
+        fantasy.playTurn(moves[(seed >> 8) % moves.size()]);
+    }
+    std::shared_ptr<const PositionSnapshot> snapshot = fantasy.getSnapshot();
+
+    std::vector<int> expected[] = { analyse(*snapshots[0]), analyse(*snapshots[1]), analyse(*snapshot) };
+    std::atomic<int> mismatches = 0;
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 8; thread++) {
+        threads.emplace_back([&, thread]() {
+            for (int round = 0; round < 5; round++) {
+                if (analyse(*snapshots[(thread + round) % 2]) != expected[(thread + round) % 2])
+                    mismatches++;
+                if (analyse(*snapshot) != expected[2])
+                    mismatches++;
+            }
+        });
+    }
+
+    while (!fantasy.isGameOver() && fantasy.getMoveCount() < 40) {
+        std::vector<Move> moves = fantasy.getLegalMoves();
+        seed = seed * 1664525u + 1013904223u;
+        fantasy.playTurn(moves[(seed >> 8) % moves.size()]);
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    TEST_ASSERT_EQUAL(0, mismatches.load());
+    TEST_ASSERT_EQUAL(12, snapshot->getMoveCount());
+}
+
+TEST(GameManager, ParallelLegalMoveSearch)
+{
+    std::shared_ptr<ThreadPool> pool = std::make_shared<ThreadPool>(3);
+    chess->setParallelism(pool, 1);
+    TEST_ASSERT_TRUE(chess->playTurn(Position(5, 1), Position(5, 2)));
+    TEST_ASSERT_TRUE(chess->playTurn(Position(4, 6), Position(4, 4)));
+    TEST_ASSERT_TRUE(chess->playTurn(Position(6, 1), Position(6, 3)));
+    TEST_ASSERT_TRUE(chess->playTurn(Position(3, 7), Position(7, 3)));
+    TEST_ASSERT_TRUE(chess->isGameOver());
+    TEST_ASSERT_EQUAL(BLACK, chess->getWinner());
+
+    // Serial & parallel searches agree over whole games
+    for (const char* config_path : { "./data/chess_pieces.json", "./data/fantasy_chess.json" }) {
+        std::shared_ptr<const Ruleset> ruleset = Ruleset::load(config_path);
+        GameManager serial(ruleset), parallel(ruleset);
+        parallel.setParallelism(pool, 1);
+
+        std::uint32_t seed = 3;
+        while (!serial.isGameOver() && serial.getMoveCount() < 200) {
+            std::vector<Move> moves = serial.getLegalMoves();
+            seed = seed * 1664525u + 1013904223u;
+            const Move& move = moves[(seed >> 8) % moves.size()];
+            TEST_ASSERT_TRUE(serial.playTurn(move));
+            TEST_ASSERT_TRUE(parallel.playTurn(move));
+            TEST_ASSERT_EQUAL(serial.isGameOver(), parallel.isGameOver());
+        }
+        TEST_ASSERT_EQUAL(serial.getWinner(), parallel.getWinner());
+    }
+}
+
+TEST(GameManager, UndoRedoSeek)
+{
+    // Take back & replay the mate
+    TEST_ASSERT_FALSE(chess->undo());
+    TEST_ASSERT_TRUE(chess->playTurn(Position(5, 1), Position(5, 2)));
+    TEST_ASSERT_TRUE(chess->playTurn(Position(4, 6), Position(4, 4)));
+    TEST_ASSERT_TRUE(chess->playTurn(Position(6, 1), Position(6, 3)));
+    TEST_ASSERT_TRUE(chess->playTurn(Position(3, 7), Position(7, 3)));
+    TEST_ASSERT_TRUE(chess->undo());
+    TEST_ASSERT_FALSE(chess->isGameOver());
+    TEST_ASSERT_EQUAL(BLACK, chess->getCurrentPlayer());
+    TEST_ASSERT_EQUAL(3, chess->getMoveCount());
+    TEST_ASSERT_TRUE(chess->redo());
+    TEST_ASSERT_FALSE(chess->redo());
+    TEST_ASSERT_TRUE(chess->isGameOver());
+    TEST_ASSERT_EQUAL(BLACK, chess->getWinner());
+
+    // A game with portals & captures, every position visited again matches
+    GameManager fantasy(Ruleset::load("./data/fantasy_chess.json"));
+    std::vector<std::uint64_t> hashes = { fantasy.getStateHash() };
+    std::vector<std::size_t> move_counts = { fantasy.getLegalMoves().size() };
+    std::uint32_t seed = 5;
+    while (!fantasy.isGameOver() && fantasy.getMoveCount() < 150) {
+        std::vector<Move> moves = fantasy.getLegalMoves();
+        seed = seed * 1664525u + 1013904223u;
+        TEST_ASSERT_TRUE(fantasy.playTurn(moves[(seed >> 8) % moves.size()]));
+        hashes.push_back(fantasy.getStateHash());
+        move_counts.push_back(fantasy.getLegalMoves().size());
+    }
+    int last = fantasy.getMoveCount();
+    TEST_ASSERT_EQUAL(last, static_cast<int>(fantasy.getHistory().size()));
+
+    while (fantasy.undo())
+        TEST_ASSERT_EQUAL_UINT64(hashes[fantasy.getMoveCount()], fantasy.getStateHash());
+    TEST_ASSERT_EQUAL(0, fantasy.getMoveCount());
+    while (fantasy.redo())
+        TEST_ASSERT_EQUAL_UINT64(hashes[fantasy.getMoveCount()], fantasy.getStateHash());
+    TEST_ASSERT_EQUAL(last, fantasy.getMoveCount());
+
+    for (int target : { 3, 100, 64, 0, 95, last, 31, 33 }) {
+        TEST_ASSERT_TRUE(fantasy.seek(target));
+        TEST_ASSERT_EQUAL(target, fantasy.getMoveCount());
+        TEST_ASSERT_EQUAL(target % 2 == 0 ? WHITE : BLACK, fantasy.getCurrentPlayer());
+        TEST_ASSERT_EQUAL_UINT64(hashes[target], fantasy.getStateHash());
+        TEST_ASSERT_EQUAL(move_counts[target], fantasy.getLegalMoves().size());
+    }
+    TEST_ASSERT_FALSE(fantasy.seek(last + 1));
+    TEST_ASSERT_FALSE(fantasy.seek(-1));
+
+    // Playing after going back drops the turns after it
+    TEST_ASSERT_TRUE(fantasy.seek(40));
+    TEST_ASSERT_TRUE(fantasy.playTurn(fantasy.getLegalMoves().back()));
+    TEST_ASSERT_FALSE(fantasy.redo());
+    TEST_ASSERT_EQUAL(41, static_cast<int>(fantasy.getHistory().size()));
+    TEST_ASSERT_FALSE(fantasy.seek(42));
+    TEST_ASSERT_TRUE(fantasy.seek(32));
+    TEST_ASSERT_EQUAL_UINT64(hashes[32], fantasy.getStateHash());
+
+    // Copies keep their own history from where they were copied
+    GameManager copy(fantasy);
+    TEST_ASSERT_EQUAL(32, copy.getHistoryStart());
+    TEST_ASSERT_FALSE(copy.undo());
+    TEST_ASSERT_TRUE(copy.playTurn(copy.getLegalMoves().front()));
+    TEST_ASSERT_TRUE(copy.undo());
+    TEST_ASSERT_EQUAL_UINT64(hashes[32], copy.getStateHash());
+}
+
+TEST(GameManager, LoadPosition)
+{
+    TEST_ASSERT_EQUAL_STRING("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w 0 -", chess->getPosition().c_str());
+
+    // Fool's mate, the game is over as soon as it is loaded
+    const char* mate = "rnb1kbnr/pppp1ppp/8/4p*3/6P*q*/5P*2/PPPPP2P/RNBQKBNR w 4 -";
+    TEST_ASSERT_TRUE(chess->loadPosition(mate));
+    TEST_ASSERT_TRUE(chess->isGameOver());
+    TEST_ASSERT_EQUAL(BLACK, chess->getWinner());
+    TEST_ASSERT_EQUAL(4, chess->getMoveCount());
+    TEST_ASSERT_EQUAL(4, chess->getHistoryStart());
+    TEST_ASSERT_EQUAL_STRING(mate, chess->getPosition().c_str());
+
+    // One move earlier, the history starts at the loaded position
+    TEST_ASSERT_TRUE(chess->loadPosition("rnbqkbnr/pppp1ppp/8/4p*3/6P*1/5P*2/PPPPP2P/RNBQKBNR b 3 -"));
+    TEST_ASSERT_FALSE(chess->isGameOver());
+    TEST_ASSERT_TRUE(chess->playTurn(Position(3, 7), Position(7, 3)));
+    TEST_ASSERT_TRUE(chess->isGameOver());
+    TEST_ASSERT_TRUE(chess->undo());
+    TEST_ASSERT_FALSE(chess->undo());
+
+    // Positions without a king are refused
+    TEST_ASSERT_FALSE(chess->loadPosition("8/8/8/8/8/8/8/4K3 w 0 -"));
+    TEST_ASSERT_FALSE(chess->loadPosition("8/8/8/8/8/8/8/4K3 w 0"));
+    TEST_ASSERT_EQUAL(3, chess->getMoveCount());
+    TEST_ASSERT_EQUAL(BLACK, chess->getCurrentPlayer());
+}
+
+TEST(GameManager, GameLog)
+{
+    std::string path = "/tmp/chess_test_" + std::to_string(getpid()) + ".glog";
+    std::remove(path.c_str());
+
+    // Rules hash alike however the ruleset was built
+    TEST_ASSERT_EQUAL_UINT64(chess->getRuleset()->getRulesHash(),
+                             Ruleset::load("./data/chess_pieces.json")->getRulesHash());
+    TEST_ASSERT_NOT_EQUAL(chess->getRuleset()->getRulesHash(),
+                          Ruleset::load("./data/fantasy_chess.json")->getRulesHash());
+
+    // Fool's mate is logged by its last turn, a running game on request
+    std::shared_ptr<GameLog> log = GameLog::open(path);
+    TEST_ASSERT_NOT_NULL(log.get());
+    chess->setGameLog(log);
+    TEST_ASSERT_TRUE(chess->playTurn(Position(5, 1), Position(5, 2)));
+    TEST_ASSERT_TRUE(chess->playTurn(Position(4, 6), Position(4, 4)));
+    TEST_ASSERT_TRUE(chess->playTurn(Position(6, 1), Position(6, 3)));
+    TEST_ASSERT_TRUE(chess->playTurn(Position(3, 7), Position(7, 3)));
+
+    GameManager running(chess->getRuleset());
+    TEST_ASSERT_TRUE(running.playTurn(Position(4, 1), Position(4, 3)));
+    TEST_ASSERT_TRUE(log->append(running));
+    TEST_ASSERT_EQUAL_UINT64(2, log->getGameCount());
+    log.reset();
+    chess->setGameLog(nullptr);
+
+    std::unique_ptr<GameLogReader> reader = GameLogReader::open(path);
+    TEST_ASSERT_NOT_NULL(reader.get());
+    GameRecord mate, unfinished, record;
+    TEST_ASSERT_TRUE(reader->next(mate));
+    TEST_ASSERT_TRUE(reader->next(unfinished));
+    TEST_ASSERT_FALSE(reader->next(record));
+    TEST_ASSERT_TRUE(reader->isAtEnd());
+
+    TEST_ASSERT_EQUAL(4, mate.move_count);
+    TEST_ASSERT_EQUAL(BLACK_WON, mate.result);
+    TEST_ASSERT_TRUE(mate.getMove(3) == Move(Position(3, 7), Position(7, 3)));
+    TEST_ASSERT_EQUAL(1, unfinished.move_count);
+    TEST_ASSERT_EQUAL(UNFINISHED, unfinished.result);
+
+    GameManager start(chess->getRuleset());
+    std::size_t rejected;
+    TEST_ASSERT_TRUE(replayGame(mate, start, rejected));
+    TEST_ASSERT_EQUAL(4, rejected);
+    TEST_ASSERT_TRUE(replayGame(unfinished, start, rejected));
+
+    // Games ending otherwise & illegal moves are caught
+    record = mate;
+    record.result = WHITE_WON;
+    TEST_ASSERT_FALSE(replayGame(record, start, rejected));
+    TEST_ASSERT_EQUAL(4, rejected);
+
+    std::uint16_t moves[4];
+    std::memcpy(moves, mate.moves, sizeof(moves));
+    moves[2] = static_cast<std::uint16_t>(6 | 1 << 4 | 6 << 8 | 4 << 12); // g2g5
+    record = mate;
+    record.moves = reinterpret_cast<const unsigned char*>(moves);
+    TEST_ASSERT_FALSE(replayGame(record, start, rejected));
+    TEST_ASSERT_EQUAL(2, rejected);
+    reader.reset();
+
+    // A torn record is cut off as the log is opened again
+    std::FILE* file = std::fopen(path.c_str(), "ab");
+    std::fwrite("\x05\0\0\0\0\2", 1, 6, file);
+    std::fclose(file);
+    reader = GameLogReader::open(path);
+    TEST_ASSERT_TRUE(reader->next(record));
+    TEST_ASSERT_TRUE(reader->next(record));
+    TEST_ASSERT_FALSE(reader->next(record));
+    TEST_ASSERT_FALSE(reader->isAtEnd());
+    reader.reset();
+
+    log = GameLog::open(path);
+    TEST_ASSERT_NOT_NULL(log.get());
+    TEST_ASSERT_TRUE(log->append(running));
+    log.reset();
+
+    reader = GameLogReader::open(path);
+    int count = 0;
+    while (reader->next(record))
+        count++;
+    TEST_ASSERT_EQUAL(3, count);
+    TEST_ASSERT_TRUE(reader->isAtEnd());
+    reader.reset();
+    std::remove(path.c_str());
+}
+
+TEST(GameManager, PositionIndex)
+{
+    std::string log_path = "/tmp/chess_test_" + std::to_string(getpid()) + ".glog";
+    std::string index_path = "/tmp/chess_test_" + std::to_string(getpid()) + ".pidx";
+    std::remove(log_path.c_str());
+
+    // Fool's mate twice, then pseudo random games cut off after 40 plies
+    std::shared_ptr<GameLog> log = GameLog::open(log_path);
+    for (int i = 0; i < 2; i++) {
+        GameManager game(chess->getRuleset());
+        game.setGameLog(log);
+        game.playTurn(Position(5, 1), Position(5, 2));
+        game.playTurn(Position(4, 6), Position(4, 4));
+        game.playTurn(Position(6, 1), Position(6, 3));
+        game.playTurn(Position(3, 7), Position(7, 3));
+    }
+    for (std::uint32_t seed = 1; seed <= 32; seed++) {
+        GameManager game(chess->getRuleset());
+        std::uint32_t random = seed;
+        while (!game.isGameOver() && game.getMoveCount() < 40) {
+            std::vector<Move> moves = game.getLegalMoves();
+            random = random * 1664525u + 1013904223u;
+            game.playTurn(moves[(random >> 8) % moves.size()]);
+        }
+        log->append(game);
+    }
+    log.reset();
+
+    // Spill runs of 100 turns, the index is merged from many of them
+    GameManager start(chess->getRuleset());
+    std::map<std::uint64_t, std::uint64_t> expected;
+    {
+        PositionIndexBuilder builder(index_path, start, 100);
+        std::unique_ptr<GameLogReader> reader = GameLogReader::open(log_path);
+        GameRecord record;
+        std::vector<std::uint64_t> positions;
+        std::size_t rejected;
+        while (reader->next(record)) {
+            TEST_ASSERT_TRUE(builder.addGame(record));
+            TEST_ASSERT_TRUE(replayGame(record, start, rejected, &positions));
+            for (std::uint64_t position : positions)
+                expected[position]++;
+        }
+        TEST_ASSERT_TRUE(builder.finish());
+    }
+
+    std::unique_ptr<PositionIndex> index = PositionIndex::open(index_path);
+    TEST_ASSERT_NOT_NULL(index.get());
+    TEST_ASSERT_EQUAL_UINT64(34, index->getGameCount());
+    TEST_ASSERT_EQUAL_UINT64(chess->getRuleset()->getRulesHash(), index->getRulesHash());
+    TEST_ASSERT_TRUE(index->getEntryCount() > PositionIndex::BLOCK_SIZE);
+
+    // Every position of every game, wherever its block begins
+    std::vector<MoveStats> stats;
+    for (const auto& [position, turns] : expected)
+        TEST_ASSERT_EQUAL_UINT64(turns, index->find(position, stats));
+    TEST_ASSERT_EQUAL_UINT64(0, index->find(0x123456789ULL, stats));
+    TEST_ASSERT_EQUAL(0, stats.size());
+
+    // A position reached by moves & loaded from its notation alike
+    GameManager game(chess->getRuleset());
+    TEST_ASSERT_TRUE(game.loadPosition("rnbqkbnr/pppppppp/8/8/8/5P*2/PPPPP1PP/RNBQKBNR b 1 -"));
+    TEST_ASSERT_TRUE(index->find(game.getStateHash(), stats) >= 2);
+    bool found = false;
+    for (const MoveStats& move_stats : stats) {
+        if (move_stats.move == Move(Position(4, 6), Position(4, 4))) {
+            TEST_ASSERT_TRUE(move_stats.games[BLACK_WON] >= 2);
+            found = true;
+        }
+    }
+    TEST_ASSERT_TRUE(found);
+
+    TEST_ASSERT_NULL(PositionIndex::open(log_path).get());
+    index.reset();
+    std::remove(log_path.c_str());
+    std::remove(index_path.c_str());
+}
+
 TEST_GROUP_RUNNER(GameManager)
 {
     RUN_TEST_CASE(GameManager, PlayTurn);
@@ -164,4 +651,14 @@ TEST_GROUP_RUNNER(GameManager)
     RUN_TEST_CASE(GameManager, FoolsMate);
     RUN_TEST_CASE(GameManager, ScholarsMate);
     RUN_TEST_CASE(GameManager, Stalemate);
+    RUN_TEST_CASE(GameManager, SharedRuleset);
+    RUN_TEST_CASE(GameManager, GameOverCache);
+    RUN_TEST_CASE(GameManager, MoveCache);
+    RUN_TEST_CASE(GameManager, AreMovesLegal);
+    RUN_TEST_CASE(GameManager, ConcurrentQueries);
+    RUN_TEST_CASE(GameManager, ParallelLegalMoveSearch);
+    RUN_TEST_CASE(GameManager, UndoRedoSeek);
+    RUN_TEST_CASE(GameManager, LoadPosition);
+    RUN_TEST_CASE(GameManager, GameLog);
+    RUN_TEST_CASE(GameManager, PositionIndex);
 }
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "GameServer.hpp"
+#include "unity.h"
+#include "unity_fixture.h"
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static GameServer* server;
+
+TEST_GROUP(GameServer);
+
+TEST_SETUP(GameServer)
+{
+    server = new GameServer(2);
+    server->addConfig("./data/chess_pieces.json");
+}
+
+TEST_TEAR_DOWN(GameServer)
+{
+    delete server;
+}
+
+TEST(GameServer, Protocol)
+{
+    TEST_ASSERT_EQUAL_STRING("OK PONG", server->handleLine("PING").c_str());
+    TEST_ASSERT_EQUAL_STRING("OK 1", server->handleLine("NEW").c_str());
+    TEST_ASSERT_EQUAL_STRING("OK 2", server->handleLine("NEW ./data/chess_pieces.json").c_str());
+    TEST_ASSERT_EQUAL_STRING("ERR unknown config", server->handleLine("NEW ./data/missing.json").c_str());
+    TEST_ASSERT_EQUAL(2, server->getSessionCount());
+
+    TEST_ASSERT_EQUAL_STRING("OK", server->handleLine("MOVE 1 e2e4").c_str());
+    TEST_ASSERT_EQUAL_STRING("ERR Wrong Player", server->handleLine("MOVE 1 d2d4").c_str());
+    TEST_ASSERT_EQUAL_STRING("ERR Invalid Input", server->handleLine("MOVE 1 e7").c_str());
+    TEST_ASSERT_EQUAL_STRING("OK black 1 running", server->handleLine("STATE 1").c_str());
+    TEST_ASSERT_EQUAL_STRING("OK white 0 running", server->handleLine("STATE 2").c_str());
+
+    std::string moves = server->handleLine("MOVES 2");
+    TEST_ASSERT_TRUE(moves.find(" e2e4") != std::string::npos);
+    TEST_ASSERT_TRUE(moves.find(" g1f3") != std::string::npos);
+    TEST_ASSERT_TRUE(moves.find(" e2e5") == std::string::npos);
+
+    // Fool's mate
+    server->handleLine("MOVE 2 f2f3");
+    server->handleLine("MOVE 2 e7e5");
+    server->handleLine("MOVE 2 g2g4");
+    TEST_ASSERT_EQUAL_STRING("OK GAMEOVER black", server->handleLine("MOVE 2 d8h4").c_str());
+    TEST_ASSERT_EQUAL_STRING("OK", server->handleLine("MOVES 2").c_str());
+
+    std::string stats = server->handleLine("STATS");
+    TEST_ASSERT_TRUE(stats.find("sessions=2 configs=1 ") != std::string::npos);
+    TEST_ASSERT_TRUE(stats.find("turns=6 ") != std::string::npos);
+
+    TEST_ASSERT_EQUAL_STRING("OK", server->handleLine("CLOSE 1").c_str());
+    TEST_ASSERT_EQUAL_STRING("ERR unknown session", server->handleLine("STATE 1").c_str());
+    TEST_ASSERT_EQUAL_STRING("ERR unknown command", server->handleLine("JUMP").c_str());
+}
+
+TEST(GameServer, Configs)
+{
+    TEST_ASSERT_FALSE(server->addConfig("./data/missing.json"));
+    TEST_ASSERT_TRUE(server->addConfig("./data/fantasy_chess.json"));
+
+    // Configs are named by path or file name, anything else is never read
+    std::remove("./data/chess_limit.json.rsc");
+    TEST_ASSERT_EQUAL_STRING("OK 1", server->handleLine("NEW fantasy_chess.json").c_str());
+    TEST_ASSERT_EQUAL_STRING("OK 2", server->handleLine("NEW ./data/fantasy_chess.json").c_str());
+    TEST_ASSERT_EQUAL_STRING("OK 3", server->handleLine("NEW chess_pieces.json").c_str());
+    TEST_ASSERT_EQUAL_STRING("ERR unknown config", server->handleLine("NEW ./data/chess_limit.json").c_str());
+    TEST_ASSERT_EQUAL_STRING("ERR unknown config", server->handleLine("NEW /etc/passwd").c_str());
+    TEST_ASSERT_NULL(std::fopen("./data/chess_limit.json.rsc", "rb"));
+
+    TEST_ASSERT_EQUAL_STRING("OK white 0 running", server->handleLine("STATE 1").c_str());
+    std::string stats = server->handleLine("STATS");
+    TEST_ASSERT_TRUE(stats.find("sessions=3 configs=2 ") != std::string::npos);
+}
+
+TEST(GameServer, UnixSocket)
+{
+    std::string path = "/tmp/chess_test_" + std::to_string(getpid()) + ".sock";
+    TEST_ASSERT_TRUE(server->listenUnix(path));
+    std::thread loop([]() { server->run(); });
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    TEST_ASSERT_EQUAL(0, connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+
+    // Pipelined requests are answered in order
+    std::string requests = "NEW\nMOVE 1 e2e4\nMOVE 1 e7e5\nSTATE 1\n";
+    TEST_ASSERT_EQUAL(requests.size(), write(fd, requests.data(), requests.size()));
+
+    std::string expected = "OK 1\nOK\nOK\nOK white 2 running\n";
+    std::string received;
+    char buffer[256];
+    while (received.size() < expected.size()) {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+        received.append(buffer, length);
+    }
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), received.c_str());
+
+    close(fd);
+    server->stop();
+    loop.join();
+}
+
+TEST(GameServer, HalfClose)
+{
+    std::string path = "/tmp/chess_test_" + std::to_string(getpid()) + ".sock";
+    TEST_ASSERT_TRUE(server->listenUnix(path));
+    std::thread loop([]() { server->run(); });
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    TEST_ASSERT_EQUAL(0, connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+
+    // Requests sent before the client stops writing are all answered, even a
+    // last one without line break, then the server closes
+    std::string requests = "NEW\nMOVE 1 e2e4\nSTATE 1";
+    TEST_ASSERT_EQUAL(requests.size(), write(fd, requests.data(), requests.size()));
+    TEST_ASSERT_EQUAL(0, shutdown(fd, SHUT_WR));
+
+    std::string received;
+    char buffer[256];
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+        received.append(buffer, length);
+    TEST_ASSERT_EQUAL(0, length);
+    TEST_ASSERT_EQUAL_STRING("OK 1\nOK\nOK black 1 running\n", received.c_str());
+
+    close(fd);
+    server->stop();
+    loop.join();
+}
+
+TEST_GROUP_RUNNER(GameServer)
+{
+    RUN_TEST_CASE(GameServer, Protocol);
+    RUN_TEST_CASE(GameServer, Configs);
+    RUN_TEST_CASE(GameServer, UnixSocket);
+    RUN_TEST_CASE(GameServer, HalfClose);
+}
@@ -1,8 +1,15 @@
 #include "ChessBoard.hpp"
+#include "GameManager.hpp"
 #include "MoveValidator.hpp"
 #include "unity.h"
 #include "unity_fixture.h"
 
+#include <map>
+
+#ifdef CHESS_VARIANT
+#include "VariantRules.hpp"
+#endif
+
 static ChessBoard* board;
 static MoveValidator* validator;
 
@@ -18,7 +25,7 @@ TEST_SETUP(MoveValidator)
     // Print game settings
     auto settings = reader.getGameSettings();
     board = new ChessBoard(settings, reader.getPieceConfigs());
-    validator = new MoveValidator(*board, reader.getPieceConfigs());
+    validator = new MoveValidator(*board);
 }
 
 TEST_TEAR_DOWN(MoveValidator)
@@ -123,13 +130,13 @@ TEST(MoveValidator, ValidateMove)
 
                 if (validator->validateMove(piece, pos)) {
                     // We found valid move, ensure it is in moves
-                    std::string failMessage = piece.type + ": did not expect valid move at (" + 
+                    std::string failMessage = board->getTypeName(piece) + ": did not expect valid move at (" + 
                         std::to_string(pos.x) + ", " + std::to_string(pos.y) + ")";
 
                     TEST_ASSERT_EQUAL_MESSAGE(moves.count(pos), 1, failMessage.c_str());
                 } else {
                     // We found invalid move, ensure it is _not_ in moves
-                    std::string failMessage = piece.type + ": did not expect invalid move at (" + 
+                    std::string failMessage = board->getTypeName(piece) + ": did not expect invalid move at (" + 
                         std::to_string(pos.x) + ", " + std::to_string(pos.y) + ")";
 
                     TEST_ASSERT_EQUAL_MESSAGE(moves.count(pos), 0, failMessage.c_str());
@@ -147,13 +154,272 @@ TEST(MoveValidator, ValidatePortalUse)
     board->addPortal(portal);
     TEST_ASSERT_TRUE(validator->validatePortalUse(*board->getPieceAtPosition(Position(0,0)), portal)); // White can use
     TEST_ASSERT_FALSE(validator->validatePortalUse(*board->getPieceAtPosition(Position(0,7)), portal)); // Black can't
-    portal.current_cooldown = portal.cooldown;
+    portal.ready_at = board->getPortalClock() + portal.cooldown;
     TEST_ASSERT_FALSE(validator->validatePortalUse(*board->getPieceAtPosition(Position(0,0)), portal));
 }
 
+TEST(MoveValidator, PortalMoves)
+{
+    board->addPortal(Portal("P", Position(0, 3), Position(5, 5), false, true, false, 2));
+    board->addPortal(Portal("Q", Position(0, 4), Position(6, 5), false, false, true, 0)); // Black only
+    board->addPortal(Portal("R", Position(0, 5), Position(1, 0), false, true, true, 0));  // Onto a knight
+
+    const ChessPiece& rook = *board->getPieceAtPosition(Position(0, 0));
+    std::vector<Move> moves;
+    validator->getMoves(rook, moves);
+
+    auto find = [&](Position to) -> const Move* {
+        for (const Move& move : moves)
+            if (move.to == to)
+                return &move;
+        return nullptr;
+    };
+
+    TEST_ASSERT_NOT_NULL(find(Position(0, 2)));
+    TEST_ASSERT_TRUE(find(Position(0, 2))->landing == Position(0, 2));
+    TEST_ASSERT_NOT_NULL(find(Position(0, 3)));
+    TEST_ASSERT_TRUE(find(Position(0, 3))->landing == Position(5, 5));
+    TEST_ASSERT_NULL(find(Position(0, 4)));
+    TEST_ASSERT_NULL(find(Position(0, 5)));
+    TEST_ASSERT_NOT_NULL(find(Position(0, 6))); // Portals do not block the path
+
+    // Portal on cooldown
+    board->getPortalAtPosition(Position(0, 3))->ready_at = board->getPortalClock() + 2;
+    moves.clear();
+    validator->getMoves(rook, moves);
+    TEST_ASSERT_NULL(find(Position(0, 3)));
+}
+
+template <int N>
+static void assertEdgeDistances()
+{
+    BoardGeometry<N> geometry;
+    GenericGeometry generic(N);
+    for (int y = -1; y <= N; y++) {
+        for (int x = -1; x <= N; x++) {
+            Position position(x, y);
+            TEST_ASSERT_EQUAL(generic.contains(position), geometry.contains(position));
+            if (!generic.contains(position))
+                continue;
+
+            for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+                int steps = 0;
+                while (generic.contains(Position(x + DIRECTION_DX[direction] * (steps + 1),
+                                                 y + DIRECTION_DY[direction] * (steps + 1))))
+                    steps++;
+                TEST_ASSERT_EQUAL(steps, geometry.getEdgeDistance(position, direction));
+                TEST_ASSERT_EQUAL(steps, generic.getEdgeDistance(position, direction));
+            }
+        }
+    }
+}
+
+TEST(MoveValidator, Geometry)
+{
+    assertEdgeDistances<8>();
+    assertEdgeDistances<10>();
+    assertEdgeDistances<16>();
+
+    // The specialized & generic paths agree on every square
+    MoveValidator generic(*board, false);
+    TEST_ASSERT_TRUE(validator->isSpecialized());
+    TEST_ASSERT_FALSE(generic.isSpecialized());
+
+    board->addPortal(Portal("P", Position(3, 3), Position(6, 4), false, true, true, 0));
+    for (const ChessPiece& piece : board->getPieces()) {
+        for (int y = -1; y <= 8; y++)
+            for (int x = -1; x <= 8; x++)
+                TEST_ASSERT_EQUAL(generic.validateMove(piece, Position(x, y)),
+                                  validator->validateMove(piece, Position(x, y)));
+
+        std::vector<Move> moves, generic_moves;
+        validator->getMoves(piece, moves);
+        generic.getMoves(piece, generic_moves);
+        TEST_ASSERT_EQUAL(generic_moves.size(), moves.size());
+        for (std::size_t i = 0; i < moves.size(); i++)
+            TEST_ASSERT_TRUE(moves[i] == generic_moves[i] && moves[i].landing == generic_moves[i].landing);
+    }
+}
+
+/**
+ * @brief Square by square reference of the kernels, a distance of 0 slides
+ */
+static Bitboard256 referenceAttacks(const Bitboard256& origins, const Bitboard256& empty, int size,
+                                    int dx, int dy, int distance)
+{
+    Bitboard256 attacks = {};
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            if (!origins.test(Position(x, y)))
+                continue;
+            for (int step = 1; distance == 0 || step <= distance; step++) {
+                Position target(x + dx * step, y + dy * step);
+                if (target.x < 0 || target.y < 0 || target.x >= size || target.y >= size)
+                    break;
+                if (distance == 0 || step == distance)
+                    attacks.set(target);
+                if (!empty.test(target))
+                    break;
+            }
+        }
+    }
+    return attacks;
+}
+
+TEST(MoveValidator, AttackKernels)
+{
+    std::uint64_t seed = 42;
+    auto random = [&]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return seed ^ (seed >> 29);
+    };
+
+    std::vector<const AttackKernels*> kernels = AttackKernels::getSupported();
+    TEST_ASSERT_EQUAL_STRING("scalar", kernels.front()->name);
+    TEST_ASSERT_EQUAL_PTR(kernels.back(), &AttackKernels::get());
+
+    for (int size : { 8, 9, 13, 16 }) {
+        Bitboard256 mask = Bitboard256::getBoardMask(size);
+        for (int round = 0; round < 20; round++) {
+            Bitboard256 origins, empty;
+            for (int i = 0; i < 4; i++) {
+                origins.words[i] = random() & random() & mask.words[i];
+                empty.words[i] = random() | random();
+            }
+
+            for (int dy = -2; dy <= 2; dy++) {
+                for (int dx = -2; dx <= 2; dx++) {
+                    bool unit = std::abs(dx) <= 1 && std::abs(dy) <= 1 && (dx != 0 || dy != 0);
+                    bool leap = std::abs(dx) + std::abs(dy) == 3;
+                    if (!unit && !leap)
+                        continue;
+
+                    for (const AttackKernels* kernel : kernels) {
+                        if (unit) {
+                            TEST_ASSERT_TRUE(referenceAttacks(origins, empty, size, dx, dy, 0)
+                                             == kernel->slide(origins, empty, mask, dx, dy));
+                            for (int distance = 2; distance <= 3; distance++)
+                                TEST_ASSERT_TRUE(referenceAttacks(origins, empty, size, dx, dy, distance)
+                                                 == kernel->step(origins, empty, mask, dx, dy, distance));
+                        }
+                        TEST_ASSERT_TRUE(referenceAttacks(origins, empty, size, dx, dy, 1)
+                                         == kernel->step(origins, empty, mask, dx, dy, 1));
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(MoveValidator, TeamAttacks)
+{
+    for (const char* config : { "./data/chess_pieces.json", "./data/fantasy_chess.json" }) {
+        ConfigReader reader(config);
+        TEST_ASSERT_TRUE(reader.readConfig());
+
+        for (int size : { 8, 10, 16 }) {
+            GameSettings settings = reader.getGameSettings();
+            settings.board_size = size;
+            GameManager game(std::make_shared<const Ruleset>(settings, reader.getPieceConfigs(),
+                                                             reader.getPortalConfigs()));
+            InterpretedRules rules(*game.getBoard().getRuleset());
+
+            std::uint32_t seed = 3;
+            for (int ply = 0; ply < 40 && !game.isGameOver(); ply++) {
+                const ChessBoard& board = game.getBoard();
+                MoveValidator validator(board);
+                TEST_ASSERT_EQUAL(size >= MoveValidator::ATTACK_MAP_MIN_SIZE, validator.hasAttackMaps());
+
+                for (team_t team : { WHITE, BLACK }) {
+                    Bitboard256 attacks;
+                    TEST_ASSERT_TRUE(validator.getTeamAttacks(team, attacks));
+
+                    // What validateMove would allow if an opponent stood on the square
+                    Bitboard256 expected = {};
+                    for (const ChessPiece& piece : board.getPiecesOfTeam(team)) {
+                        for (int y = 0; y < size; y++) {
+                            for (int x = 0; x < size; x++) {
+                                int dx = x - piece.position.x;
+                                int dy = (y - piece.position.y) * (team == BLACK ? -1 : 1);
+                                MoveShape shape = rules.checkShape(piece.type_id, dx, dy, true, piece.used);
+                                if (shape == LEAP_SHAPE || (shape == PATH_SHAPE
+                                    && board.isPathClear(piece.position, Position(x, y))))
+                                    expected.set(Position(x, y));
+                            }
+                        }
+                    }
+                    TEST_ASSERT_TRUE(expected == attacks);
+                }
+
+                std::vector<Move> moves = game.getLegalMoves();
+                seed = seed * 1664525u + 1013904223u;
+                game.playTurn(moves[(seed >> 8) % moves.size()]);
+            }
+        }
+    }
+}
+
+TEST(MoveValidator, OverlappingPatterns)
+{
+    MovementRules warden_moves;
+    warden_moves.forward = -1;
+    warden_moves.first_move_forward = 2;
+    warden_moves.diagonal = -1;
+    warden_moves.diagonal_capture = 1;
+    MovementRules runner_moves;
+    runner_moves.forward = 1;
+    runner_moves.first_move_forward = -1;
+    std::vector<PieceConfig> piece_configs = {
+        { "warden", false, { Position(1, 1) }, { Position(1, 6) }, warden_moves, 1 },
+        { "runner", false, { Position(3, 1) }, { Position(3, 6) }, runner_moves, 1 },
+        { "king", true, { Position(5, 0) }, { Position(5, 7) }, MovementRules{ 1, 1, 1, 1 }, 1 },
+    };
+    auto ruleset = std::make_shared<const Ruleset>(GameSettings{ "overlaps", 8, -1 }, piece_configs,
+                                                   std::vector<PortalConfig>());
+
+    // Steps along a walk are dropped when compiled, first moves along a step stay
+    TEST_ASSERT_EQUAL(5, ruleset->getPieceType(0).patterns.size());
+    TEST_ASSERT_FALSE(ruleset->getPieceType(0).first_move_overlaps);
+    TEST_ASSERT_EQUAL(2, ruleset->getPieceType(1).patterns.size());
+    TEST_ASSERT_TRUE(ruleset->getPieceType(1).first_move_overlaps);
+
+    ChessBoard overlap_board(ruleset);
+    MoveValidator overlap_validator(overlap_board);
+    for (const ChessPiece& piece : overlap_board.getPieces()) {
+        std::vector<Move> moves;
+        overlap_validator.getMoves(piece, moves);
+        TEST_ASSERT_EQUAL(overlap_validator.getPossibleMoves(piece).size(), moves.size());
+    }
+}
+
+#ifdef CHESS_VARIANT
+TEST(MoveValidator, CompiledVariant)
+{
+    // Boards of the generated config take the compiled rules, else the suite
+    // only runs the interpreter once more
+    std::shared_ptr<const Ruleset> ruleset = Ruleset::load(VariantRules::CONFIG_PATH);
+    TEST_ASSERT_NOT_NULL(ruleset.get());
+    TEST_ASSERT_TRUE(VariantRules::matches(*ruleset));
+    TEST_ASSERT_EQUAL(ruleset->getPlacements().size(), VariantRules::PLACEMENTS.size());
+    TEST_ASSERT_EQUAL(ruleset->getPortals().size(), VariantRules::PORTALS.size());
+
+    ChessBoard variant_board(ruleset);
+    TEST_ASSERT_TRUE(MoveValidator(variant_board).isCompiled());
+    TEST_ASSERT_FALSE(MoveValidator(variant_board, false).isCompiled());
+}
+#endif
+
 TEST_GROUP_RUNNER(MoveValidator)
 {
     RUN_TEST_CASE(MoveValidator, PossibleMoves);
     RUN_TEST_CASE(MoveValidator, ValidateMove);
     RUN_TEST_CASE(MoveValidator, ValidatePortalUse);
+    RUN_TEST_CASE(MoveValidator, PortalMoves);
+    RUN_TEST_CASE(MoveValidator, Geometry);
+    RUN_TEST_CASE(MoveValidator, AttackKernels);
+    RUN_TEST_CASE(MoveValidator, TeamAttacks);
+    RUN_TEST_CASE(MoveValidator, OverlappingPatterns);
+#ifdef CHESS_VARIANT
+    RUN_TEST_CASE(MoveValidator, CompiledVariant);
+#endif
 }
\ No newline at end of file
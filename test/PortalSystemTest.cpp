@@ -1,4 +1,5 @@
 #include "ChessBoard.hpp"
+#include "GameManager.hpp"
 #include "PortalSystem.hpp"
 #include "unity.h"
 #include "unity_fixture.h"
@@ -35,19 +36,19 @@ TEST(PortalSystem, InitializePortals)
     TEST_ASSERT_NOT_NULL(portalX);
     TEST_ASSERT_EQUAL_STRING(portalX->id.c_str(), "X");
     TEST_ASSERT_EQUAL(portalX->cooldown, 5);
-    TEST_ASSERT_EQUAL(portalX->current_cooldown, 0);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalX), 0);
     
     Portal* portalY = board->getPortalAtPosition(Position(7, 3));
     TEST_ASSERT_NOT_NULL(portalY);
     TEST_ASSERT_EQUAL_STRING(portalY->id.c_str(), "Y");
     TEST_ASSERT_EQUAL(portalY->cooldown, 1);
-    TEST_ASSERT_EQUAL(portalY->current_cooldown, 0);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalY), 0);
     
     Portal* portalZ = board->getPortalAtPosition(Position(3, 3));
     TEST_ASSERT_NOT_NULL(portalZ);
     TEST_ASSERT_EQUAL_STRING(portalZ->id.c_str(), "Z");
     TEST_ASSERT_EQUAL(portalZ->cooldown, 3);
-    TEST_ASSERT_EQUAL(portalZ->current_cooldown, 0);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalZ), 0);
 }
 
 TEST(PortalSystem, StartCooldown)
@@ -55,17 +56,17 @@ TEST(PortalSystem, StartCooldown)
     Portal* portalX = board->getPortalAtPosition(Position(0, 5));
     TEST_ASSERT_NOT_NULL(portalX);
     portal_system->startCooldown(portalX->entry);
-    TEST_ASSERT_EQUAL(portalX->current_cooldown, portalX->cooldown);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalX), portalX->cooldown);
 
     Portal* portalY = board->getPortalAtPosition(Position(7, 3));
     TEST_ASSERT_NOT_NULL(portalY);
     portal_system->startCooldown(portalY->entry);
-    TEST_ASSERT_EQUAL(portalY->current_cooldown, portalY->cooldown);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalY), portalY->cooldown);
     
     Portal* portalZ = board->getPortalAtPosition(Position(3, 3));
     TEST_ASSERT_NOT_NULL(portalZ);
     portal_system->startCooldown(portalZ->entry);
-    TEST_ASSERT_EQUAL(portalZ->current_cooldown, portalZ->cooldown);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalZ), portalZ->cooldown);
 }
 
 TEST(PortalSystem, DecreaseCooldowns)
@@ -83,30 +84,46 @@ TEST(PortalSystem, DecreaseCooldowns)
     TEST_ASSERT_NOT_NULL(portalZ);
     portal_system->startCooldown(portalZ->entry);
 
-    portal_system->decreaseCooldowns();
-    TEST_ASSERT_EQUAL(portalX->current_cooldown, 4);
-    TEST_ASSERT_EQUAL(portalY->current_cooldown, 0);
-    TEST_ASSERT_EQUAL(portalZ->current_cooldown, 2);
-
-    portal_system->decreaseCooldowns();
-    TEST_ASSERT_EQUAL(portalX->current_cooldown, 3);
-    TEST_ASSERT_EQUAL(portalY->current_cooldown, 0);
-    TEST_ASSERT_EQUAL(portalZ->current_cooldown, 1);
-
-    portal_system->decreaseCooldowns();
-    TEST_ASSERT_EQUAL(portalX->current_cooldown, 2);
-    TEST_ASSERT_EQUAL(portalY->current_cooldown, 0);
-    TEST_ASSERT_EQUAL(portalZ->current_cooldown, 0);
-
-    portal_system->decreaseCooldowns();
-    TEST_ASSERT_EQUAL(portalX->current_cooldown, 1);
-    TEST_ASSERT_EQUAL(portalY->current_cooldown, 0);
-    TEST_ASSERT_EQUAL(portalZ->current_cooldown, 0);
-
-    portal_system->decreaseCooldowns();
-    TEST_ASSERT_EQUAL(portalX->current_cooldown, 0);
-    TEST_ASSERT_EQUAL(portalY->current_cooldown, 0);
-    TEST_ASSERT_EQUAL(portalZ->current_cooldown, 0);
+    portal_system->advanceClock();
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalX), 4);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalY), 0);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalZ), 2);
+
+    portal_system->advanceClock();
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalX), 3);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalY), 0);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalZ), 1);
+
+    portal_system->advanceClock();
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalX), 2);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalY), 0);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalZ), 0);
+
+    portal_system->advanceClock();
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalX), 1);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalY), 0);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalZ), 0);
+
+    portal_system->advanceClock();
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalX), 0);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalY), 0);
+    TEST_ASSERT_EQUAL(board->getPortalCooldown(*portalZ), 0);
+}
+
+TEST(PortalSystem, KingOnExit)
+{
+    // Portal Y leads from h4 to a4, where the black king stands
+    GameManager game(Ruleset::load("./data/fantasy_chess.json"));
+    TEST_ASSERT_TRUE(game.loadPosition("3b*4/8/1p*6/6p*1/k*2p*4/3P*2K*1/8/8 w 158 -"));
+
+    Move into_portal(Position(6, 2), Position(7, 3));
+    TEST_ASSERT_FALSE(game.isMoveLegal(into_portal));
+    for (const Move& move : game.getLegalMoves())
+        TEST_ASSERT_FALSE(move == into_portal);
+
+    TEST_ASSERT_FALSE(game.playTurn(into_portal));
+    TEST_ASSERT_EQUAL(GameManager::PORTAL_UNUSABLE, game.getTurnErrorCode());
+    TEST_ASSERT_NOT_NULL(game.getBoard().getKingOfTeam(BLACK));
 }
 
 TEST_GROUP_RUNNER(PortalSystem)
@@ -114,4 +131,5 @@ TEST_GROUP_RUNNER(PortalSystem)
     RUN_TEST_CASE(PortalSystem, InitializePortals);
     RUN_TEST_CASE(PortalSystem, StartCooldown);
     RUN_TEST_CASE(PortalSystem, DecreaseCooldowns);
+    RUN_TEST_CASE(PortalSystem, KingOnExit);
 }
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "RulesetCache.hpp"
+#include "unity.h"
+#include "unity_fixture.h"
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+static std::shared_ptr<const Ruleset> ruleset;
+static std::string cache_path;
+
+TEST_GROUP(Ruleset);
+
+TEST_SETUP(Ruleset)
+{
+    ConfigReader reader("./data/fantasy_chess.json");
+    if (!reader.readConfig()) {
+        TEST_FAIL_MESSAGE("Failed to read configuration file");
+    }
+
+    ruleset = std::make_shared<const Ruleset>(reader.getGameSettings(),
+                                              reader.getPieceConfigs(),
+                                              reader.getPortalConfigs());
+    cache_path = "/tmp/chess_test_" + std::to_string(getpid()) + ".rsc";
+}
+
+TEST_TEAR_DOWN(Ruleset)
+{
+    std::remove(cache_path.c_str());
+    ruleset = nullptr;
+}
+
+TEST(Ruleset, CacheRoundTrip)
+{
+    TEST_ASSERT_TRUE(RulesetCache::write(*ruleset, 42, cache_path));
+    std::shared_ptr<const Ruleset> cached = RulesetCache::read(cache_path, 42);
+    TEST_ASSERT_NOT_NULL(cached.get());
+
+    TEST_ASSERT_EQUAL_STRING(ruleset->getGameSettings().name.c_str(), cached->getGameSettings().name.c_str());
+    TEST_ASSERT_EQUAL(ruleset->getBoardSize(), cached->getBoardSize());
+    TEST_ASSERT_EQUAL(ruleset->getGameSettings().turn_limit, cached->getGameSettings().turn_limit);
+
+    TEST_ASSERT_EQUAL(ruleset->getPieceTypes().size(), cached->getPieceTypes().size());
+    for (std::size_t i = 0; i < ruleset->getPieceTypes().size(); i++) {
+        const PieceType& a = ruleset->getPieceTypes()[i];
+        const PieceType& b = cached->getPieceTypes()[i];
+        TEST_ASSERT_EQUAL_STRING(a.name.c_str(), b.name.c_str());
+        TEST_ASSERT_EQUAL(i, cached->findPieceType(a.name));
+        TEST_ASSERT_EQUAL(a.king_type, b.king_type);
+        TEST_ASSERT_EQUAL(a.forward_captures, b.forward_captures);
+        TEST_ASSERT_EQUAL(a.movement.diagonal, b.movement.diagonal);
+        TEST_ASSERT_EQUAL(a.patterns.size(), b.patterns.size());
+        TEST_ASSERT_EQUAL(a.first_move_overlaps, b.first_move_overlaps);
+        for (std::size_t p = 0; p < a.patterns.size(); p++) {
+            TEST_ASSERT_EQUAL(a.patterns[p].dx, b.patterns[p].dx);
+            TEST_ASSERT_EQUAL(a.patterns[p].dy, b.patterns[p].dy);
+            TEST_ASSERT_EQUAL(a.patterns[p].distance, b.patterns[p].distance);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(ruleset->getPlacements().size(), cached->getPlacements().size());
+    for (std::size_t i = 0; i < ruleset->getPlacements().size(); i++) {
+        TEST_ASSERT_EQUAL(ruleset->getPlacements()[i].type_id, cached->getPlacements()[i].type_id);
+        TEST_ASSERT_TRUE(ruleset->getPlacements()[i].position == cached->getPlacements()[i].position);
+    }
+
+    TEST_ASSERT_EQUAL(ruleset->getPortals().size(), cached->getPortals().size());
+    for (std::size_t i = 0; i < ruleset->getPortals().size(); i++) {
+        const Portal& a = ruleset->getPortals()[i];
+        const Portal& b = cached->getPortals()[i];
+        TEST_ASSERT_EQUAL_STRING(a.id.c_str(), b.id.c_str());
+        TEST_ASSERT_TRUE(a.entry == b.entry && a.exit == b.exit);
+        TEST_ASSERT_EQUAL(a.cooldown, b.cooldown);
+        TEST_ASSERT_EQUAL(a.white_allowed, b.white_allowed);
+    }
+}
+
+TEST(Ruleset, CacheRejectsInvalid)
+{
+    TEST_ASSERT_NULL(RulesetCache::read(cache_path, 42).get()); // Missing
+    TEST_ASSERT_TRUE(RulesetCache::write(*ruleset, 42, cache_path));
+    TEST_ASSERT_NULL(RulesetCache::read(cache_path, 43).get()); // Other source
+
+    // Flip a byte past the header
+    std::fstream file(cache_path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(120);
+    char byte = static_cast<char>(file.get());
+    file.seekp(120);
+    file.put(static_cast<char>(byte ^ 0x5a));
+    file.close();
+    TEST_ASSERT_NULL(RulesetCache::read(cache_path, 42).get());
+
+    // Truncated
+    std::ofstream(cache_path, std::ios::binary | std::ios::trunc) << "CHSSRSET";
+    TEST_ASSERT_NULL(RulesetCache::read(cache_path, 42).get());
+
+    // Intact, but placing a piece or a portal off the board
+    MovementRules king_moves{ 1, 1, 1, 1 };
+    for (Position off_board : { Position(8, 0), Position(0, -1) }) {
+        Ruleset pieces(GameSettings{ "off", 8, -1 },
+                       { PieceConfig{ "king", true, { off_board }, { Position(4, 7) }, king_moves, 1 } }, {});
+        TEST_ASSERT_TRUE(RulesetCache::write(pieces, 42, cache_path));
+        TEST_ASSERT_NULL(RulesetCache::read(cache_path, 42).get());
+
+        PortalConfig portal_config;
+        portal_config.id = "P";
+        portal_config.positions = PortalPositions{ Position(2, 2), off_board };
+        Ruleset portals(GameSettings{ "off", 8, -1 },
+                        { PieceConfig{ "king", true, { Position(4, 0) }, { Position(4, 7) }, king_moves, 1 } },
+                        { portal_config });
+        TEST_ASSERT_TRUE(RulesetCache::write(portals, 42, cache_path));
+        TEST_ASSERT_NULL(RulesetCache::read(cache_path, 42).get());
+    }
+}
+
+TEST(Ruleset, CacheConcurrentWrites)
+{
+    // Threads writing the same cache never rename a torn file into place
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; t++) {
+        writers.emplace_back([]() {
+            for (int i = 0; i < 50; i++)
+                RulesetCache::write(*ruleset, 42, cache_path);
+        });
+    }
+    for (int i = 0; i < 200; i++) {
+        std::shared_ptr<const Ruleset> cached = RulesetCache::read(cache_path, 42);
+        if (cached != nullptr)
+            TEST_ASSERT_EQUAL_UINT64(ruleset->getRulesHash(), cached->getRulesHash());
+    }
+    for (std::thread& writer : writers)
+        writer.join();
+
+    TEST_ASSERT_NOT_NULL(RulesetCache::read(cache_path, 42).get());
+}
+
+TEST_GROUP_RUNNER(Ruleset)
+{
+    RUN_TEST_CASE(Ruleset, CacheRoundTrip);
+    RUN_TEST_CASE(Ruleset, CacheRejectsInvalid);
+    RUN_TEST_CASE(Ruleset, CacheConcurrentWrites);
+}
@@ -0,0 +1,147 @@
+#include "ChessAPI.h"
+#include "ChessBoard.hpp"
+#include "TensorEncoder.hpp"
+#include "unity.h"
+#include "unity_fixture.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <unistd.h>
+
+static ChessBoard* board;
+static TensorEncoder* encoder;
+
+TEST_GROUP(TensorEncoder);
+
+TEST_SETUP(TensorEncoder)
+{
+    ConfigReader reader("./data/chess_pieces.json");
+    if (!reader.readConfig()) {
+        TEST_FAIL_MESSAGE("Failed to read configuration file");
+    }
+
+    auto settings = reader.getGameSettings();
+    board = new ChessBoard(settings, reader.getPieceConfigs());
+    encoder = new TensorEncoder(*board->getRuleset());
+}
+
+TEST_TEAR_DOWN(TensorEncoder)
+{
+    delete board;
+    delete encoder;
+}
+
+TEST(TensorEncoder, EncodeInitialPosition)
+{
+    TEST_ASSERT_EQUAL(encoder->getPlaneCount(), 12); // 6 types x 2 teams
+    TEST_ASSERT_EQUAL(encoder->getTensorSize(), 12 * 8 * 8);
+
+    std::vector<float> planes(encoder->getTensorSize(), 5.0f);
+    encoder->encode(*board, planes.data());
+
+    float total = 0;
+    for (float value : planes)
+        total += value;
+    TEST_ASSERT_EQUAL_FLOAT(32.0f, total);
+
+    // Pawns are the first type, white pawns fill the second rank
+    for (int x = 0; x < 8; x++) {
+        TEST_ASSERT_EQUAL_FLOAT(1.0f, planes[0 * 64 + 1 * 8 + x]);
+        TEST_ASSERT_EQUAL_FLOAT(1.0f, planes[1 * 64 + 6 * 8 + x]);
+    }
+
+    // White king on e1, last type
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, planes[10 * 64 + 0 * 8 + 4]);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, planes[11 * 64 + 7 * 8 + 4]);
+}
+
+TEST(TensorEncoder, EncodeTypesAgree)
+{
+    std::vector<float> fplanes(encoder->getTensorSize());
+    std::vector<uint8_t> uplanes(encoder->getTensorSize(), 7);
+
+    board->movePiece(*board->getPieceAtPosition(Position(4, 1)), Position(4, 3));
+    encoder->encode(*board, fplanes.data());
+    encoder->encode(*board, uplanes.data());
+
+    for (size_t i = 0; i < fplanes.size(); i++)
+        TEST_ASSERT_EQUAL(static_cast<uint8_t>(fplanes[i]), uplanes[i]);
+    TEST_ASSERT_EQUAL(1, uplanes[0 * 64 + 3 * 8 + 4]);
+    TEST_ASSERT_EQUAL(0, uplanes[0 * 64 + 1 * 8 + 4]);
+}
+
+TEST(TensorEncoder, EncodeBatch)
+{
+    ChessBoard other = *board;
+    other.removePiece(other.getPieceAtPosition(Position(3, 0)));
+
+    const ChessBoard* boards[] = { board, &other };
+    std::vector<float> batch(2 * encoder->getTensorSize());
+    std::vector<float> single(encoder->getTensorSize());
+    encoder->encodeBatch(boards, 2, batch.data());
+
+    for (size_t b = 0; b < 2; b++) {
+        encoder->encode(*boards[b], single.data());
+        TEST_ASSERT_EQUAL_FLOAT_ARRAY(single.data(), batch.data() + b * single.size(), single.size());
+    }
+}
+
+TEST(TensorEncoder, CInterface)
+{
+    chess_game* game = chess_game_create("./data/chess_pieces.json");
+    TEST_ASSERT_NOT_NULL(game);
+    TEST_ASSERT_NULL(chess_game_create("./data/missing.json"));
+
+    TEST_ASSERT_EQUAL(8, chess_game_board_size(game));
+    TEST_ASSERT_EQUAL(12, chess_game_plane_count(game));
+    TEST_ASSERT_EQUAL(WHITE, chess_game_current_player(game));
+
+    TEST_ASSERT_EQUAL(1, chess_game_play_turn(game, 4, 1, 4, 3));  // e2 e4
+    TEST_ASSERT_EQUAL(0, chess_game_play_turn(game, 4, 3, 4, 4));  // Wrong player
+    TEST_ASSERT_EQUAL(BLACK, chess_game_current_player(game));
+    TEST_ASSERT_EQUAL(0, chess_game_is_over(game));
+
+    std::vector<uint8_t> planes(chess_game_tensor_size(game));
+    TEST_ASSERT_EQUAL(-1, chess_encode_u8(game, planes.data(), planes.size() - 1));
+    TEST_ASSERT_EQUAL(0, chess_encode_u8(game, planes.data(), planes.size()));
+    TEST_ASSERT_EQUAL(1, planes[0 * 64 + 3 * 8 + 4]);
+
+    chess_game* games[] = { game, game };
+    std::vector<float> batch(2 * chess_game_tensor_size(game));
+    TEST_ASSERT_EQUAL(0, chess_encode_batch_f32(games, 2, batch.data(), batch.size()));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, batch[planes.size() + 0 * 64 + 3 * 8 + 4]);
+
+    // Other rules on the same planes batch together
+    chess_game* fantasy = chess_game_create("./data/fantasy_chess.json");
+    chess_game* mixed[] = { game, fantasy };
+    TEST_ASSERT_EQUAL(0, chess_encode_batch_f32(mixed, 2, batch.data(), batch.size()));
+
+    // Same tensor size, another piece behind a plane
+    std::string config_path = "/tmp/chess_test_" + std::to_string(getpid()) + ".json";
+    std::ifstream config("./data/chess_pieces.json");
+    std::string text((std::istreambuf_iterator<char>(config)), std::istreambuf_iterator<char>());
+    text.replace(text.find("\"queen\""), 7, "\"amazon\"");
+    std::ofstream(config_path) << text;
+    chess_game* amazon = chess_game_create(config_path.c_str());
+    std::remove(config_path.c_str());
+    std::remove((config_path + ".rsc").c_str());
+    TEST_ASSERT_NOT_NULL(amazon);
+    TEST_ASSERT_EQUAL(chess_game_tensor_size(game), chess_game_tensor_size(amazon));
+    mixed[1] = amazon;
+    TEST_ASSERT_EQUAL(-1, chess_encode_batch_f32(mixed, 2, batch.data(), batch.size()));
+
+    chess_game_destroy(amazon);
+    chess_game_destroy(fantasy);
+    chess_game_destroy(game);
+}
+
+TEST_GROUP_RUNNER(TensorEncoder)
+{
+    RUN_TEST_CASE(TensorEncoder, EncodeInitialPosition);
+    RUN_TEST_CASE(TensorEncoder, EncodeTypesAgree);
+    RUN_TEST_CASE(TensorEncoder, EncodeBatch);
+    RUN_TEST_CASE(TensorEncoder, CInterface);
+}
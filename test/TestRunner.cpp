@@ -2,10 +2,16 @@
 
 static void RunAllTests(void)
 {
+  RUN_TEST_GROUP(ConfigReader);
   RUN_TEST_GROUP(ChessBoard);
   RUN_TEST_GROUP(MoveValidator);
   RUN_TEST_GROUP(PortalSystem);
   RUN_TEST_GROUP(GameManager);
+  RUN_TEST_GROUP(TensorEncoder);
+  RUN_TEST_GROUP(Engine);
+  RUN_TEST_GROUP(GameServer);
+  RUN_TEST_GROUP(Ruleset);
+  RUN_TEST_GROUP(Allocation);
 }
 
 int main(int argc, const char * argv[])
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PositionIndex.hpp"
+
+// Builds the position index of logged games: every game of the config's
+// rules is played again on all cores, its turns are sorted by position into
+// an index file chess_query answers from.
+
+int main(int argc, char* argv[]) {
+  std::string config_path = "data/chess_pieces.json";
+  std::string index_path;
+  std::vector<std::string> log_paths;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  long run_turns = PositionIndexBuilder::RUN_TURNS;
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc) config_path = argv[++i];
+    else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) index_path = argv[++i];
+    else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+    else if (std::strcmp(argv[i], "--run-turns") == 0 && i + 1 < argc) run_turns = std::atol(argv[++i]);
+    else log_paths.push_back(argv[i]);
+  }
+
+  if (index_path.empty() || log_paths.empty()) {
+    std::cerr << "Usage: " << argv[0]
+              << " --output <index_file> [--config <config_file>] [--threads <n>]"
+                 " [--run-turns <n>] <game_log>...\n";
+    return 1;
+  }
+
+  std::shared_ptr<const Ruleset> ruleset = Ruleset::load(config_path);
+  if (ruleset == nullptr) {
+    std::cerr << "Error: Could not load " << config_path << "\n";
+    return 1;
+  }
+  GameManager start(ruleset);
+  PositionIndexBuilder builder(index_path, start, static_cast<std::size_t>(std::max(1L, run_turns)));
+
+  std::vector<std::unique_ptr<GameLogReader>> readers;
+  std::vector<GameRecord> games;
+  for (const std::string& log_path : log_paths) {
+    std::unique_ptr<GameLogReader> reader = GameLogReader::open(log_path);
+    if (reader == nullptr) {
+      std::cerr << "Error: " << log_path << " is not a game log\n";
+      return 1;
+    }
+
+    GameRecord record;
+    while (reader->next(record)) games.push_back(record);
+    if (!reader->isAtEnd())
+      std::cout << log_path << ": malformed record at byte " << reader->getOffset() << ", the rest is skipped\n";
+    readers.push_back(std::move(reader));
+  }
+
+  // Workers claim chunks of games, so that long & short games even out
+  constexpr std::size_t CHUNK = 64;
+  std::atomic<std::size_t> next_game(0);
+  std::atomic<long> indexed(0), other_rules(0), rejected(0);
+  auto start_time = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&]() {
+      std::size_t begin;
+      while ((begin = next_game.fetch_add(CHUNK)) < games.size()) {
+        for (std::size_t i = begin; i < std::min(begin + CHUNK, games.size()); i++) {
+          if (games[i].rules_hash != ruleset->getRulesHash()) other_rules++;
+          else if (builder.addGame(games[i])) indexed++;
+          else rejected++;
+        }
+      }
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+  double replay_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  if (!builder.finish()) {
+    std::cerr << "Error: Could not write " << index_path << "\n";
+    return 1;
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  std::unique_ptr<PositionIndex> index = PositionIndex::open(index_path);
+  std::cout << "Indexed " << indexed << " games on " << threads << " threads in " << seconds << " s ("
+            << indexed / replay_seconds << " games/s replayed, " << seconds - replay_seconds << " s merging)\n"
+            << "Entries: " << (index != nullptr ? index->getEntryCount() : 0)
+            << ", rejected games: " << rejected << ", other rules: " << other_rules << "\n";
+
+  return index != nullptr ? 0 : 1;
+}
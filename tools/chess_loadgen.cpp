@@ -0,0 +1,161 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Blocking line client of chess_server
+class Client {
+ public:
+  explicit Client(int fd) : fd_(fd) {}
+  ~Client() { if (fd_ >= 0) close(fd_); }
+
+  std::string request(const std::string& line) {
+    std::string message = line + "\n";
+    if (send(fd_, message.data(), message.size(), MSG_NOSIGNAL) < 0) return "";
+
+    std::size_t end;
+    while ((end = buffer_.find('\n')) == std::string::npos) {
+      char chunk[4096];
+      ssize_t length = read(fd_, chunk, sizeof(chunk));
+      if (length <= 0) return "";
+      buffer_.append(chunk, length);
+    }
+
+    std::string response = buffer_.substr(0, end);
+    buffer_.erase(0, end + 1);
+    return response;
+  }
+
+ private:
+  int fd_;
+  std::string buffer_;
+};
+
+static int connectTo(const std::string& unix_path, int port) {
+  if (!unix_path.empty()) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, unix_path.c_str(), sizeof(address.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int main(int argc, char* argv[]) {
+  std::string unix_path;
+  std::string config;
+  int port = -1;
+  int connections = 4;
+  int sessions = 64;
+  int max_turns = 40;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (std::strcmp(argv[i], "--unix") == 0) unix_path = argv[i + 1];
+    else if (std::strcmp(argv[i], "--port") == 0) port = std::atoi(argv[i + 1]);
+    else if (std::strcmp(argv[i], "--connections") == 0) connections = std::atoi(argv[i + 1]);
+    else if (std::strcmp(argv[i], "--sessions") == 0) sessions = std::atoi(argv[i + 1]);
+    else if (std::strcmp(argv[i], "--turns") == 0) max_turns = std::atoi(argv[i + 1]);
+    else if (std::strcmp(argv[i], "--config") == 0) config = argv[i + 1];
+  }
+
+  if (unix_path.empty() && port < 0) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--unix <path>] [--port <port>] [--connections <n>] [--sessions <n>]"
+                 " [--turns <n>] [--config <name>]\n";
+    return 1;
+  }
+
+  std::atomic<long> turns(0), errors(0);
+  auto start = std::chrono::steady_clock::now();
+
+  // Every connection hosts its share of the sessions and plays random legal moves
+  std::vector<std::thread> threads;
+  for (int c = 0; c < connections; c++) {
+    threads.emplace_back([&, c]() {
+      int fd = connectTo(unix_path, port);
+      if (fd < 0) { errors++; return; }
+      Client client(fd);
+      std::mt19937 random(c);
+
+      std::vector<std::string> ids;
+      for (int s = c; s < sessions; s += connections) {
+        std::string response = client.request("NEW " + config);
+        if (response.rfind("OK ", 0) != 0) { errors++; continue; }
+        ids.push_back(response.substr(3));
+      }
+
+      for (int turn = 0; turn < max_turns && !ids.empty(); turn++) {
+        for (std::size_t s = 0; s < ids.size();) {
+          std::istringstream moves(client.request("MOVES " + ids[s]));
+          std::vector<std::string> options;
+          std::string token;
+          moves >> token;
+          while (moves >> token) options.push_back(token);
+
+          if (options.empty()) {
+            client.request("CLOSE " + ids[s]);
+            ids.erase(ids.begin() + s);
+            continue;
+          }
+
+          std::string response = client.request("MOVE " + ids[s] + " " + options[random() % options.size()]);
+          if (response.rfind("OK", 0) != 0) errors++;
+          turns++;
+          s++;
+        }
+      }
+
+      for (const std::string& id : ids) client.request("CLOSE " + id);
+    });
+  }
+
+  // Sample the server while all sessions are still open
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  {
+    int fd = connectTo(unix_path, port);
+    if (fd >= 0) {
+      Client client(fd);
+      std::cout << "Server (under load): " << client.request("STATS") << "\n";
+    }
+  }
+
+  for (std::thread& thread : threads) thread.join();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "Turns played: " << turns << " in " << seconds << " s ("
+            << turns / seconds << " turns/s), errors: " << errors << "\n";
+
+  int fd = connectTo(unix_path, port);
+  if (fd >= 0) {
+    Client client(fd);
+    std::cout << "Server: " << client.request("STATS") << "\n";
+  }
+
+  return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "PositionIndex.hpp"
+
+// Answers which moves were played in a position out of an index built by
+// chess_index. A position is given in position notation, or as the moves
+// leading to it from the starting board: "moves e2e4 e7e5". Positions are
+// taken from the arguments, else one per line from stdin.
+
+static bool findPosition(const GameManager& start, const std::string& line, std::uint64_t& position) {
+  GameManager game(start);
+  if (line.rfind("moves", 0) != 0) {
+    if (!game.loadPosition(line)) return false;
+  } else {
+    std::istringstream moves(line.substr(5));
+    std::string token;
+    Move move;
+    while (moves >> token)
+      if (!parseMove(token, move) || !game.playTurn(move)) return false;
+  }
+
+  position = game.getStateHash();
+  return true;
+}
+
+static void query(const PositionIndex& index, const GameManager& start, const std::string& line) {
+  std::uint64_t position;
+  std::cout << line << "\n";
+  if (!findPosition(start, line, position)) {
+    std::cout << "  not a position of these rules\n";
+    return;
+  }
+
+  std::vector<MoveStats> stats;
+  auto begin = std::chrono::steady_clock::now();
+  std::uint64_t turns = index.find(position, stats);
+  double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+  std::sort(stats.begin(), stats.end(), [](const MoveStats& a, const MoveStats& b) {
+    return a.getGameCount() > b.getGameCount();
+  });
+
+  for (const MoveStats& move_stats : stats) {
+    std::ostringstream move;
+    move << move_stats.move;
+    double games = move_stats.getGameCount();
+    char row[160];
+    std::snprintf(row, sizeof(row), "  %-10s %8u games  white %5.1f%%  black %5.1f%%  drawn %5.1f%%  unfinished %5.1f%%",
+                  move.str().c_str(), move_stats.getGameCount(), 100 * move_stats.games[WHITE_WON] / games,
+                  100 * move_stats.games[BLACK_WON] / games, 100 * move_stats.games[DRAWN] / games,
+                  100 * move_stats.games[UNFINISHED] / games);
+    std::cout << row << "\n";
+  }
+  std::cout << "  " << turns << " turns from the position, found in " << micros << " us\n";
+}
+
+int main(int argc, char* argv[]) {
+  std::string config_path = "data/chess_pieces.json";
+  std::string index_path;
+  std::vector<std::string> positions;
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc) config_path = argv[++i];
+    else if (index_path.empty()) index_path = argv[i];
+    else positions.push_back(argv[i]);
+  }
+
+  if (index_path.empty()) {
+    std::cerr << "Usage: " << argv[0] << " [--config <config_file>] <index_file> [<position> | \"moves <e2e4> ...\"]...\n";
+    return 1;
+  }
+
+  std::shared_ptr<const Ruleset> ruleset = Ruleset::load(config_path);
+  if (ruleset == nullptr) {
+    std::cerr << "Error: Could not load " << config_path << "\n";
+    return 1;
+  }
+
+  std::unique_ptr<PositionIndex> index = PositionIndex::open(index_path);
+  if (index == nullptr) {
+    std::cerr << "Error: " << index_path << " is not a position index\n";
+    return 1;
+  }
+  if (index->getRulesHash() != ruleset->getRulesHash()) {
+    std::cerr << "Error: " << index_path << " indexes games of other rules than " << config_path << "\n";
+    return 1;
+  }
+
+  std::cout << index->getGameCount() << " games, " << index->getEntryCount() << " entries\n";
+  GameManager start(ruleset);
+  for (const std::string& position : positions) query(*index, start, position);
+
+  if (positions.empty()) {
+    std::string line;
+    while (std::getline(std::cin, line))
+      if (!line.empty()) query(*index, start, line);
+  }
+  return 0;
+}
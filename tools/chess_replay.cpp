@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GameLog.hpp"
+
+// Re-validates logged games: every game is played again through playTurn on
+// the ruleset it was logged with, all cores replaying at once. Games whose
+// moves are rejected or which end otherwise than logged are reported, as
+// are games of rules none of the configs has.
+
+static const char* resultName(GameResult result) {
+  switch (result) {
+    case WHITE_WON: return "white";
+    case BLACK_WON: return "black";
+    case DRAWN: return "tie";
+    default: return "unfinished";
+  }
+}
+
+struct LoggedGame {
+  std::size_t log;
+  std::size_t index;
+  GameRecord record;
+};
+
+int main(int argc, char* argv[]) {
+  std::vector<std::string> config_paths;
+  std::vector<std::string> log_paths;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  bool force = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc) config_paths.push_back(argv[++i]);
+    else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+    else if (std::strcmp(argv[i], "--force") == 0) force = true;
+    else log_paths.push_back(argv[i]);
+  }
+
+  if (log_paths.empty()) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--config <config_file>]... [--threads <n>] [--force] <game_log>...\n"
+                 "Games are matched to the config of their rules hash, --force replays\n"
+                 "all of them on the first config, e.g. after its rules were changed.\n";
+    return 1;
+  }
+  if (config_paths.empty()) config_paths.push_back("data/chess_pieces.json");
+
+  // One game per config at its starting board, replays play on copies
+  std::map<std::uint64_t, std::unique_ptr<GameManager>> starts;
+  std::unique_ptr<GameManager> forced;
+  for (const std::string& config_path : config_paths) {
+    std::shared_ptr<const Ruleset> ruleset = Ruleset::load(config_path);
+    if (ruleset == nullptr) {
+      std::cerr << "Error: Could not load " << config_path << "\n";
+      return 1;
+    }
+    if (force && forced == nullptr) forced = std::make_unique<GameManager>(ruleset);
+    starts[ruleset->getRulesHash()] = std::make_unique<GameManager>(ruleset);
+  }
+
+  std::vector<std::unique_ptr<GameLogReader>> readers;
+  std::vector<LoggedGame> games;
+  long torn = 0;
+  for (const std::string& log_path : log_paths) {
+    std::unique_ptr<GameLogReader> reader = GameLogReader::open(log_path);
+    if (reader == nullptr) {
+      std::cerr << "Error: " << log_path << " is not a game log\n";
+      return 1;
+    }
+
+    GameRecord record;
+    for (std::size_t index = 0; reader->next(record); index++)
+      games.push_back(LoggedGame{readers.size(), index, record});
+    if (!reader->isAtEnd()) {
+      std::cout << log_path << ": malformed record at byte " << reader->getOffset() << "\n";
+      torn++;
+    }
+    readers.push_back(std::move(reader));
+  }
+
+  // Workers claim chunks of games, so that long & short games even out
+  constexpr std::size_t CHUNK = 64;
+  std::atomic<std::size_t> next_game(0);
+  std::atomic<long> moves(0), mismatches(0), skipped(0);
+  std::mutex output_mutex;
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&]() {
+      long replayed_moves = 0;
+      std::size_t begin;
+      while ((begin = next_game.fetch_add(CHUNK)) < games.size()) {
+        for (std::size_t i = begin; i < std::min(begin + CHUNK, games.size()); i++) {
+          const LoggedGame& game = games[i];
+          const GameManager* start_game = forced.get();
+          if (start_game == nullptr) {
+            auto it = starts.find(game.record.rules_hash);
+            if (it == starts.end()) { skipped++; continue; }
+            start_game = it->second.get();
+          }
+
+          std::size_t rejected;
+          bool valid = replayGame(game.record, *start_game, rejected);
+          replayed_moves += rejected;
+          if (valid) continue;
+
+          mismatches++;
+          std::lock_guard<std::mutex> lock(output_mutex);
+          std::cout << log_paths[game.log] << ": game " << game.index << ": ";
+          if (rejected < game.record.move_count)
+            std::cout << "move " << rejected + 1 << " (" << game.record.getMove(rejected) << ") rejected\n";
+          else
+            std::cout << "logged " << resultName(game.record.result) << ", replay ends otherwise\n";
+        }
+      }
+      moves += replayed_moves;
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  long replayed = static_cast<long>(games.size()) - skipped;
+  std::cout << "Replayed " << replayed << " games, " << moves << " moves on " << threads
+            << " threads in " << seconds << " s (" << replayed / seconds << " games/s, "
+            << moves / seconds << " moves/s)\n"
+            << "Mismatches: " << mismatches << ", unknown rules: " << skipped
+            << ", malformed logs: " << torn << "\n";
+  if (skipped > 0)
+    std::cout << "Games of unknown rules were not checked, pass their config or --force\n";
+
+  return mismatches == 0 && torn == 0 && skipped == 0 ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "GameLog.hpp"
+#include "GameServer.hpp"
+
+static GameServer* server = nullptr;
+
+static void handleSignal(int) {
+  if (server != nullptr) server->stop();
+}
+
+int main(int argc, char* argv[]) {
+  std::string unix_path;
+  std::vector<std::string> config_paths;
+  std::string log_path;
+  int port = -1;
+  int workers = std::max(1u, std::thread::hardware_concurrency());
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (std::strcmp(argv[i], "--unix") == 0) unix_path = argv[i + 1];
+    else if (std::strcmp(argv[i], "--port") == 0) port = std::atoi(argv[i + 1]);
+    else if (std::strcmp(argv[i], "--workers") == 0) workers = std::atoi(argv[i + 1]);
+    else if (std::strcmp(argv[i], "--config") == 0) config_paths.push_back(argv[i + 1]);
+    else if (std::strcmp(argv[i], "--log") == 0) log_path = argv[i + 1];
+  }
+
+  if (unix_path.empty() && port < 0) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--unix <path>] [--port <port>] [--workers <n>] [--config <config_file>]..."
+                 " [--log <game_log>]\n";
+    return 1;
+  }
+
+  // Clients may only start games of these, the first is the default
+  if (config_paths.empty()) config_paths.push_back("data/chess_pieces.json");
+  GameServer game_server(workers);
+  for (const std::string& config_path : config_paths) {
+    if (!game_server.addConfig(config_path)) {
+      std::cerr << "Error: Could not load " << config_path << "\n";
+      return 1;
+    }
+  }
+  if (!log_path.empty()) {
+    std::shared_ptr<GameLog> game_log = GameLog::open(log_path);
+    if (game_log == nullptr) {
+      std::cerr << "Error: Could not open the game log " << log_path << "\n";
+      return 1;
+    }
+    game_server.setGameLog(game_log);
+  }
+  if (!unix_path.empty() && !game_server.listenUnix(unix_path)) {
+    std::cerr << "Error: Could not listen on " << unix_path << "\n";
+    return 1;
+  }
+  if (port >= 0 && !game_server.listenTcp(port)) {
+    std::cerr << "Error: Could not listen on port " << port << "\n";
+    return 1;
+  }
+
+  server = &game_server;
+  std::signal(SIGINT, handleSignal);
+  std::signal(SIGTERM, handleSignal);
+
+  std::cout << "Serving games with " << workers << " workers\n";
+  game_server.run();
+  std::cout << game_server.handleLine("STATS") << "\n";
+
+  return 0;
+}
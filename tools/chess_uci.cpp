@@ -0,0 +1,17 @@
+#include <iostream>
+
+#include "UciProtocol.hpp"
+
+int main(int argc, char* argv[]) {
+  if (argc > 2) {
+    std::cerr << "Usage: " << argv[0] << " [config_file]\n";
+    return 1;
+  }
+
+  std::string config_path = argc == 2 ? argv[1] : "data/chess_pieces.json";
+
+  UciProtocol protocol(std::cout, config_path);
+  protocol.run(std::cin);
+
+  return 0;
+}
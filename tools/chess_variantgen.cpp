@@ -0,0 +1,238 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Ruleset.hpp"
+
+// Emits VariantRules.hpp for a config: its piece types, movement rules, start
+// position & portals as constexpr data, along with straight-line move shape
+// checks. MoveValidator uses them when built with CHESS_VARIANT.
+
+static std::string quote(const std::string& text) {
+  std::string quoted = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\') quoted += '\\';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+static const char* boolean(bool value) {
+  return value ? "true" : "false";
+}
+
+/**
+ * @brief Condition for a movement rule matching a distance: -1 allows any
+ * distance, a positive rule exactly that one, anything else none
+ */
+static std::string ruleMatches(int rule, const std::string& distance) {
+  if (rule == -1) return "true";
+  if (rule <= 0) return "false";
+  return distance + " == " + std::to_string(rule);
+}
+
+/**
+ * @brief Join conditions with ||, folding constant ones
+ */
+static std::string anyOf(const std::vector<std::string>& conditions) {
+  std::string joined;
+  for (const std::string& condition : conditions) {
+    if (condition == "true") return "true";
+    if (condition == "false") continue;
+    bool compound = condition.find("&&") != std::string::npos;
+    joined += (joined.empty() ? "" : " || ") + (compound ? "(" + condition + ")" : condition);
+  }
+  return joined.empty() ? "false" : joined;
+}
+
+static std::string allOf(const std::string& first, const std::string& second) {
+  if (first == "false" || second == "false") return "false";
+  if (first == "true") return second;
+  if (second == "true") return first;
+  if (second.find("||") != std::string::npos) return first + " && (" + second + ")";
+  return first + " && " + second;
+}
+
+static void emitShape(std::ostream& out, const std::string& condition, const std::string& shape) {
+  if (condition == "false")
+    out << "                return ILLEGAL_SHAPE;\n";
+  else if (condition == "true")
+    out << "                return " << shape << ";\n";
+  else if (condition.find("||") != std::string::npos)
+    out << "                return (" << condition << ") ? " << shape << " : ILLEGAL_SHAPE;\n";
+  else
+    out << "                return " << condition << " ? " << shape << " : ILLEGAL_SHAPE;\n";
+}
+
+/**
+ * @brief Emit the checks of InterpretedRules::checkShape with the rules of a type folded in
+ */
+static void emitShapeCheck(std::ostream& out, const PieceType& type) {
+  const MovementRules& rule = type.movement;
+
+  out << "            if (adx == ady)\n";
+  emitShape(out, anyOf({ ruleMatches(rule.diagonal, "adx"),
+                         allOf("capture && dy > 0", ruleMatches(rule.diagonal_capture, "adx")) }),
+            "PATH_SHAPE");
+  out << "            if (dy == 0)\n";
+  emitShape(out, ruleMatches(rule.sideways, "adx"), "PATH_SHAPE");
+  out << "            if (dx == 0 && dy > 0)\n";
+  emitShape(out, allOf(type.forward_captures ? "true" : "!capture",
+                       anyOf({ ruleMatches(rule.forward, "dy"),
+                               allOf("!used", ruleMatches(rule.first_move_forward, "dy")) })),
+            "PATH_SHAPE");
+  out << "            if (dx == 0)\n";
+  emitShape(out, ruleMatches(rule.backward, "-dy"), "PATH_SHAPE");
+  if (rule.l_shape) {
+    out << "            if ((adx == 1 && ady == 2) || (adx == 2 && ady == 1))\n";
+    out << "                return LEAP_SHAPE;\n";
+  }
+  out << "            return ILLEGAL_SHAPE;\n";
+}
+
+static std::string generate(const Ruleset& ruleset, const std::string& config_path) {
+  const GameSettings& settings = ruleset.getGameSettings();
+  const std::vector<PieceType>& types = ruleset.getPieceTypes();
+  std::ostringstream out;
+
+  out << "// Generated by chess_variantgen from " << config_path << ", do not edit\n"
+      << "#pragma once\n\n"
+      << "#include \"MoveRules.hpp\"\n\n"
+      << "#include <array>\n\n"
+      << "/**\n * @brief Rules of the " << settings.name << " variant, compiled from " << config_path
+      << "\n */\n"
+      << "class VariantRules {\npublic:\n"
+      << "    static constexpr const char* NAME = " << quote(settings.name) << ";\n"
+      << "    static constexpr const char* CONFIG_PATH = " << quote(config_path) << ";\n"
+      << "    static constexpr int BOARD_SIZE = " << settings.board_size << ";\n"
+      << "    static constexpr int TURN_LIMIT = " << settings.turn_limit << ";\n\n";
+
+  out << "    struct TypeData {\n"
+      << "        const char* name;\n        bool king_type;\n        bool forward_captures;\n"
+      << "        MovementRules movement;\n    };\n\n"
+      << "    struct Placement {\n        int type_id;\n        team_t team;\n        short x;\n        short y;\n    };\n\n"
+      << "    struct PortalData {\n        const char* id;\n        short entry_x, entry_y, exit_x, exit_y;\n"
+      << "        bool both_ways, white_allowed, black_allowed;\n        int cooldown;\n    };\n\n";
+
+  out << "    static constexpr std::array<TypeData, " << types.size() << "> TYPES = {{\n";
+  for (const PieceType& type : types) {
+    const MovementRules& rule = type.movement;
+    out << "        { " << quote(type.name) << ", " << boolean(type.king_type) << ", "
+        << boolean(type.forward_captures) << ", { " << rule.forward << ", " << rule.backward << ", "
+        << rule.sideways << ", " << rule.diagonal << ", " << boolean(rule.l_shape) << ", "
+        << rule.first_move_forward << ", " << rule.diagonal_capture << " } },\n";
+  }
+  out << "    }};\n\n";
+
+  const std::vector<PiecePlacement>& placements = ruleset.getPlacements();
+  out << "    static constexpr std::array<Placement, " << placements.size() << "> PLACEMENTS = {{\n";
+  for (const PiecePlacement& placement : placements)
+    out << "        { " << placement.type_id << ", " << (placement.team == WHITE ? "WHITE" : "BLACK") << ", "
+        << placement.position.x << ", " << placement.position.y << " },\n";
+  out << "    }};\n\n";
+
+  const std::vector<Portal>& portals = ruleset.getPortals();
+  out << "    static constexpr std::array<PortalData, " << portals.size() << "> PORTALS = {{\n";
+  for (const Portal& portal : portals)
+    out << "        { " << quote(portal.id) << ", " << portal.entry.x << ", " << portal.entry.y << ", "
+        << portal.exit.x << ", " << portal.exit.y << ", " << boolean(portal.both_ways) << ", "
+        << boolean(portal.white_allowed) << ", " << boolean(portal.black_allowed) << ", "
+        << portal.cooldown << " },\n";
+  out << "    }};\n\n";
+
+  out << "    /**\n     * @brief Whether a ruleset has the board size & movement rules of this variant\n     */\n"
+      << "    static inline bool matches(const Ruleset& ruleset) {\n"
+      << "        if (ruleset.getBoardSize() != BOARD_SIZE || ruleset.getPieceTypes().size() != TYPES.size())\n"
+      << "            return false;\n\n"
+      << "        for (std::size_t i = 0; i < TYPES.size(); i++) {\n"
+      << "            const PieceType& type = ruleset.getPieceType(static_cast<int>(i));\n"
+      << "            const MovementRules& rule = type.movement;\n"
+      << "            const MovementRules& compiled = TYPES[i].movement;\n"
+      << "            if (type.name != TYPES[i].name || type.king_type != TYPES[i].king_type\n"
+      << "                || type.forward_captures != TYPES[i].forward_captures\n"
+      << "                || rule.forward != compiled.forward || rule.backward != compiled.backward\n"
+      << "                || rule.sideways != compiled.sideways || rule.diagonal != compiled.diagonal\n"
+      << "                || rule.l_shape != compiled.l_shape || rule.first_move_forward != compiled.first_move_forward\n"
+      << "                || rule.diagonal_capture != compiled.diagonal_capture)\n"
+      << "                return false;\n"
+      << "        }\n\n"
+      << "        return true;\n"
+      << "    }\n\n";
+
+  out << "    inline std::span<const MovePattern> getPatterns(int type_id) const {\n"
+      << "        switch (type_id) {\n";
+  for (std::size_t i = 0; i < types.size(); i++)
+    out << "        case " << i << ": return PATTERNS_" << i << ";\n";
+  out << "        }\n        return {};\n    }\n\n";
+
+  out << "    inline MoveShape checkShape(int type_id, int dx, int dy, [[maybe_unused]] bool capture,\n"
+      << "                                [[maybe_unused]] bool used) const {\n"
+      << "        if (dx == 0 && dy == 0)\n"
+      << "            return ILLEGAL_SHAPE;\n\n"
+      << "        int adx = dx < 0 ? -dx : dx;\n"
+      << "        int ady = dy < 0 ? -dy : dy;\n"
+      << "        switch (type_id) {\n";
+  for (std::size_t i = 0; i < types.size(); i++) {
+    out << "        case " << i << ": // " << types[i].name << "\n";
+    emitShapeCheck(out, types[i]);
+  }
+  out << "        }\n        return ILLEGAL_SHAPE;\n    }\n\n";
+
+  out << "private:\n";
+  for (std::size_t i = 0; i < types.size(); i++) {
+    out << "    static constexpr std::array<MovePattern, " << types[i].patterns.size() << "> PATTERNS_" << i
+        << " = {{\n";
+    for (const MovePattern& pattern : types[i].patterns)
+      out << "        { " << pattern.dx << ", " << pattern.dy << ", " << pattern.distance << ", "
+          << boolean(pattern.leap) << ", " << boolean(pattern.first_move) << " },\n";
+    out << "    }};\n";
+  }
+  out << "};\n";
+
+  return out.str();
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <config_file> <output_header>\n";
+    return 1;
+  }
+
+  ConfigReader reader(argv[1]);
+  if (!reader.readConfig()) {
+    std::cerr << "Error: " << argv[1] << ": " << reader.getError() << "\n";
+    return 1;
+  }
+
+  std::string header;
+  try {
+    Ruleset ruleset(reader.getGameSettings(), reader.getPieceConfigs(), reader.getPortalConfigs());
+    if (ruleset.getBoardSize() <= 0 || ruleset.getBoardSize() >= 256) {
+      std::cerr << "Error: Board sizes from 1 to 255 can be compiled\n";
+      return 1;
+    }
+    header = generate(ruleset, argv[1]);
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+
+  // Leave an unchanged header alone, so that nothing depending on it rebuilds
+  std::ifstream existing(argv[2]);
+  std::stringstream current;
+  current << existing.rdbuf();
+  if (existing.is_open() && current.str() == header)
+    return 0;
+
+  std::ofstream output(argv[2]);
+  output << header;
+  if (!output) {
+    std::cerr << "Error: Could not write " << argv[2] << "\n";
+    return 1;
+  }
+
+  std::cout << "Compiled " << reader.getGameSettings().name << " into " << argv[2] << "\n";
+  return 0;
+}